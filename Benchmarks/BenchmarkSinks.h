@@ -0,0 +1,71 @@
+/*
+==============================================================================
+	Module			BenchmarkSinks
+	Description		Loggers and sinks shared by the benchmarks
+==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <spdlog/logger.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include "Formatter.h"
+#include "PrintMacros.h"
+
+
+/*
+ *	@brief		Formats every message like a real sink would, then discards it.
+ *				Measures the logging pipeline without any I/O (spdlog's null_sink skips formatting).
+ */
+class DiscardingSink : public spdlog::sinks::base_sink<std::mutex>
+{
+protected:
+	void sink_it_(const spdlog::details::log_msg &msg) override
+	{
+		buffer.clear();
+		formatter_->format(msg, buffer);
+	}
+
+	void flush_() override {}
+
+private:
+	spdlog::memory_buf_t buffer;
+};
+
+
+// Builds a logger around the sink the same way LoggerImpl registers its sinks
+inline std::shared_ptr<spdlog::logger> makeBenchmarkLogger(spdlog::sink_ptr sink)
+{
+	sink->set_formatter(std::make_unique<Formatter>());
+	auto logger = std::make_shared<spdlog::logger>("benchmark", std::move(sink));
+	logger->set_level(spdlog::level::trace);
+	return logger;
+}
+
+
+// Mirrors LoggerImpl::log for LOG_INFO("Integer : {}!", 12344)
+inline void logInteger(spdlog::logger &logger)
+{
+	auto message = logging::formatMessage("Integer : {}!", 12344);
+	logger.log(spdlog::source_loc{__FILE__, __LINE__, __FUNCTION__}, spdlog::level::info, spdlog::string_view_t(message.data(), message.size()));
+}
+
+
+inline std::filesystem::path benchmarkLogFile()
+{
+	return std::filesystem::temp_directory_path() / "logger_benchmark.log";
+}
+
+
+// Upper end of the thread scaling runs
+inline int benchmarkMaxThreads()
+{
+	return static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+}
@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+
+#include <format>
+
+#include "Logger.h"
+#include "BenchmarkSinks.h"
+
+
+// Formatting stage alone: a fresh std::string per message, as the LOG macro used to do
+static void BM_StdFormat(benchmark::State &state)
+{
+	for (auto _ : state)
+	{
+		auto message = std::format("Integer : {}!", 12344);
+		benchmark::DoNotOptimize(message);
+	}
+}
+BENCHMARK(BM_StdFormat);
+
+
+// Formatting stage alone: the thread-local message buffer used by the LOG macro
+static void BM_FormatMessage(benchmark::State &state)
+{
+	for (auto _ : state)
+	{
+		auto message = logging::formatMessage("Integer : {}!", 12344);
+		benchmark::DoNotOptimize(message);
+	}
+}
+BENCHMARK(BM_FormatMessage);
+
+
+// Whole call without sinks attached, formatting through std::format
+static void BM_LogInfoStdFormat(benchmark::State &state)
+{
+	for (auto _ : state)
+	{
+		if (logging::isEnabled(LogLevel::Info))
+			logging::log(LogLevel::Info, __FILE__, __LINE__, __FUNCTION__, std::format("Integer : {}!", 12344));
+	}
+}
+BENCHMARK(BM_LogInfoStdFormat);
+
+
+// Whole call without sinks attached, through LOG_INFO
+static void BM_LogInfo(benchmark::State &state)
+{
+	for (auto _ : state)
+	{
+		LOG_INFO("Integer : {}!", 12344);
+	}
+}
+BENCHMARK(BM_LogInfo);
+
+
+// A call below the enabled level: only the level check runs
+static void BM_LogFilteredOut(benchmark::State &state)
+{
+	// The level is global: only the first thread sets and restores it, the others start and stop in step with it
+	LogLevel previous = LogLevel::Info;
+	if (state.thread_index() == 0)
+		previous = logging::minimumLevel.exchange(LogLevel::Warn);
+
+	for (auto _ : state)
+	{
+		LOG_INFO("Integer : {}!", 12344);
+	}
+
+	if (state.thread_index() == 0)
+		logging::minimumLevel.store(previous);
+}
+BENCHMARK(BM_LogFilteredOut)->ThreadRange(1, benchmarkMaxThreads());
+
+
+// A categorized call below its category's level: one guard check and one load of the category threshold
+static void BM_LogCategoryFilteredOut(benchmark::State &state)
+{
+	if (state.thread_index() == 0)
+		logging::setCategoryLevel("bench.filtered", LogLevel::Warn);
+
+	for (auto _ : state)
+	{
+		LOG_INFO_CAT("bench.filtered", "Integer : {}!", 12344);
+	}
+}
+BENCHMARK(BM_LogCategoryFilteredOut)->ThreadRange(1, benchmarkMaxThreads());
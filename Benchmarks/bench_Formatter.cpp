@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+
+#include "Formatter.h"
+#include "JsonFormatter.h"
+#include "KeyValue.h"
+
+
+// Formatter::format on its own, as run once per sink per message
+static void BM_FormatterFormat(benchmark::State &state)
+{
+	spdlog::source_loc		 loc("/project/src/network/ConnectionManager.cpp", 128, "handleIncomingConnection");
+	spdlog::details::log_msg msg(loc, "benchmark", spdlog::level::info, "Integer : 12344!");
+
+	Formatter				 formatter;
+	spdlog::memory_buf_t	 dest;
+
+	for (auto _ : state)
+	{
+		dest.clear();
+		formatter.format(msg, dest);
+		benchmark::DoNotOptimize(dest.data());
+	}
+}
+BENCHMARK(BM_FormatterFormat);
+
+
+// Same, with the timestamp moving to a new second on every message
+static void BM_FormatterFormatNewSecond(benchmark::State &state)
+{
+	spdlog::source_loc		 loc("/project/src/network/ConnectionManager.cpp", 128, "handleIncomingConnection");
+	spdlog::details::log_msg msg(loc, "benchmark", spdlog::level::info, "Integer : 12344!");
+
+	Formatter				 formatter;
+	spdlog::memory_buf_t	 dest;
+
+	for (auto _ : state)
+	{
+		msg.time += std::chrono::seconds(1);
+		dest.clear();
+		formatter.format(msg, dest);
+		benchmark::DoNotOptimize(dest.data());
+	}
+}
+BENCHMARK(BM_FormatterFormatNewSecond);
+
+
+// A compact user pattern run through the compiled program, compare with BM_FormatterFormat
+static void BM_FormatterFormatPattern(benchmark::State &state)
+{
+	spdlog::source_loc		 loc("/project/src/network/ConnectionManager.cpp", 128, "handleIncomingConnection");
+	spdlog::details::log_msg msg(loc, "benchmark", spdlog::level::info, "Integer : 12344!");
+
+	Formatter				 formatter("%H:%M:%S.%e %L %t %s:%# %v");
+	spdlog::memory_buf_t	 dest;
+
+	for (auto _ : state)
+	{
+		dest.clear();
+		formatter.format(msg, dest);
+		benchmark::DoNotOptimize(dest.data());
+	}
+}
+BENCHMARK(BM_FormatterFormatPattern);
+
+
+// JsonFormatter::format with three typed fields, compare with BM_FormatterFormat
+static void BM_JsonFormatterFormat(benchmark::State &state)
+{
+	std::string fields;
+	logging::kv::encodeField(fields, "user_id", 12344);
+	logging::kv::encodeField(fields, "peer", "10.0.0.1:443");
+	logging::kv::encodeField(fields, "latency_us", 17.25);
+	logging::kv::ScopedFields scope(fields);
+
+	spdlog::source_loc		  loc("/project/src/network/ConnectionManager.cpp", 128, "handleIncomingConnection");
+	spdlog::details::log_msg  msg(loc, "benchmark", spdlog::level::info, "Connection accepted");
+
+	JsonFormatter			  formatter;
+	spdlog::memory_buf_t	  dest;
+
+	for (auto _ : state)
+	{
+		dest.clear();
+		formatter.format(msg, dest);
+		benchmark::DoNotOptimize(dest.data());
+	}
+}
+BENCHMARK(BM_JsonFormatterFormat);
@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include "BenchmarkSinks.h"
+
+
+namespace
+{
+
+// Times every call individually and reports the distribution as counters (in nanoseconds)
+void measureLatency(benchmark::State &state, spdlog::logger &logger)
+{
+	using Clock = std::chrono::steady_clock;
+
+	std::vector<int64_t> samples;
+	samples.reserve(1 << 20);
+
+	for (auto _ : state)
+	{
+		auto start = Clock::now();
+		logInteger(logger);
+		auto end = Clock::now();
+
+		if (samples.size() < samples.capacity())
+			samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+	}
+
+	if (samples.empty())
+		return;
+
+	std::sort(samples.begin(), samples.end());
+	auto percentile			 = [&](double p) { return static_cast<double>(samples[static_cast<size_t>(p * (samples.size() - 1))]); };
+
+	state.counters["p50_ns"]	= percentile(0.50);
+	state.counters["p99_ns"]	= percentile(0.99);
+	state.counters["p99.9_ns"] = percentile(0.999);
+	state.counters["max_ns"]	= static_cast<double>(samples.back());
+}
+
+} // namespace
+
+
+static void BM_LatencyNullSink(benchmark::State &state)
+{
+	static auto logger = makeBenchmarkLogger(std::make_shared<DiscardingSink>());
+	measureLatency(state, *logger);
+}
+BENCHMARK(BM_LatencyNullSink);
+
+
+static void BM_LatencyRotatingFile(benchmark::State &state)
+{
+	static auto logger = makeBenchmarkLogger(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(benchmarkLogFile().string(), 10 * 1024 * 1024, 3, true));
+	measureLatency(state, *logger);
+}
+BENCHMARK(BM_LatencyRotatingFile);
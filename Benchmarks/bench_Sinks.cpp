@@ -0,0 +1,182 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include <spdlog/details/os.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include "AsyncWriter.h"
+#include "BatchedFileSink.h"
+#include "BinaryLog.h"
+#include "BinaryLogWriter.h"
+#include "MmapFileSink.h"
+#include "SinkList.h"
+#include "BenchmarkSinks.h"
+
+
+// Formats and discards: the pipeline cost without I/O
+static void BM_LogInfoNullSink(benchmark::State &state)
+{
+	static auto logger = makeBenchmarkLogger(std::make_shared<DiscardingSink>());
+
+	for (auto _ : state)
+	{
+		logInteger(*logger);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogInfoNullSink)->ThreadRange(1, benchmarkMaxThreads())->UseRealTime();
+
+
+// Same as above, routed through the sink list the library puts in front of every output
+static void BM_LogInfoSinkListNullSink(benchmark::State &state)
+{
+	static auto sinks = []
+	{
+		auto list = std::make_shared<SinkList>();
+		auto sink = std::make_shared<DiscardingSink>();
+		sink->set_formatter(std::make_unique<Formatter>());
+		list->add(sink);
+		return list;
+	}();
+	static auto logger = std::make_shared<spdlog::logger>("benchmark", sinks);
+
+	for (auto _ : state)
+	{
+		logInteger(*logger);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogInfoSinkListNullSink)->ThreadRange(1, benchmarkMaxThreads())->UseRealTime();
+
+
+// Four discarding sinks behind the sink list. Arg 1: one pattern, rendered once and shared. Arg 0: a distinct pattern per sink.
+static void BM_LogInfoSinkListFourSinks(benchmark::State &state)
+{
+	auto sinks = std::make_shared<SinkList>();
+	for (int i = 0; i < 4; ++i)
+	{
+		auto sink	 = std::make_shared<DiscardingSink>();
+		auto pattern = std::string("%Y-%m-%d %H:%M:%S.%e %8t %-8!l %-20!s %-45!! %v");
+		if (state.range(0) == 0)
+			pattern += std::string(static_cast<size_t>(i), ' ');
+		sink->set_formatter(std::make_unique<Formatter>(pattern));
+		sinks->add(sink);
+	}
+	spdlog::logger logger("benchmark", sinks);
+
+	for (auto _ : state)
+	{
+		logInteger(logger);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogInfoSinkListFourSinks)->Arg(0)->Arg(1);
+
+
+static void BM_LogInfoRotatingFile(benchmark::State &state)
+{
+	static auto logger = makeBenchmarkLogger(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(benchmarkLogFile().string(), 10 * 1024 * 1024, 3, true));
+
+	for (auto _ : state)
+	{
+		logInteger(*logger);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogInfoRotatingFile)->ThreadRange(1, benchmarkMaxThreads())->UseRealTime();
+
+
+// The sink behind addFileOutput: same rotation as above, one write per batch of lines
+static void BM_LogInfoBatchedFile(benchmark::State &state)
+{
+	// Single-threaded, so each batch size gets its own sink
+	auto logger = makeBenchmarkLogger(std::make_shared<BatchedFileSink>(benchmarkLogFile().string() + ".batched", 10 * 1024 * 1024, 3, true, spdlog::level::err,
+																		std::chrono::milliseconds(0), static_cast<size_t>(state.range(0))));
+
+	for (auto _ : state)
+	{
+		logInteger(*logger);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogInfoBatchedFile)->Arg(0)->Arg(4096)->Arg(65536)->UseRealTime();
+
+
+#ifndef _WIN32
+// Same file size as BM_LogInfoRotatingFile, written through a shared mapping instead of fwrite
+static void BM_LogInfoMmapFile(benchmark::State &state)
+{
+	static auto logger = makeBenchmarkLogger(std::make_shared<MmapFileSink>(benchmarkLogFile().string() + ".mmap", 10 * 1024 * 1024, 3));
+
+	for (auto _ : state)
+	{
+		logInteger(*logger);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogInfoMmapFile)->ThreadRange(1, benchmarkMaxThreads())->UseRealTime();
+#endif
+
+
+// Console sink on stderr, so the benchmark report on stdout stays readable
+static void BM_LogInfoConsole(benchmark::State &state)
+{
+	static auto logger = makeBenchmarkLogger(std::make_shared<spdlog::sinks::stderr_color_sink_mt>());
+
+	for (auto _ : state)
+	{
+		logInteger(*logger);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogInfoConsole)->ThreadRange(1, benchmarkMaxThreads())->UseRealTime();
+
+
+// Caller-side cost in asynchronous mode: capture and enqueue, sink work happens on the writer thread
+static void BM_LogInfoAsyncNullSink(benchmark::State &state)
+{
+	static auto		   logger = makeBenchmarkLogger(std::make_shared<DiscardingSink>());
+	static AsyncWriter writer(logger, 8192, OverflowPolicy::Block);
+
+	for (auto _ : state)
+	{
+		auto message = logging::formatMessage("Integer : {}!", 12344);
+		writer.enqueue({spdlog::log_clock::now(), 0, spdlog::level::info, __LINE__, __FILE__, __FUNCTION__, std::string(message), {}, nullptr, {}});
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogInfoAsyncNullSink)->ThreadRange(1, benchmarkMaxThreads())->UseRealTime();
+
+
+// Same with deferred formatting: the caller only copies the arguments, std::format runs on the writer thread
+static void BM_LogInfoAsyncDeferredNullSink(benchmark::State &state)
+{
+	static auto		   logger = makeBenchmarkLogger(std::make_shared<DiscardingSink>());
+	static AsyncWriter writer(logger, 8192, OverflowPolicy::Block);
+
+	for (auto _ : state)
+	{
+		writer.enqueue({spdlog::log_clock::now(), 0, spdlog::level::info, __LINE__, __FILE__, __FUNCTION__, std::string(logging::deferred::captureArgs(12344)), {},
+						logging::deferred::formatCaptured<int>, "Integer : {}!"});
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogInfoAsyncDeferredNullSink)->ThreadRange(1, benchmarkMaxThreads())->UseRealTime();
+
+
+// Binary output: call site id and raw argument bytes instead of a formatted line, compare with BM_LogInfoRotatingFile
+static void BM_LogInfoBinaryFile(benchmark::State &state)
+{
+	static const logging::CallSite site{LogLevel::Info, __FILE__, __LINE__, __FUNCTION__, "Integer : {}!"};
+	static BinaryLogWriter		   writer((benchmarkLogFile().string() + ".bin"));
+
+	for (auto _ : state)
+	{
+		auto timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(spdlog::log_clock::now().time_since_epoch()).count();
+		writer.write(site, logging::binary::Signature<int>::value, logging::binary::encodeArgs(12344), timeNs, spdlog::details::os::thread_id());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogInfoBinaryFile)->ThreadRange(1, benchmarkMaxThreads())->UseRealTime();
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <spdlog/details/os.h>
+
+#include "AsyncWriter.h"
+#include "BenchmarkSinks.h"
+#include "StagingWriter.h"
+
+
+// Contention between logging threads, 1 to 32 threads on one logger with a discarding sink.
+// Sync is the default path through the logger and the sink mutex. The async variants block on a full queue, so
+// their rate is bounded by the writer thread once producers outrun it.
+
+static void BM_ScalingSync(benchmark::State &state)
+{
+	static auto logger = makeBenchmarkLogger(std::make_shared<DiscardingSink>());
+
+	for (auto _ : state)
+	{
+		logInteger(*logger);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScalingSync)->ThreadRange(1, 32)->UseRealTime();
+
+
+static void BM_ScalingSharedQueue(benchmark::State &state)
+{
+	static auto		   logger = makeBenchmarkLogger(std::make_shared<DiscardingSink>());
+	static AsyncWriter writer(logger, 8192, OverflowPolicy::Block);
+
+	for (auto _ : state)
+	{
+		auto message = logging::formatMessage("Integer : {}!", 12344);
+		writer.enqueue({spdlog::log_clock::now(), spdlog::details::os::thread_id(), spdlog::level::info, __LINE__, __FILE__, __FUNCTION__, std::string(message), {}, nullptr, {}});
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScalingSharedQueue)->ThreadRange(1, 32)->UseRealTime();
+
+
+static void BM_ScalingPerThreadRings(benchmark::State &state)
+{
+	static auto			 logger = makeBenchmarkLogger(std::make_shared<DiscardingSink>());
+	static StagingWriter writer(logger, 8192, OverflowPolicy::Block);
+
+	for (auto _ : state)
+	{
+		auto message = logging::formatMessage("Integer : {}!", 12344);
+		writer.enqueue(spdlog::log_clock::now(), spdlog::details::os::thread_id(), spdlog::level::info, __LINE__, __FILE__, __FUNCTION__, message);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScalingPerThreadRings)->ThreadRange(1, 32)->UseRealTime();
@@ -0,0 +1,58 @@
+/*
+==============================================================================
+	Module			RecordingSink
+	Description		Sink shared by the tests of the background writers
+==============================================================================
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <spdlog/details/log_msg.h>
+#include <spdlog/sinks/base_sink.h>
+
+
+/*
+ *	@brief		Records every message and can hold the writer thread inside log() until released
+ */
+class RecordingSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+	std::vector<std::string>				   payloads;
+	std::vector<size_t>						   threadIds;
+	std::vector<spdlog::log_clock::time_point> times;
+
+	void									   hold() { held = true; }
+
+	void									   release()
+	{
+		{
+			std::lock_guard<std::mutex> lock(gateMutex);
+			held = false;
+		}
+		gate.notify_all();
+	}
+
+protected:
+	void sink_it_(const spdlog::details::log_msg &msg) override
+	{
+		{
+			std::unique_lock<std::mutex> lock(gateMutex);
+			gate.wait(lock, [this] { return !held; });
+		}
+		payloads.emplace_back(msg.payload.data(), msg.payload.size());
+		threadIds.push_back(msg.thread_id);
+		times.push_back(msg.time);
+	}
+
+	void flush_() override {}
+
+private:
+	std::mutex				gateMutex;
+	std::condition_variable gate;
+	bool					held = false;
+};
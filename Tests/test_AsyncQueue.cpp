@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "AsyncQueue.h"
+
+
+TEST(AsyncQueue, RoundsCapacityUpToPowerOfTwo)
+{
+	AsyncQueue<int> queue(100);
+	EXPECT_EQ(queue.capacity(), 128u);
+}
+
+TEST(AsyncQueue, PopsInFifoOrder)
+{
+	AsyncQueue<int> queue(4);
+	EXPECT_TRUE(queue.tryPush(1));
+	EXPECT_TRUE(queue.tryPush(2));
+	EXPECT_TRUE(queue.tryPush(3));
+
+	int value = 0;
+	ASSERT_TRUE(queue.tryPop(value));
+	EXPECT_EQ(value, 1);
+	ASSERT_TRUE(queue.tryPop(value));
+	EXPECT_EQ(value, 2);
+	ASSERT_TRUE(queue.tryPop(value));
+	EXPECT_EQ(value, 3);
+	EXPECT_FALSE(queue.tryPop(value));
+}
+
+TEST(AsyncQueue, RejectsPushWhenFull)
+{
+	AsyncQueue<std::string> queue(2);
+	EXPECT_TRUE(queue.tryPush("a"));
+	EXPECT_TRUE(queue.tryPush("b"));
+
+	std::string rejected = "c";
+	EXPECT_FALSE(queue.tryPush(std::move(rejected)));
+	EXPECT_EQ(rejected, "c"); // Left untouched on failure
+	EXPECT_EQ(queue.size(), 2u);
+}
+
+TEST(AsyncQueue, ReusesSlotsAfterWrapAround)
+{
+	AsyncQueue<int> queue(2);
+	int				value = 0;
+
+	for (int i = 0; i < 10; ++i)
+	{
+		ASSERT_TRUE(queue.tryPush(int(i)));
+		ASSERT_TRUE(queue.tryPop(value));
+		EXPECT_EQ(value, i);
+	}
+}
+
+TEST(AsyncQueue, DeliversEveryItemFromConcurrentProducers)
+{
+	constexpr int	 producers		  = 4;
+	constexpr int	 itemsPerProducer = 10000;
+
+	AsyncQueue<int>	 queue(256);
+	std::vector<int> received;
+	received.reserve(producers * itemsPerProducer);
+
+	std::thread consumer(
+		[&]
+		{
+			int value = 0;
+			while (received.size() < producers * itemsPerProducer)
+			{
+				if (queue.tryPop(value))
+					received.push_back(value);
+				else
+					std::this_thread::yield();
+			}
+		});
+
+	std::vector<std::thread> threads;
+	for (int p = 0; p < producers; ++p)
+	{
+		threads.emplace_back(
+			[&queue, p]
+			{
+				for (int i = 0; i < itemsPerProducer; ++i)
+				{
+					int value = p * itemsPerProducer + i;
+					while (!queue.tryPush(std::move(value)))
+						std::this_thread::yield();
+				}
+			});
+	}
+
+	for (auto &t : threads)
+		t.join();
+	consumer.join();
+
+	std::set<int> unique(received.begin(), received.end());
+	EXPECT_EQ(unique.size(), static_cast<size_t>(producers * itemsPerProducer));
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <spdlog/details/os.h>
+
+#include "AsyncWriter.h"
+#include "RecordingSink.h"
+
+
+namespace
+{
+
+AsyncRecord makeRecord(const std::string &payload, size_t threadId = 1)
+{
+	return {spdlog::log_clock::now(), threadId, spdlog::level::info, 10, "/src/Foo.cpp", "doWork", payload, {}, nullptr, {}};
+}
+
+} // namespace
+
+
+TEST(AsyncWriter, WritesAllQueuedMessagesBeforeDestruction)
+{
+	auto sink	= std::make_shared<RecordingSink>();
+	auto logger = std::make_shared<spdlog::logger>("async_test", sink);
+
+	{
+		AsyncWriter writer(logger, 16, OverflowPolicy::Block);
+		for (int i = 0; i < 100; ++i)
+			writer.enqueue(makeRecord("message " + std::to_string(i)));
+	}
+
+	ASSERT_EQ(sink->payloads.size(), 100u);
+	EXPECT_EQ(sink->payloads.front(), "message 0");
+	EXPECT_EQ(sink->payloads.back(), "message 99");
+}
+
+TEST(AsyncWriter, KeepsThreadIdOfLoggingThread)
+{
+	auto sink	= std::make_shared<RecordingSink>();
+	auto logger = std::make_shared<spdlog::logger>("async_test", sink);
+
+	{
+		AsyncWriter writer(logger, 16, OverflowPolicy::Block);
+		writer.enqueue(makeRecord("hello", 4242));
+	}
+
+	ASSERT_EQ(sink->threadIds.size(), 1u);
+	EXPECT_EQ(sink->threadIds.front(), 4242u);
+}
+
+TEST(AsyncWriter, DropNewestCountsDiscardedMessages)
+{
+	auto sink	= std::make_shared<RecordingSink>();
+	auto logger = std::make_shared<spdlog::logger>("async_test", sink);
+	sink->hold();
+
+	uint64_t dropped = 0;
+	{
+		AsyncWriter writer(logger, 2, OverflowPolicy::DropNewest);
+		for (int i = 0; i < 10; ++i)
+			writer.enqueue(makeRecord("message " + std::to_string(i)));
+
+		dropped = writer.droppedMessages();
+		sink->release();
+	}
+
+	// At most one message sits in the blocked sink and two in the queue
+	EXPECT_GE(dropped, 7u);
+	EXPECT_EQ(sink->payloads.size() + dropped, 10u);
+	EXPECT_EQ(sink->payloads.front(), "message 0");
+}
+
+TEST(AsyncWriter, DropOldestKeepsMostRecentMessages)
+{
+	auto sink	= std::make_shared<RecordingSink>();
+	auto logger = std::make_shared<spdlog::logger>("async_test", sink);
+	sink->hold();
+
+	uint64_t dropped = 0;
+	{
+		AsyncWriter writer(logger, 2, OverflowPolicy::DropOldest);
+		for (int i = 0; i < 10; ++i)
+			writer.enqueue(makeRecord("message " + std::to_string(i)));
+
+		dropped = writer.droppedMessages();
+		sink->release();
+	}
+
+	EXPECT_GE(dropped, 7u);
+	EXPECT_EQ(sink->payloads.size() + dropped, 10u);
+	EXPECT_EQ(sink->payloads.back(), "message 9");
+}
@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include "BatchedFileSink.h"
+#include "Lz4Codec.h"
+
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+
+class BatchedFileSinkTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		directory = std::filesystem::temp_directory_path() / (std::string("logger_batched_") + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory);
+		fileName = (directory / "app.log").string();
+	}
+
+	void		TearDown() override { std::filesystem::remove_all(directory); }
+
+	std::string rotatedName(size_t index) const { return spdlog::sinks::rotating_file_sink_mt::calc_filename(fileName, index); }
+
+	std::string archiveName(size_t index) const { return RotationArchiver::archiveName(fileName, index); }
+
+	static void log(BatchedFileSink &sink, const std::string &payload, spdlog::level::level_enum level = spdlog::level::info)
+	{
+		spdlog::details::log_msg msg(spdlog::source_loc{}, "test_logger", level, payload);
+		sink.log(msg);
+	}
+
+	static void logAt(BatchedFileSink &sink, spdlog::log_clock::time_point time, const std::string &payload)
+	{
+		spdlog::details::log_msg msg(time, spdlog::source_loc{}, "test_logger", spdlog::level::info, payload);
+		sink.log(msg);
+	}
+
+	static std::string read(const std::string &path)
+	{
+		std::ifstream	  file(path, std::ios::binary);
+		std::stringstream content;
+		content << file.rdbuf();
+		return content.str();
+	}
+
+	std::filesystem::path directory;
+	std::string			  fileName;
+};
+
+} // namespace
+
+
+TEST_F(BatchedFileSinkTest, GathersLinesIntoOneWrite)
+{
+	BatchedFileSink sink(fileName, 1024 * 1024, 3, false, spdlog::level::err, 0ms, 4096);
+	sink.set_pattern("%v");
+
+	for (int i = 0; i < 100; ++i)
+		log(sink, "line " + std::to_string(i));
+
+	EXPECT_EQ(sink.writeCount(), 0u);
+	EXPECT_EQ(read(fileName), "");
+
+	sink.flush();
+
+	EXPECT_EQ(sink.writeCount(), 1u);
+	EXPECT_EQ(read(fileName).substr(0, 14), "line 0\nline 1\n");
+}
+
+TEST_F(BatchedFileSinkTest, WritesWhenBatchIsFull)
+{
+	BatchedFileSink sink(fileName, 1024 * 1024, 3, false, spdlog::level::err, 0ms, 64);
+	sink.set_pattern("%v");
+
+	// 10 bytes per line: the 7th line no longer fits the batch and is written together with it
+	for (int i = 0; i < 7; ++i)
+		log(sink, "123456789");
+
+	EXPECT_EQ(sink.writeCount(), 1u);
+	EXPECT_EQ(read(fileName).size(), 70u);
+}
+
+TEST_F(BatchedFileSinkTest, ZeroBatchSizeWritesEveryLine)
+{
+	BatchedFileSink sink(fileName, 1024 * 1024, 3, false, spdlog::level::err, 0ms, 0);
+	sink.set_pattern("%v");
+
+	log(sink, "first");
+	log(sink, "second");
+
+	EXPECT_EQ(sink.writeCount(), 2u);
+	EXPECT_EQ(read(fileName), "first\nsecond\n");
+}
+
+TEST_F(BatchedFileSinkTest, ErrorWritesPendingLinesImmediately)
+{
+	// Even with a more relaxed flush level, errors are never held back
+	BatchedFileSink sink(fileName, 1024 * 1024, 3, false, spdlog::level::off, 0ms, 4096);
+	sink.set_pattern("%v");
+
+	log(sink, "info");
+	log(sink, "warning", spdlog::level::warn);
+	EXPECT_EQ(read(fileName), "");
+
+	log(sink, "error", spdlog::level::err);
+
+	EXPECT_EQ(sink.writeCount(), 1u);
+	EXPECT_EQ(read(fileName), "info\nwarning\nerror\n");
+}
+
+TEST_F(BatchedFileSinkTest, FlushLevelWritesPendingLines)
+{
+	BatchedFileSink sink(fileName, 1024 * 1024, 3, false, spdlog::level::warn, 0ms, 4096);
+	sink.set_pattern("%v");
+
+	log(sink, "info");
+	log(sink, "warning", spdlog::level::warn);
+
+	EXPECT_EQ(read(fileName), "info\nwarning\n");
+}
+
+TEST_F(BatchedFileSinkTest, IntervalWritesPendingLines)
+{
+	BatchedFileSink sink(fileName, 1024 * 1024, 3, false, spdlog::level::err, 20ms, 4096);
+	sink.set_pattern("%v");
+
+	log(sink, "pending");
+
+	auto deadline = std::chrono::steady_clock::now() + 5s;
+	while (read(fileName).empty() && std::chrono::steady_clock::now() < deadline)
+		std::this_thread::sleep_for(5ms);
+
+	EXPECT_EQ(read(fileName), "pending\n");
+}
+
+TEST_F(BatchedFileSinkTest, DestructorWritesPendingLines)
+{
+	{
+		BatchedFileSink sink(fileName, 1024 * 1024, 3, false, spdlog::level::err, 0ms, 4096);
+		sink.set_pattern("%v");
+		log(sink, "first");
+		log(sink, "second");
+	}
+
+	EXPECT_EQ(read(fileName), "first\nsecond\n");
+}
+
+TEST_F(BatchedFileSinkTest, RotatesLikeRotatingFileSink)
+{
+	{
+		BatchedFileSink sink(fileName, 20, 2, false, spdlog::level::err, 0ms, 4096);
+		sink.set_pattern("%v");
+
+		// 10 bytes per line, two lines per file
+		for (int i = 0; i < 5; ++i)
+			log(sink, "line " + std::to_string(i) + "___");
+	}
+
+	EXPECT_EQ(read(rotatedName(2)), "line 0___\nline 1___\n");
+	EXPECT_EQ(read(rotatedName(1)), "line 2___\nline 3___\n");
+	EXPECT_EQ(read(fileName), "line 4___\n");
+}
+
+TEST_F(BatchedFileSinkTest, RotateOnOpenMovesExistingFile)
+{
+	{
+		std::ofstream existing(fileName);
+		existing << "previous session\n";
+	}
+
+	{
+		BatchedFileSink sink(fileName, 1024 * 1024, 3, true, spdlog::level::err, 0ms, 4096);
+		sink.set_pattern("%v");
+		log(sink, "new session");
+	}
+
+	EXPECT_EQ(read(rotatedName(1)), "previous session\n");
+	EXPECT_EQ(read(fileName), "new session\n");
+}
+
+
+TEST_F(BatchedFileSinkTest, CompressesRotatedFiles)
+{
+	{
+		BatchedFileSink sink(fileName, 20, 2, false, spdlog::level::err, 0ms, 4096, Codec::LZ4);
+		sink.set_pattern("%v");
+
+		for (int i = 0; i < 5; ++i)
+			log(sink, "line " + std::to_string(i) + "___");
+	}
+
+	EXPECT_EQ(lz4::decompress(read(archiveName(2))), "line 0___\nline 1___\n");
+	EXPECT_EQ(lz4::decompress(read(archiveName(1))), "line 2___\nline 3___\n");
+	EXPECT_EQ(read(fileName), "line 4___\n");
+	EXPECT_FALSE(std::filesystem::exists(rotatedName(1)));
+}
+
+TEST_F(BatchedFileSinkTest, KeepsMaxFilesArchives)
+{
+	BatchedFileSink sink(fileName, 20, 2, false, spdlog::level::err, 0ms, 4096, Codec::LZ4);
+	sink.set_pattern("%v");
+
+	for (int i = 0; i < 10; ++i)
+		log(sink, "line " + std::to_string(i) + "___");
+	sink.waitForArchives();
+
+	EXPECT_EQ(lz4::decompress(read(archiveName(1))), "line 6___\nline 7___\n");
+	EXPECT_EQ(lz4::decompress(read(archiveName(2))), "line 4___\nline 5___\n");
+	EXPECT_FALSE(std::filesystem::exists(archiveName(3)));
+
+	// No staging file is left behind once archived
+	size_t files = 0;
+	for ([[maybe_unused]] const auto &entry : std::filesystem::directory_iterator(directory))
+		++files;
+	EXPECT_EQ(files, 3u);
+}
+
+TEST_F(BatchedFileSinkTest, ArchivesStagedFilesLeftByAnEarlierProcess)
+{
+	{
+		std::ofstream staged(fileName + ".staged.7");
+		staged << "left behind\n";
+	}
+
+	BatchedFileSink sink(fileName, 1024 * 1024, 3, false, spdlog::level::err, 0ms, 4096, Codec::LZ4);
+	sink.waitForArchives();
+
+	EXPECT_EQ(lz4::decompress(read(archiveName(1))), "left behind\n");
+	EXPECT_FALSE(std::filesystem::exists(fileName + ".staged.7"));
+}
+
+TEST_F(BatchedFileSinkTest, RotatesWhenIntervalElapses)
+{
+	auto now = spdlog::log_clock::now();
+
+	{
+		BatchedFileSink sink(fileName, 1024 * 1024, 3, false, spdlog::level::err, 0ms, 4096, Codec::None, std::chrono::seconds(3600));
+		sink.set_pattern("%v");
+
+		logAt(sink, now, "this hour");
+		logAt(sink, now + 1h, "next hour");
+		logAt(sink, now + 1h, "same hour");
+		logAt(sink, now + 3h, "later");
+	}
+
+	EXPECT_EQ(read(rotatedName(2)), "this hour\n");
+	EXPECT_EQ(read(rotatedName(1)), "next hour\nsame hour\n");
+	EXPECT_EQ(read(fileName), "later\n");
+}
+
+TEST_F(BatchedFileSinkTest, IntervalDoesNotRotateEmptyFile)
+{
+	{
+		BatchedFileSink sink(fileName, 1024 * 1024, 3, false, spdlog::level::err, 0ms, 4096, Codec::None, std::chrono::seconds(60));
+		sink.set_pattern("%v");
+		logAt(sink, spdlog::log_clock::now() + 10min, "first line");
+	}
+
+	EXPECT_FALSE(std::filesystem::exists(rotatedName(1)));
+	EXPECT_EQ(read(fileName), "first line\n");
+}
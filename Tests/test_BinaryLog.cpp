@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "Logger.h"
+#include "BinaryLogReader.h"
+#include "BinaryLogWriter.h"
+#include "Formatter.h"
+
+
+namespace
+{
+
+template <typename... Args>
+std::string roundTrip(std::string_view format, const Args &...args)
+{
+	return BinaryLogReader::formatArguments(format, logging::binary::Signature<Args...>::value, logging::binary::encodeArgs(args...));
+}
+
+
+std::string tempPath(const char *name)
+{
+	return (std::filesystem::temp_directory_path() / name).string();
+}
+
+
+// Text the Formatter renders for a message logged directly, for comparison with the decoded record
+std::string formatterOutput(const logging::CallSite &site, int64_t timeNs, uint64_t threadId, const std::string &payload)
+{
+	auto					 time = spdlog::log_clock::time_point(std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(timeNs)));
+	spdlog::source_loc		 loc{site.file, site.line, site.function};
+	spdlog::details::log_msg msg(time, loc, "", static_cast<spdlog::level::level_enum>(site.level), payload);
+	msg.thread_id = static_cast<size_t>(threadId);
+
+	Formatter			 formatter;
+	spdlog::memory_buf_t buffer;
+	formatter.format(msg, buffer);
+	return std::string(buffer.data(), buffer.size());
+}
+
+} // namespace
+
+
+TEST(BinaryLog, DecodedArgumentsMatchStdFormat)
+{
+	int			  count	  = -42;
+	unsigned char byte	  = 200;
+	double		  ratio	  = 3.14159;
+	float		  scale	  = 0.1f;
+	std::string	  name	  = "worker";
+	const char	 *literal = "queue";
+
+	EXPECT_EQ(roundTrip("{} {} {} {}", count, byte, ratio, scale), std::format("{} {} {} {}", count, byte, ratio, scale));
+	EXPECT_EQ(roundTrip("[{:>10}] [{:<6}] {:.2f}", name, literal, ratio), std::format("[{:>10}] [{:<6}] {:.2f}", name, literal, ratio));
+	EXPECT_EQ(roundTrip("{:#x} {:08b} {:+d}", count, byte, count), std::format("{:#x} {:08b} {:+d}", count, byte, count));
+	EXPECT_EQ(roundTrip("{1} {0} {1}", name, count), std::format("{1} {0} {1}", name, count));
+	EXPECT_EQ(roundTrip("{{literal}} {:{}.{}f}", ratio, 12, 3), std::format("{{literal}} {:{}.{}f}", ratio, 12, 3));
+	EXPECT_EQ(roundTrip("{} {} {}", true, 'c', std::string_view("view")), std::format("{} {} {}", true, 'c', std::string_view("view")));
+}
+
+
+TEST(BinaryLog, UnsupportedArgumentTypesArePreformatted)
+{
+	EXPECT_TRUE((logging::binary::allEncodable<int, const char *, std::string &, double>));
+	EXPECT_FALSE((logging::binary::allEncodable<int, long double>));
+}
+
+
+TEST(BinaryLog, DecodedRecordsRenderLikeTheFormatter)
+{
+	static const logging::CallSite site{LogLevel::Warn, "/src/Network/Connection.cpp", 87, "reconnect", "Retry {} of {} for {}"};
+	static const logging::CallSite preformatted{LogLevel::Error, "/src/Main.cpp", 12, "main", "{}"};
+
+	auto							path = tempPath("logger_test_binary.bin");
+	int64_t							time = 1734956035123000000;
+
+	{
+		BinaryLogWriter writer(path);
+		writer.write(site, logging::binary::Signature<int, int, std::string>::value, logging::binary::encodeArgs(1, 5, std::string("db-01")), time, 4242);
+		writer.write(site, logging::binary::Signature<int, int, std::string>::value, logging::binary::encodeArgs(2, 5, std::string("db-02")), time + 1000000, 17);
+		writer.write(preformatted, logging::binary::Preformatted, logging::binary::encodeArgs(std::string("formatted elsewhere")), time + 2000000, 4242);
+	}
+
+	std::ifstream	input(path, std::ios::binary);
+	BinaryLogReader reader(input);
+	BinaryRecord	record;
+	std::string		decoded;
+
+	while (reader.next(record))
+	{
+		reader.render(record, decoded);
+	}
+
+	std::string expected = formatterOutput(site, time, 4242, "Retry 1 of 5 for db-01") + formatterOutput(site, time + 1000000, 17, "Retry 2 of 5 for db-02")
+						 + formatterOutput(preformatted, time + 2000000, 4242, "formatted elsewhere");
+
+	EXPECT_EQ(decoded, expected);
+
+	input.close();
+	std::remove(path.c_str());
+}
+
+
+TEST(BinaryLog, RejectsFilesWithoutHeader)
+{
+	std::istringstream input("not a binary log");
+	EXPECT_THROW(BinaryLogReader reader(input), std::runtime_error);
+}
+
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+#include "CategoryRegistry.h"
+
+
+TEST(CategoryRegistry, NewCategoryUsesDefaultLevel)
+{
+	CategoryRegistry registry;
+	EXPECT_EQ(registry.threshold("net").load(), LogLevel::Trace);
+
+	registry.setDefaultLevel(LogLevel::Info);
+	EXPECT_EQ(registry.threshold("net").load(), LogLevel::Info);
+	EXPECT_EQ(registry.threshold("db").load(), LogLevel::Info);
+}
+
+TEST(CategoryRegistry, ThresholdReferenceIsStable)
+{
+	CategoryRegistry registry;
+	auto			&net = registry.threshold("net");
+
+	for (int i = 0; i < 100; ++i)
+		registry.threshold("category" + std::to_string(i));
+
+	EXPECT_EQ(&registry.threshold("net"), &net);
+}
+
+TEST(CategoryRegistry, CategoryLevelOverridesDefault)
+{
+	CategoryRegistry registry;
+	auto			&net = registry.threshold("net");
+	auto			&db	 = registry.threshold("db");
+
+	registry.setDefaultLevel(LogLevel::Warn);
+	registry.setLevel("net", LogLevel::Debug);
+
+	EXPECT_EQ(net.load(), LogLevel::Debug);
+	EXPECT_EQ(db.load(), LogLevel::Warn);
+}
+
+TEST(CategoryRegistry, ThresholdIncludesMinimumOutputLevel)
+{
+	CategoryRegistry registry(LogLevel::Info);
+	registry.setLevel("net", LogLevel::Trace);
+	auto &net = registry.threshold("net");
+
+	// No output accepts Trace yet, so the category must not let it through
+	EXPECT_EQ(net.load(), LogLevel::Info);
+
+	registry.setMinimumLevel(LogLevel::Trace);
+	EXPECT_EQ(net.load(), LogLevel::Trace);
+}
+
+TEST(CategoryRegistry, ConfigureReplacesAllLevels)
+{
+	CategoryRegistry registry;
+	registry.setLevel("net", LogLevel::Trace);
+	registry.setLevel("db", LogLevel::Error);
+
+	registry.configure({{"db", LogLevel::Debug}, {"ui", LogLevel::Warn}}, LogLevel::Info);
+
+	EXPECT_EQ(registry.threshold("net").load(), LogLevel::Info); // Dropped: falls back to the default
+	EXPECT_EQ(registry.threshold("db").load(), LogLevel::Debug);
+	EXPECT_EQ(registry.threshold("ui").load(), LogLevel::Warn);
+	EXPECT_EQ(registry.threshold("other").load(), LogLevel::Info);
+}
@@ -0,0 +1,276 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ConfigWatcher.h"
+#include "LoggerWrapper.h"
+
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+
+class ConfigWatcherTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		directory = std::filesystem::temp_directory_path() / (std::string("logger_watch_") + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory);
+		configPath = directory / "logger_config.json";
+		write(configPath, "{}");
+	}
+
+	void		TearDown() override { std::filesystem::remove_all(directory); }
+
+	static void write(const std::filesystem::path &path, const std::string &content)
+	{
+		std::ofstream file(path);
+		file << content;
+	}
+
+	// Waits until the counter reaches the expected value or the timeout passes
+	static bool waitFor(const std::atomic<int> &counter, int expected, std::chrono::milliseconds timeout = 5s)
+	{
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		while (counter.load() < expected && std::chrono::steady_clock::now() < deadline)
+			std::this_thread::sleep_for(5ms);
+		return counter.load() >= expected;
+	}
+
+	std::filesystem::path directory;
+	std::filesystem::path configPath;
+};
+
+
+/*
+ *	@brief		Reloads through logging::watchConfig(). The logger watches one file per process, so the tests
+ *				share it and each one starts by writing the configuration it expects. Outputs belong to a named
+ *				logger, which keeps them apart from outputs other tests add to the default logger.
+ */
+class ConfigReloadTest : public ::testing::Test
+{
+protected:
+	static void SetUpTestSuite()
+	{
+		directory = std::filesystem::temp_directory_path() / "logger_reload";
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory);
+		configPath = directory / "logger_config.json";
+		replace(R"({"sinks": []})");
+		logging::watchConfig(configPath.string());
+	}
+
+	// Replaces the file the way editors save it, so the watcher never reads it half written
+	static void replace(const std::string &content)
+	{
+		auto temporary = directory / "logger_config.json.tmp";
+		std::ofstream(temporary) << content;
+		std::filesystem::rename(temporary, configPath);
+	}
+
+	static std::string file(const std::string &name) { return (directory / name).string(); }
+
+	// A sink list of file outputs of the test logger, each given as file name and level
+	static std::string fileOutputs(const std::vector<std::pair<std::string, std::string>> &outputs)
+	{
+		std::string sinks;
+		for (auto &[name, level] : outputs)
+		{
+			if (!sinks.empty())
+				sinks += ", ";
+			sinks += R"({"type": "file", "logger": "reload_test", "level": ")" + level + R"(", "file_name": ")" + file(name) + R"("})";
+		}
+		return R"({"sinks": [)" + sinks + "]}";
+	}
+
+	// Outputs of the test logger by file name
+	static std::map<std::string, OutputHandle> outputs()
+	{
+		std::map<std::string, OutputHandle> handles;
+		for (const auto &output : logging::stats().outputs)
+		{
+			if (output.logger == "reload_test")
+				handles[output.name.substr(output.name.rfind('/') + 1)] = output.handle;
+		}
+		return handles;
+	}
+
+	template <typename Condition>
+	static bool waitUntil(Condition condition, std::chrono::milliseconds timeout = 5s)
+	{
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		while (!condition() && std::chrono::steady_clock::now() < deadline)
+			std::this_thread::sleep_for(5ms);
+		return condition();
+	}
+
+	static bool waitForFiles(const std::vector<std::string> &names)
+	{
+		return waitUntil(
+			[&]
+			{
+				auto current = outputs();
+				return current.size() == names.size() && std::all_of(names.begin(), names.end(), [&](const std::string &name) { return current.contains(name); });
+			});
+	}
+
+	static inline std::filesystem::path directory;
+	static inline std::filesystem::path configPath;
+};
+
+} // namespace
+
+
+TEST_F(ConfigWatcherTest, ReportsWriteInPlace)
+{
+	std::atomic<int> changes{0};
+	ConfigWatcher	 watcher(configPath, [&] { ++changes; }, 10ms);
+
+	std::this_thread::sleep_for(50ms);
+	write(configPath, R"({"sinks": []})");
+
+	EXPECT_TRUE(waitFor(changes, 1));
+}
+
+TEST_F(ConfigWatcherTest, ReportsReplacementByRename)
+{
+	std::atomic<int> changes{0};
+	ConfigWatcher	 watcher(configPath, [&] { ++changes; }, 10ms);
+
+	auto			 temporary = directory / "logger_config.json.tmp";
+	write(temporary, R"({"sinks": []})");
+	std::filesystem::rename(temporary, configPath);
+
+	EXPECT_TRUE(waitFor(changes, 1));
+}
+
+TEST_F(ConfigWatcherTest, IgnoresOtherFilesInDirectory)
+{
+	std::atomic<int> changes{0};
+	ConfigWatcher	 watcher(configPath, [&] { ++changes; }, 10ms);
+
+	write(directory / "other.json", "{}");
+
+	EXPECT_FALSE(waitFor(changes, 1, 300ms));
+}
+
+TEST_F(ConfigWatcherTest, ReportsBurstOfWritesOnce)
+{
+	std::atomic<int> changes{0};
+	ConfigWatcher	 watcher(configPath, [&] { ++changes; }, 200ms);
+
+	for (int i = 0; i < 5; ++i)
+		write(configPath, std::to_string(i));
+
+	EXPECT_TRUE(waitFor(changes, 1));
+	std::this_thread::sleep_for(300ms);
+	EXPECT_EQ(changes.load(), 1);
+}
+
+TEST_F(ConfigWatcherTest, CallbackErrorsDoNotStopWatching)
+{
+	std::atomic<int> changes{0};
+	ConfigWatcher	 watcher(
+		   configPath,
+		   [&]
+		   {
+			   ++changes;
+			   throw std::runtime_error("invalid config");
+		   },
+		   10ms);
+
+	write(configPath, "first");
+	ASSERT_TRUE(waitFor(changes, 1));
+
+	write(configPath, "second");
+	EXPECT_TRUE(waitFor(changes, 2));
+}
+
+TEST_F(ConfigWatcherTest, DestructorReturnsPromptly)
+{
+	auto start = std::chrono::steady_clock::now();
+	{
+		ConfigWatcher watcher(configPath, [] {}, 10ms);
+	}
+	EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+}
+
+
+TEST_F(ConfigReloadTest, LevelChangeKeepsTheOutput)
+{
+	auto logger = logging::get("reload_test");
+	replace(fileOutputs({{"a.log", "warn"}}));
+	ASSERT_TRUE(waitForFiles({"a.log"}));
+	ASSERT_TRUE(waitUntil([&] { return !logger.isEnabled(LogLevel::Info); }));
+	auto handle = outputs()["a.log"];
+
+	replace(fileOutputs({{"a.log", "info"}}));
+	EXPECT_TRUE(waitUntil([&] { return logger.isEnabled(LogLevel::Info); }));
+	EXPECT_EQ(outputs(), (std::map<std::string, OutputHandle>{{"a.log", handle}}));
+}
+
+TEST_F(ConfigReloadTest, AddedEntryAppearsAndRemovedEntryDisappears)
+{
+	replace(fileOutputs({{"a.log", "info"}}));
+	ASSERT_TRUE(waitForFiles({"a.log"}));
+	auto first = outputs()["a.log"];
+
+	replace(fileOutputs({{"a.log", "info"}, {"b.log", "info"}}));
+	ASSERT_TRUE(waitForFiles({"a.log", "b.log"}));
+	EXPECT_EQ(outputs()["a.log"], first);
+	auto second = outputs()["b.log"];
+
+	replace(fileOutputs({{"b.log", "info"}}));
+	ASSERT_TRUE(waitForFiles({"b.log"}));
+	EXPECT_EQ(outputs()["b.log"], second);
+	EXPECT_FALSE(logging::removeOutput(first)); // Already removed by the reload
+}
+
+TEST_F(ConfigReloadTest, UnparsableFileKeepsTheConfig)
+{
+	replace(fileOutputs({{"a.log", "info"}}));
+	ASSERT_TRUE(waitForFiles({"a.log"}));
+	auto before = outputs();
+
+	replace(R"({"sinks": [{"type": "file", )");
+	std::this_thread::sleep_for(300ms);
+	EXPECT_EQ(outputs(), before);
+
+	// Still watching: the next valid file is applied
+	replace(fileOutputs({{"b.log", "info"}}));
+	EXPECT_TRUE(waitForFiles({"b.log"}));
+}
+
+TEST_F(ConfigReloadTest, BinaryOutputFollowsTheFile)
+{
+	auto binaryOutput = [](const std::string &name, const std::string &level)
+	{ return R"({"sinks": [{"type": "binary_file", "level": ")" + level + R"(", "file_name": ")" + file(name) + R"("}]})"; };
+	auto binaryLevel = [] { return logging::minimumBinaryLevel.load(); };
+
+	replace(binaryOutput("a.bin", "warn"));
+	ASSERT_TRUE(waitUntil([&] { return binaryLevel() == LogLevel::Warn; }));
+	EXPECT_TRUE(std::filesystem::exists(file("a.bin")));
+
+	replace(binaryOutput("a.bin", "error"));
+	EXPECT_TRUE(waitUntil([&] { return binaryLevel() == LogLevel::Error; }));
+
+	// A changed file name replaces the output, although only one binary output may exist at a time
+	replace(binaryOutput("b.bin", "error"));
+	EXPECT_TRUE(waitUntil([&] { return std::filesystem::exists(file("b.bin")); }));
+	EXPECT_EQ(binaryLevel(), LogLevel::Error);
+
+	replace(R"({"sinks": []})");
+	EXPECT_TRUE(waitUntil([&] { return binaryLevel() == LogLevel::Off; }));
+}
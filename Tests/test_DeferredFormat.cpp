@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AsyncWriter.h"
+#include "DeferredFormat.h"
+#include "PrintMacros.h"
+#include "RecordingSink.h"
+#include "StagingWriter.h"
+
+
+namespace
+{
+
+// Trivially copyable, but only points to its text
+struct BorrowedText
+{
+	const char *text;
+};
+
+// Trivially copyable and owns its data, opted into byte capture below
+struct OwnedPoint
+{
+	int x;
+	int y;
+};
+
+} // namespace
+
+
+template <>
+struct std::formatter<BorrowedText> : std::formatter<std::string_view>
+{
+	auto format(const BorrowedText &borrowed, std::format_context &ctx) const { return std::format_to(ctx.out(), "{}", borrowed.text); }
+};
+
+template <>
+struct std::formatter<OwnedPoint> : std::formatter<std::string_view>
+{
+	auto format(const OwnedPoint &point, std::format_context &ctx) const { return std::format_to(ctx.out(), "({}, {})", point.x, point.y); }
+};
+
+template <>
+struct logging::deferred::CaptureAsBytes<OwnedPoint> : std::true_type
+{
+};
+
+
+namespace
+{
+
+// Captures the arguments like a LOG_* call with deferred formatting and formats them like the writer thread
+template <typename... Args>
+std::string captureAndFormat(std::string_view format, const Args &...args)
+{
+	std::string captured(logging::deferred::captureArgs(args...));
+	std::string text;
+	logging::deferred::formatCaptured<std::remove_cvref_t<Args>...>(text, format, captured);
+	return text;
+}
+
+} // namespace
+
+
+static_assert(logging::deferred::allCapturable<int, double, const char *, std::string, std::string_view, const char (&)[4], bool, char>);
+static_assert(!logging::deferred::capturable<std::vector<int>>);
+static_assert(logging::deferred::allCapturable<std::chrono::milliseconds, std::chrono::system_clock::time_point, const void *, std::nullptr_t, OwnedPoint>);
+static_assert(!logging::deferred::capturable<BorrowedText>);
+
+
+TEST(DeferredFormat, MatchesStdFormat)
+{
+	std::string		 name = "alice";
+	std::string_view view = "view";
+	const char		*text = "text";
+
+	EXPECT_EQ(captureAndFormat("{} {:>6} {:.2f} {:#x} {} {}", 42, name, 3.14159, 255u, true, 'c'), std::format("{} {:>6} {:.2f} {:#x} {} {}", 42, name, 3.14159, 255u, true, 'c'));
+	EXPECT_EQ(captureAndFormat("{} {} {} {}", view, text, "literal", int64_t{-7}), "view text literal -7");
+	EXPECT_EQ(captureAndFormat("no arguments {{}}"), "no arguments {}");
+}
+
+TEST(DeferredFormat, StringsAreCopied)
+{
+	std::string name = "before";
+	std::string captured(logging::deferred::captureArgs(name, static_cast<const char *>(nullptr)));
+	name = "after, and long enough to reallocate the string";
+
+	std::string text;
+	logging::deferred::formatCaptured<std::string, const char *>(text, "{}|{}", captured);
+	EXPECT_EQ(text, "before|");
+}
+
+TEST(DeferredFormat, AsyncWriterFormatsOnWriterThread)
+{
+	auto sink	= std::make_shared<RecordingSink>();
+	auto logger = std::make_shared<spdlog::logger>("deferred_test", sink);
+
+	{
+		AsyncWriter writer(logger, 16, OverflowPolicy::Block);
+		for (int i = 0; i < 20; ++i)
+		{
+			writer.enqueue({spdlog::log_clock::now(), 1, spdlog::level::info, 10, "/src/Foo.cpp", "doWork", std::string(logging::deferred::captureArgs(i, "items")), {},
+							logging::deferred::formatCaptured<int, char[6]>, "queued {} {}"});
+		}
+	}
+
+	ASSERT_EQ(sink->payloads.size(), 20u);
+	EXPECT_EQ(sink->payloads.front(), "queued 0 items");
+	EXPECT_EQ(sink->payloads.back(), "queued 19 items");
+}
+
+TEST(DeferredFormat, StagingWriterResetsReusedSlots)
+{
+	auto sink	= std::make_shared<RecordingSink>();
+	auto logger = std::make_shared<spdlog::logger>("deferred_staging_test", sink);
+
+	{
+		StagingWriter writer(logger, 4, OverflowPolicy::Block);
+		for (int i = 0; i < 10; ++i)
+		{
+			if (i % 2 == 0)
+				writer.enqueue(spdlog::log_clock::now(), 1, spdlog::level::info, 10, "/src/Foo.cpp", "doWork", logging::deferred::captureArgs(i), {},
+							   logging::deferred::formatCaptured<int>, "deferred {}");
+			else
+				writer.enqueue(spdlog::log_clock::now(), 1, spdlog::level::info, 10, "/src/Foo.cpp", "doWork", "formatted " + std::to_string(i));
+		}
+	}
+
+	ASSERT_EQ(sink->payloads.size(), 10u);
+	for (int i = 0; i < 10; ++i)
+	{
+		EXPECT_EQ(sink->payloads[i], (i % 2 == 0 ? "deferred " : "formatted ") + std::to_string(i));
+	}
+}
+
+TEST(DeferredFormat, OtherTypesAreFormattedByTheCaller)
+{
+	OutputHandle output = OutputHandle::Invalid;
+	logging::addRingBufferOutput().setCapacity(8).setLevel(LogLevel::Info).storeHandleIn(output);
+	bool  previous = logging::deferredFormatting.exchange(true);
+	auto &captured = logging::deferred::captureBuffer();
+
+	captured = "untouched";
+	LOG_INFO("borrowed {}", BorrowedText{"text"});
+	EXPECT_EQ(captured, "untouched");
+
+	LOG_INFO("no arguments");
+	EXPECT_EQ(captured, "untouched");
+
+	LOG_INFO("owned {}", OwnedPoint{1, 2});
+	EXPECT_NE(captured, "untouched");
+
+	logging::deferredFormatting.store(previous);
+	EXPECT_TRUE(logging::removeOutput(output));
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <spdlog/sinks/ostream_sink.h>
+
+#include "DuplicateFilterSink.h"
+
+
+namespace
+{
+
+class DuplicateFilterSinkTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		auto target = std::make_shared<spdlog::sinks::ostream_sink_st>(output);
+		target->set_pattern("%v");
+
+		filter = std::make_shared<DuplicateFilterSink>(std::chrono::seconds(1));
+		filter->add_sink(target);
+	}
+
+	void log(const char *payload, std::chrono::milliseconds at, int line = 10)
+	{
+		spdlog::source_loc		 loc("/src/Foo.cpp", line, "doWork");
+		spdlog::details::log_msg msg(start + at, loc, "test_logger", spdlog::level::info, payload);
+		filter->log(msg);
+	}
+
+	std::ostringstream					 output;
+	std::shared_ptr<DuplicateFilterSink> filter;
+	spdlog::log_clock::time_point		 start = spdlog::log_clock::now();
+};
+
+} // namespace
+
+
+TEST_F(DuplicateFilterSinkTest, SuppressesRepeatsAndReportsSkipCount)
+{
+	log("connection refused", std::chrono::milliseconds(0));
+	log("connection refused", std::chrono::milliseconds(10));
+	log("connection refused", std::chrono::milliseconds(20));
+	log("recovered", std::chrono::milliseconds(30));
+
+	EXPECT_EQ(output.str(), "connection refused\nSkipped 2 duplicate messages\nrecovered\n");
+}
+
+TEST_F(DuplicateFilterSinkTest, ForwardsRepeatAfterSkipDurationExpires)
+{
+	log("tick", std::chrono::milliseconds(0));
+	log("tick", std::chrono::milliseconds(500));
+	log("tick", std::chrono::milliseconds(1500));
+
+	EXPECT_EQ(output.str(), "tick\nSkipped 1 duplicate messages\ntick\n");
+}
+
+TEST_F(DuplicateFilterSinkTest, TreatsSamePayloadFromOtherCallSiteAsDistinct)
+{
+	log("retrying", std::chrono::milliseconds(0), 10);
+	log("retrying", std::chrono::milliseconds(10), 20);
+
+	EXPECT_EQ(output.str(), "retrying\nretrying\n");
+}
+
+TEST(DuplicateFilterSink, HashDependsOnSourceAndPayload)
+{
+	spdlog::source_loc		 loc("/src/Foo.cpp", 10, "doWork");
+	spdlog::source_loc		 otherLine("/src/Foo.cpp", 11, "doWork");
+
+	spdlog::details::log_msg msg(loc, "test_logger", spdlog::level::info, "payload");
+	spdlog::details::log_msg same(loc, "test_logger", spdlog::level::warn, "payload");
+	spdlog::details::log_msg otherPayload(loc, "test_logger", spdlog::level::info, "payloaD");
+	spdlog::details::log_msg otherSource(otherLine, "test_logger", spdlog::level::info, "payload");
+
+	EXPECT_EQ(DuplicateFilterSink::hashMessage(msg), DuplicateFilterSink::hashMessage(same));
+	EXPECT_NE(DuplicateFilterSink::hashMessage(msg), DuplicateFilterSink::hashMessage(otherPayload));
+	EXPECT_NE(DuplicateFilterSink::hashMessage(msg), DuplicateFilterSink::hashMessage(otherSource));
+}
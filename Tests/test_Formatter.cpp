@@ -1,6 +1,14 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <ctime>
+#include <format>
+#include <string>
+#include <vector>
+
 #include "Formatter.h"
+#include "KeyValue.h"
+#include "LoggerWrapper.h"
 
 
 namespace
@@ -18,6 +26,40 @@ std::string formatMessage(spdlog::level::level_enum level, const char *filename,
 	return std::string(dest.data(), dest.size());
 }
 
+
+std::string formatWith(Formatter &formatter, const spdlog::details::log_msg &msg)
+{
+	spdlog::memory_buf_t dest;
+	formatter.format(msg, dest);
+	return std::string(dest.data(), dest.size());
+}
+
+
+spdlog::details::log_msg sampleMessage(const char *payload = "hello")
+{
+	spdlog::details::log_msg msg(spdlog::source_loc("/some/nested/path/MyModule.cpp", 42, "processIncomingRequest"), "test_logger", spdlog::level::warn, payload);
+	msg.thread_id = 1234;
+	return msg;
+}
+
+
+// Timestamp built the way the layout was originally specified, without any caching
+std::string referenceTime(const spdlog::log_clock::time_point &tp)
+{
+	auto		secs = std::chrono::duration_cast<std::chrono::seconds>(tp.time_since_epoch());
+	auto		ms	 = std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()) - std::chrono::duration_cast<std::chrono::milliseconds>(secs);
+	std::time_t t	 = static_cast<std::time_t>(secs.count());
+	std::tm		tm_local;
+#if defined(_WIN32)
+	localtime_s(&tm_local, &t);
+#else
+	localtime_r(&t, &tm_local);
+#endif
+	char dateTime[64];
+	std::strftime(dateTime, sizeof(dateTime), "%Y-%m-%d %H:%M:%S", &tm_local);
+	return std::format("{}.{:03}", dateTime, ms.count());
+}
+
 } // namespace
 
 
@@ -69,3 +111,190 @@ TEST(Formatter, CloneProducesEquivalentOutput)
 
 	EXPECT_EQ(std::string(originalDest.data(), originalDest.size()), std::string(clonedDest.data(), clonedDest.size()));
 }
+
+TEST(Formatter, MatchesReferenceColumnLayout)
+{
+	spdlog::source_loc		 loc("/some/nested/path/MyModule.cpp", 42, "processIncomingRequest");
+	spdlog::details::log_msg msg(loc, "test_logger", spdlog::level::warn, "payload with {braces}");
+	msg.thread_id = 1234;
+
+	Formatter			 formatter;
+	spdlog::memory_buf_t dest;
+	formatter.format(msg, dest);
+
+	auto expected = std::format("{:<25.25} {:>8} {:<8.8} {:<20.20} {:<45.45} {}\n", referenceTime(msg.time), 1234, "warning", "MyModule", "processIncomingRequest", "payload with {braces}");
+
+	EXPECT_EQ(std::string(dest.data(), dest.size()), expected);
+}
+
+TEST(Formatter, TruncatesColumnsToTheirWidth)
+{
+	std::string longFunction(60, 'f');
+	auto		line = formatMessage(spdlog::level::critical, "/src/AVeryLongSourceFileNameThatExceedsTheColumn.cpp", 1, longFunction.c_str(), "msg");
+
+	EXPECT_NE(line.find("AVeryLongSourceFileN "), std::string::npos);
+	EXPECT_NE(line.find(std::string(45, 'f') + " msg"), std::string::npos);
+	EXPECT_EQ(line.find(std::string(46, 'f')), std::string::npos);
+}
+
+TEST(Formatter, TimestampFollowsSecondAndMillisecondChanges)
+{
+	using namespace std::chrono;
+
+	spdlog::source_loc		 loc("/src/Foo.cpp", 10, "doWork");
+	spdlog::details::log_msg msg(loc, "test_logger", spdlog::level::info, "tick");
+	auto					 base = time_point_cast<seconds>(msg.time);
+
+	Formatter				 formatter;
+	for (auto offset : {5ms, 999ms, 1001ms, 1002ms, 59999ms, 60000ms, 3600000ms, 5ms})
+	{
+		msg.time = base + offset;
+
+		spdlog::memory_buf_t dest;
+		formatter.format(msg, dest);
+
+		EXPECT_EQ(std::string(dest.data(), 23), referenceTime(msg.time)) << "offset " << offset.count() << "ms";
+	}
+}
+
+TEST(Formatter, ResolvesBasenamesForManyDistinctSourceFiles)
+{
+	// More files than basename cache slots, so entries get evicted and recomputed
+	std::vector<std::string> paths;
+	for (int i = 0; i < 200; ++i)
+		paths.push_back("/src/module" + std::to_string(i) + "/File" + std::to_string(i) + ".cpp");
+
+	Formatter formatter;
+	for (int round = 0; round < 2; ++round)
+	{
+		for (int i = 0; i < 200; ++i)
+		{
+			spdlog::source_loc		 loc(paths[i].c_str(), 1, "f");
+			spdlog::details::log_msg msg(loc, "test_logger", spdlog::level::info, "msg");
+
+			spdlog::memory_buf_t	 dest;
+			formatter.format(msg, dest);
+
+			std::string line(dest.data(), dest.size());
+			auto		expected = "File" + std::to_string(i) + " ";
+			EXPECT_NE(line.find(expected), std::string::npos) << line;
+		}
+	}
+}
+
+
+TEST(Formatter, CompiledDefaultLayoutMatchesHandWrittenOne)
+{
+	// Same layout as DefaultPattern, spelled differently so it runs through the compiled program
+	Formatter defaultLayout;
+	Formatter compiled("%Y-%m-%d %T.%e   %8t %-8!l %-20!s %-45!! %v");
+
+	auto	  msg = sampleMessage();
+	EXPECT_EQ(formatWith(compiled, msg), formatWith(defaultLayout, msg));
+
+	msg.source.filename = "/src/AVeryLongSourceFileNameThatExceedsTheColumn.cpp";
+	msg.level			= spdlog::level::critical;
+	EXPECT_EQ(formatWith(compiled, msg), formatWith(defaultLayout, msg));
+}
+
+TEST(Formatter, FormatsCompactPattern)
+{
+	Formatter formatter("%L %s:%# %v");
+	auto	  msg = sampleMessage("compact");
+
+	EXPECT_EQ(formatWith(formatter, msg), "W MyModule:42 compact\n");
+}
+
+TEST(Formatter, FormatsTimeFlags)
+{
+	using namespace std::chrono;
+
+	Formatter formatter("[%H:%M:%S.%f|%F|%e] %%%v");
+	auto	  msg = sampleMessage("x");
+	msg.time	  = time_point_cast<seconds>(msg.time) + 123456789ns;
+
+	std::string expectedTime = referenceTime(msg.time).substr(11, 8);
+	EXPECT_EQ(formatWith(formatter, msg), "[" + expectedTime + ".123456|123456789|123] %x\n");
+}
+
+TEST(Formatter, PadsAndTruncatesFields)
+{
+	Formatter formatter("|%8l|%-8l|%=9l|%3!l|%-3!s|%2t|%v");
+	auto	  msg = sampleMessage("end");
+
+	EXPECT_EQ(formatWith(formatter, msg), "| warning|warning | warning |war|MyM|1234|end\n");
+}
+
+TEST(Formatter, RecordsColorRange)
+{
+	Formatter formatter("[%^%l%$] %v");
+	auto	  msg = sampleMessage();
+
+	EXPECT_EQ(formatWith(formatter, msg), "[warning] hello\n");
+	EXPECT_EQ(msg.color_range_start, 1u);
+	EXPECT_EQ(msg.color_range_end, 8u);
+}
+
+TEST(Formatter, PatternTimestampFollowsSecondChanges)
+{
+	using namespace std::chrono;
+
+	Formatter formatter("%Y-%m-%d %H:%M:%S.%e %v");
+	auto	  msg  = sampleMessage("tick");
+	auto	  base = time_point_cast<seconds>(msg.time);
+
+	for (auto offset : {5ms, 999ms, 1001ms, 60000ms, 3600000ms, 5ms})
+	{
+		msg.time = base + offset;
+		EXPECT_EQ(formatWith(formatter, msg), referenceTime(msg.time) + " tick\n") << "offset " << offset.count() << "ms";
+	}
+}
+
+TEST(Formatter, CloneKeepsPattern)
+{
+	Formatter original("%l: %v");
+	auto	  cloned = original.clone();
+	auto	  msg	 = sampleMessage();
+
+	spdlog::memory_buf_t dest;
+	cloned->format(msg, dest);
+	EXPECT_EQ(std::string(dest.data(), dest.size()), "warning: hello\n");
+}
+
+TEST(Formatter, RejectsInvalidPatterns)
+{
+	EXPECT_THROW(Formatter("%q"), std::invalid_argument);
+	EXPECT_THROW(Formatter("trailing %"), std::invalid_argument);
+	EXPECT_THROW(Formatter("%-l"), std::invalid_argument);
+	EXPECT_THROW(Formatter("%99999v"), std::invalid_argument);
+}
+
+TEST(Formatter, FieldsFollowTheMessage)
+{
+	std::string fields;
+	logging::kv::encodeFields(fields, "user_id", uint64_t{42}, "delta", -7, "latency_us", 17.25, "cached", true, "agent", "Mozilla 5.0", "grade", 'A');
+
+	std::string expected = "done";
+	logging::kv::appendTextFields(expected, "user_id", uint64_t{42}, "delta", -7, "latency_us", 17.25, "cached", true, "agent", "Mozilla 5.0", "grade", 'A');
+
+	logging::kv::ScopedFields scope(fields);
+	auto					  msg = sampleMessage("done");
+
+	Formatter				  pattern("%v|");
+	EXPECT_EQ(formatWith(pattern, msg), expected + "|\n");
+
+	Formatter defaultLayout;
+	EXPECT_TRUE(formatWith(defaultLayout, msg).ends_with(" " + expected + "\n"));
+}
+
+TEST(Formatter, PaddingCoversMessageAndFields)
+{
+	std::string fields;
+	logging::kv::encodeFields(fields, "id", 7);
+
+	logging::kv::ScopedFields scope(fields);
+	auto					  msg = sampleMessage("m");
+
+	Formatter				  formatter("[%-8v][%3!v]");
+	EXPECT_EQ(formatWith(formatter, msg), "[m id=7  ][m i]\n");
+}
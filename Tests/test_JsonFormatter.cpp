@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "JsonFormatter.h"
+#include "KeyValue.h"
+
+
+namespace
+{
+
+std::string formatLine(std::string_view payload, std::string_view fields = {}, spdlog::source_loc loc = {"/src/Net.cpp", 12, "connect"})
+{
+	logging::kv::ScopedFields scope(fields);
+	spdlog::details::log_msg  msg(loc, "test_logger", spdlog::level::warn, payload);
+	msg.thread_id = 77;
+
+	JsonFormatter		 formatter;
+	spdlog::memory_buf_t dest;
+	formatter.format(msg, dest);
+	return std::string(dest.data(), dest.size());
+}
+
+
+std::string appendString(std::string_view text)
+{
+	spdlog::memory_buf_t dest;
+	JsonFormatter::appendString(dest, text);
+	return std::string(dest.data(), dest.size());
+}
+
+} // namespace
+
+
+TEST(JsonFormatter, WritesOneObjectPerLine)
+{
+	auto line = formatLine("connected");
+
+	ASSERT_FALSE(line.empty());
+	EXPECT_EQ(line.back(), '\n');
+	EXPECT_EQ(line.find('\n'), line.size() - 1);
+
+	auto json = nlohmann::json::parse(line);
+	EXPECT_EQ(json["level"], "warn");
+	EXPECT_EQ(json["thread"], 77);
+	EXPECT_EQ(json["file"], "/src/Net.cpp");
+	EXPECT_EQ(json["line"], 12);
+	EXPECT_EQ(json["function"], "connect");
+	EXPECT_EQ(json["message"], "connected");
+}
+
+TEST(JsonFormatter, TimeIsUtcWithMicroseconds)
+{
+	auto time = nlohmann::json::parse(formatLine("m"))["time"].get<std::string>();
+
+	// 2024-05-01T12:00:00.123456Z
+	ASSERT_EQ(time.size(), 27u);
+	EXPECT_EQ(time[10], 'T');
+	EXPECT_EQ(time[19], '.');
+	EXPECT_EQ(time.back(), 'Z');
+}
+
+TEST(JsonFormatter, OmitsEmptySourceLocation)
+{
+	auto json = nlohmann::json::parse(formatLine("m", {}, spdlog::source_loc{}));
+
+	EXPECT_FALSE(json.contains("file"));
+	EXPECT_FALSE(json.contains("line"));
+	EXPECT_EQ(json["message"], "m");
+}
+
+TEST(JsonFormatter, EscapesStrings)
+{
+	EXPECT_EQ(appendString("plain"), R"("plain")");
+	EXPECT_EQ(appendString("quote \" backslash \\"), R"("quote \" backslash \\")");
+	EXPECT_EQ(appendString("line\nbreak\ttab"), R"("line\nbreak\ttab")");
+	EXPECT_EQ(appendString(std::string_view("\x01\x1f", 2)), R"("\u0001\u001f")");
+	EXPECT_EQ(appendString("caf\xc3\xa9"), "\"caf\xc3\xa9\"");
+}
+
+TEST(JsonFormatter, FieldsKeepTheirType)
+{
+	std::string fields;
+	logging::kv::encodeField(fields, "user_id", uint64_t{42});
+	logging::kv::encodeField(fields, "delta", -7);
+	logging::kv::encodeField(fields, "latency_us", 17.25);
+	logging::kv::encodeField(fields, "cached", true);
+	logging::kv::encodeField(fields, "name", "alice \"a\"");
+	logging::kv::encodeField(fields, "grade", 'A');
+
+	auto json = nlohmann::json::parse(formatLine("request done", fields));
+
+	EXPECT_EQ(json["message"], "request done");
+	EXPECT_EQ(json["user_id"], 42);
+	EXPECT_EQ(json["delta"], -7);
+	EXPECT_DOUBLE_EQ(json["latency_us"].get<double>(), 17.25);
+	EXPECT_EQ(json["cached"], true);
+	EXPECT_EQ(json["name"], "alice \"a\"");
+	EXPECT_EQ(json["grade"], "A");
+}
+
+TEST(JsonFormatter, NonFiniteNumbersBecomeNull)
+{
+	std::string fields;
+	logging::kv::encodeField(fields, "ratio", std::numeric_limits<double>::quiet_NaN());
+
+	auto json = nlohmann::json::parse(formatLine("m", fields));
+
+	EXPECT_TRUE(json["ratio"].is_null());
+}
+
+TEST(JsonFormatter, TruncatedFieldsKeepLineValid)
+{
+	std::string fields;
+	logging::kv::encodeField(fields, "user_id", uint64_t{42});
+	fields.resize(fields.size() - 3);
+
+	auto json = nlohmann::json::parse(formatLine("m", fields));
+
+	EXPECT_TRUE(json["user_id"].is_null());
+}
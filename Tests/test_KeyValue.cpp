@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "KeyValue.h"
+#include "PrintMacros.h"
+
+
+namespace
+{
+
+struct Point
+{
+	int x;
+	int y;
+};
+
+} // namespace
+
+
+template <>
+struct std::formatter<Point> : std::formatter<std::string_view>
+{
+	auto format(const Point &point, std::format_context &ctx) const { return std::format_to(ctx.out(), "({}, {})", point.x, point.y); }
+};
+
+
+namespace
+{
+
+// Text rendering and encoding of the key-value pairs, as LOG_*_KV produces them
+template <typename... KeyValues>
+std::pair<std::string, std::string> render(std::string_view message, const KeyValues &...keyValues)
+{
+	std::string text(message);
+	std::string fields;
+	logging::kv::appendTextFields(text, keyValues...);
+	logging::kv::encodeFields(fields, keyValues...);
+	return {text, fields};
+}
+
+
+std::string firstLine(const std::filesystem::path &path)
+{
+	std::ifstream file(path);
+	std::string	  line;
+	std::getline(file, line);
+	return line;
+}
+
+} // namespace
+
+
+TEST(KeyValue, TextAppendsKeyValuePairs)
+{
+	auto [text, fields] = render("request done", "user_id", 42, "latency_us", 17.5, "cached", true);
+
+	EXPECT_EQ(text, "request done user_id=42 latency_us=17.5 cached=true");
+}
+
+TEST(KeyValue, TextQuotesAmbiguousStrings)
+{
+	auto [text, fields] = render("login", "user", "alice", "agent", std::string("Mozilla 5.0"), "note", "say \"hi\"", "empty", "");
+
+	EXPECT_EQ(text, R"(login user=alice agent="Mozilla 5.0" note="say \"hi\"" empty="")");
+}
+
+TEST(KeyValue, MessageWithoutFields)
+{
+	auto [text, fields] = render("started");
+
+	EXPECT_EQ(text, "started");
+	EXPECT_TRUE(fields.empty());
+}
+
+TEST(KeyValue, EncodesKeyTypeAndValue)
+{
+	auto [text, fields] = render("m", "id", int32_t{7});
+
+	std::string expected;
+	logging::binary::appendString(expected, "id");
+	expected.push_back(static_cast<char>(logging::binary::ArgType::Int32));
+	logging::binary::appendRaw(expected, int32_t{7});
+
+	EXPECT_EQ(fields, expected);
+}
+
+TEST(KeyValue, FormatsOtherTypesAsStrings)
+{
+	auto [text, fields] = render("moved", "to", Point{3, 4});
+
+	EXPECT_EQ(text, "moved to=(3, 4)");
+
+	std::string expected;
+	logging::binary::appendString(expected, "to");
+	expected.push_back(static_cast<char>(logging::binary::ArgType::String));
+	logging::binary::appendString(expected, "(3, 4)");
+
+	EXPECT_EQ(fields, expected);
+}
+
+TEST(KeyValue, ScopedFieldsRestoresPrevious)
+{
+	EXPECT_TRUE(logging::kv::currentFields().empty());
+	{
+		logging::kv::ScopedFields outer("outer");
+		{
+			logging::kv::ScopedFields inner("inner");
+			EXPECT_EQ(logging::kv::currentFields(), "inner");
+		}
+		EXPECT_EQ(logging::kv::currentFields(), "outer");
+	}
+	EXPECT_TRUE(logging::kv::currentFields().empty());
+}
+
+TEST(KeyValue, OutputsGetMessageAndFieldsOnce)
+{
+	auto directory = std::filesystem::temp_directory_path() / "logger_key_value";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	OutputHandle text = OutputHandle::Invalid;
+	OutputHandle json = OutputHandle::Invalid;
+	logging::addFileOutput().setFilename((directory / "app.log").string()).setPattern("%v").setLevel(LogLevel::Info).storeHandleIn(text);
+	logging::addJsonFileOutput().setFilename((directory / "app.jsonl").string()).setLevel(LogLevel::Info).storeHandleIn(json);
+
+	LOG_INFO_KV("request done", "user_id", 42, "latency_us", 17.25, "agent", "Mozilla 5.0");
+
+	// Removing the outputs closes and flushes their files
+	ASSERT_TRUE(logging::removeOutput(text));
+	ASSERT_TRUE(logging::removeOutput(json));
+
+	EXPECT_EQ(firstLine(directory / "app.log"), R"(request done user_id=42 latency_us=17.25 agent="Mozilla 5.0")");
+
+	auto object = nlohmann::json::parse(firstLine(directory / "app.jsonl"));
+	EXPECT_EQ(object["message"], "request done");
+	EXPECT_EQ(object["user_id"], 42);
+	EXPECT_DOUBLE_EQ(object["latency_us"].get<double>(), 17.25);
+	EXPECT_EQ(object["agent"], "Mozilla 5.0");
+	EXPECT_EQ(object["file"], __FILE__);
+
+	std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <string>
+#include <string_view>
+
+#include "Formatter.h"
+#include "Logger.h"
+#include "JsonFormatter.h"
+
+
+// Replace the global allocation functions to count heap allocations made by the current thread
+namespace
+{
+thread_local bool	countAllocations = false;
+thread_local size_t allocationCount	 = 0;
+
+void			   *countedAlloc(size_t size)
+{
+	if (countAllocations)
+		++allocationCount;
+
+	if (void *ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+
+class AllocationCounter
+{
+public:
+	AllocationCounter()
+	{
+		allocationCount	 = 0;
+		countAllocations = true;
+	}
+
+	~AllocationCounter() { countAllocations = false; }
+
+	size_t count() const { return allocationCount; }
+};
+
+
+// Gives the logger a file output, so the measured calls format and write their message instead of returning early
+OutputHandle fileOutput()
+{
+	static OutputHandle output = OutputHandle::Invalid;
+	if (output != OutputHandle::Invalid)
+		return output;
+
+	auto fileName = (std::filesystem::temp_directory_path() / "logger_allocations.log").string();
+	std::filesystem::remove(fileName);
+	logging::addFileOutput().setFilename(fileName).setLevel(LogLevel::Info).storeHandleIn(output);
+	return output;
+}
+
+
+uint64_t writesTo(OutputHandle handle)
+{
+	for (const auto &output : logging::stats().outputs)
+	{
+		if (output.handle == handle)
+			return output.writes;
+	}
+	return 0;
+}
+
+} // namespace
+
+
+void *operator new(size_t size)
+{
+	return countedAlloc(size);
+}
+
+void *operator new[](size_t size)
+{
+	return countedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+
+TEST(LogAllocations, LoggedCallWithoutArgumentsDoesNotAllocate)
+{
+	auto output = fileOutput();
+	ASSERT_TRUE(logging::isEnabled(LogLevel::Info));
+
+	LOG_INFO("warm up"); // First call creates the logger instance and opens the file
+	auto writesBefore = writesTo(output);
+
+	size_t allocations = 0;
+	{
+		AllocationCounter counter;
+		LOG_INFO("no arguments");
+		allocations = counter.count();
+	}
+
+	EXPECT_EQ(allocations, 0u);
+	EXPECT_EQ(writesTo(output) - writesBefore, 1u);
+}
+
+TEST(LogAllocations, CallWithKnownNonLiteralNamesDoesNotAllocate)
+{
+	auto			  output = fileOutput();
+	const std::string file("/src/service/RequestHandler.cpp"); // Longer than the small-string buffer
+	const std::string function("RequestHandler::handleIncomingRequest");
+
+	logging::log(LogLevel::Info, std::string_view(file), 10, std::string_view(function), "warm up"); // Stores the names
+	auto writesBefore = writesTo(output);
+
+	size_t allocations = 0;
+	{
+		AllocationCounter counter;
+		logging::log(LogLevel::Info, std::string_view(file), 11, std::string_view(function), "known names");
+		allocations = counter.count();
+	}
+
+	EXPECT_EQ(allocations, 0u);
+	EXPECT_EQ(writesTo(output) - writesBefore, 1u);
+}
+
+TEST(LogAllocations, FilteredCallDoesNotAllocate)
+{
+	LOG_INFO("warm up");
+
+	size_t allocations = 0;
+	{
+		AllocationCounter counter;
+		LOG_TRACE("filtered {} {}", 42, std::string_view("text"));
+		allocations = counter.count();
+	}
+
+	EXPECT_EQ(allocations, 0u);
+}
+
+TEST(LogAllocations, FormattedArgumentsDoNotAllocate)
+{
+	fileOutput();
+	LOG_INFO("warm up {}", 1); // Sizes this thread's message buffer
+
+	size_t allocations = 0;
+	{
+		AllocationCounter counter;
+		LOG_INFO("Integer : {}!", 12344);
+		allocations = counter.count();
+	}
+
+	EXPECT_EQ(allocations, 0u);
+}
+
+TEST(LogAllocations, FormatterDoesNotAllocate)
+{
+	spdlog::source_loc		 loc("/some/nested/path/MyModule.cpp", 42, "processIncomingRequest");
+	spdlog::details::log_msg msg(loc, "test_logger", spdlog::level::info, "Integer : 12344!");
+
+	Formatter				 formatter;
+	spdlog::memory_buf_t	 dest;
+	formatter.format(msg, dest); // Loads the time zone on first use
+	dest.clear();
+
+	size_t allocations = 0;
+	{
+		AllocationCounter counter;
+		formatter.format(msg, dest);
+		allocations = counter.count();
+	}
+
+	EXPECT_EQ(allocations, 0u);
+}
+
+TEST(LogAllocations, CompiledPatternDoesNotAllocate)
+{
+	spdlog::source_loc		 loc("/some/nested/path/MyModule.cpp", 42, "processIncomingRequest");
+	spdlog::details::log_msg msg(loc, "test_logger", spdlog::level::info, "Integer : 12344!");
+
+	Formatter				 formatter("[%Y-%m-%d %H:%M:%S.%f] %-5!l %10t %s:%# %v");
+	spdlog::memory_buf_t	 dest;
+	formatter.format(msg, dest);
+	dest.clear();
+
+	size_t allocations = 0;
+	{
+		AllocationCounter counter;
+		formatter.format(msg, dest);
+		allocations = counter.count();
+	}
+
+	EXPECT_EQ(allocations, 0u);
+}
+
+TEST(LogAllocations, KeyValueCallDoesNotAllocate)
+{
+	fileOutput();
+	LOG_INFO_KV("warm up", "user_id", 1, "name", "text", "latency_us", 1.5); // Sizes this thread's buffers
+
+	size_t allocations = 0;
+	{
+		AllocationCounter counter;
+		LOG_INFO_KV("request done", "user_id", 42, "name", "alice", "latency_us", 17.25);
+		allocations = counter.count();
+	}
+
+	EXPECT_EQ(allocations, 0u);
+}
+
+TEST(LogAllocations, JsonFormatterDoesNotAllocate)
+{
+	std::string fields;
+	logging::kv::encodeField(fields, "user_id", 42);
+	logging::kv::encodeField(fields, "name", "alice");
+	logging::kv::ScopedFields scope(fields);
+
+	spdlog::source_loc		  loc("/some/nested/path/MyModule.cpp", 42, "processIncomingRequest");
+	spdlog::details::log_msg  msg(loc, "test_logger", spdlog::level::info, "request \"done\"");
+
+	JsonFormatter			  formatter;
+	spdlog::memory_buf_t	  dest;
+	formatter.format(msg, dest);
+	dest.clear();
+
+	size_t allocations = 0;
+	{
+		AllocationCounter counter;
+		formatter.format(msg, dest);
+		allocations = counter.count();
+	}
+
+	EXPECT_EQ(allocations, 0u);
+}
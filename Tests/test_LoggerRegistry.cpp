@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include <spdlog/sinks/base_sink.h>
+
+#include "LoggerRegistry.h"
+#include "PrintMacros.h"
+
+
+namespace
+{
+
+class NullSink : public spdlog::sinks::base_sink<std::mutex>
+{
+protected:
+	void sink_it_(const spdlog::details::log_msg &) override {}
+	void flush_() override {}
+};
+
+
+spdlog::sink_ptr sinkWithLevel(spdlog::level::level_enum level)
+{
+	auto sink = std::make_shared<NullSink>();
+	sink->set_level(level);
+	return sink;
+}
+
+
+std::string readFile(const std::filesystem::path &path)
+{
+	std::ifstream	  file(path);
+	std::stringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+} // namespace
+
+
+TEST(LoggerRegistry, SameNameReturnsSameLogger)
+{
+	LoggerRegistry registry;
+	auto		  &db = registry.get("db");
+
+	for (int i = 0; i < 100; ++i)
+		registry.get("logger" + std::to_string(i));
+
+	EXPECT_EQ(&registry.get("db"), &db);
+	EXPECT_NE(&registry.get("net"), &db);
+}
+
+TEST(LoggerRegistry, LoggerWithoutOutputsRejectsEverything)
+{
+	LoggerRegistry registry;
+	EXPECT_EQ(registry.get("db").threshold.load(), LogLevel::Off);
+}
+
+TEST(LoggerRegistry, ThresholdFollowsOutputsAndLevel)
+{
+	LoggerRegistry registry;
+	auto		  &db	  = registry.get("db");
+	auto		   handle = db.sinks->add(sinkWithLevel(spdlog::level::debug));
+	registry.publish(db);
+	EXPECT_EQ(db.threshold.load(), LogLevel::Debug);
+
+	registry.setLevel(db, LogLevel::Warn);
+	EXPECT_EQ(db.threshold.load(), LogLevel::Warn);
+
+	db.sinks->remove(handle);
+	registry.publish(db);
+	EXPECT_EQ(db.threshold.load(), LogLevel::Off);
+}
+
+TEST(LoggerRegistry, ConfigureReplacesAllLevels)
+{
+	LoggerRegistry registry;
+	auto		  &db  = registry.get("db");
+	auto		  &net = registry.get("net");
+	db.sinks->add(sinkWithLevel(spdlog::level::trace));
+	net.sinks->add(sinkWithLevel(spdlog::level::trace));
+	registry.setLevel(db, LogLevel::Error);
+
+	registry.configure({{"net", LogLevel::Info}, {"cache", LogLevel::Warn}});
+
+	EXPECT_EQ(db.threshold.load(), LogLevel::Trace);
+	EXPECT_EQ(net.threshold.load(), LogLevel::Info);
+	EXPECT_EQ(registry.get("cache").level, LogLevel::Warn);
+}
+
+TEST(LoggerRegistry, FindsOwnerOfOutput)
+{
+	LoggerRegistry registry;
+	auto		  &db	  = registry.get("db");
+	auto		   handle = db.sinks->add(sinkWithLevel(spdlog::level::info));
+	registry.get("net").sinks->add(sinkWithLevel(spdlog::level::info));
+
+	EXPECT_EQ(registry.ownerOf(handle), &db);
+	EXPECT_EQ(registry.ownerOf(handle + 1000), nullptr);
+}
+
+TEST(LoggerRegistry, NamedLoggerWritesOnlyToItsOwnOutputs)
+{
+	auto directory = std::filesystem::temp_directory_path() / "logger_registry_named";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	auto		 dataPlane = logging::get("data_plane");
+	OutputHandle output	   = OutputHandle::Invalid;
+	logging::addFileOutput().setFilename((directory / "data.log").string()).setLevel(LogLevel::Info).setLogger(dataPlane).storeHandleIn(output);
+
+	EXPECT_TRUE(dataPlane.isEnabled(LogLevel::Info));
+	EXPECT_FALSE(dataPlane.isEnabled(LogLevel::Debug));
+
+	LOG_INFO_TO(dataPlane, "packet {}", 7);
+	LOG_INFO("default logger message");
+
+	dataPlane.setLevel(LogLevel::Error);
+	LOG_WARNING_TO(dataPlane, "filtered by the logger level");
+	dataPlane.setLevel(LogLevel::Trace);
+
+	// Removing the output closes and flushes its file
+	EXPECT_TRUE(logging::removeOutput(output));
+	EXPECT_FALSE(dataPlane.isEnabled(LogLevel::Critical));
+
+	auto content = readFile(directory / "data.log");
+	EXPECT_NE(content.find("packet 7"), std::string::npos);
+	EXPECT_EQ(content.find("default logger message"), std::string::npos);
+	EXPECT_EQ(content.find("filtered by the logger level"), std::string::npos);
+
+	std::filesystem::remove_all(directory);
+}
+
+TEST(LoggerRegistry, DefaultHandleHasNoLevelOfItsOwn)
+{
+	logging::Logger defaultLogger;
+	EXPECT_THROW(defaultLogger.setLevel(LogLevel::Info), std::logic_error);
+}
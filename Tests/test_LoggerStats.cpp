@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+#include <spdlog/sinks/base_sink.h>
+
+#include "Formatter.h"
+#include "LoggerStats.h"
+#include "PrintMacros.h"
+#include "SinkList.h"
+
+
+namespace
+{
+
+// Formats every message and keeps the number of bytes it produced
+class CountingSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+	size_t bytes = 0;
+
+protected:
+	void sink_it_(const spdlog::details::log_msg &msg) override
+	{
+		spdlog::memory_buf_t dest;
+		formatter_->format(msg, dest);
+		bytes += dest.size();
+	}
+
+	void flush_() override {}
+};
+
+
+std::shared_ptr<CountingSink> countingSink(const std::string &pattern, spdlog::level::level_enum level = spdlog::level::trace)
+{
+	auto sink = std::make_shared<CountingSink>();
+	sink->set_formatter(std::make_unique<Formatter>(pattern));
+	sink->set_level(level);
+	return sink;
+}
+
+
+const LoggerStats::Output &outputStats(const SinkList &sinks, uint64_t handle)
+{
+	for (const auto &entry : *sinks.snapshot())
+	{
+		if (entry.handle == handle)
+			return *entry.stats;
+	}
+	throw std::logic_error("No such sink");
+}
+
+
+spdlog::details::log_msg sampleMessage(spdlog::level::level_enum level = spdlog::level::info)
+{
+	return spdlog::details::log_msg(spdlog::source_loc("/path/MyModule.cpp", 42, "process"), "test_logger", level, "hello");
+}
+
+} // namespace
+
+
+TEST(LoggerStats, BucketBoundsStayWithinAnEighth)
+{
+	for (uint64_t value : {0ull, 7ull, 8ull, 9ull, 100ull, 1'000ull, 12'345ull, 1'000'000ull, 987'654'321ull})
+	{
+		uint64_t bound = LatencyHistogram::upperBoundOf(LatencyHistogram::bucketOf(value));
+		EXPECT_GE(bound, value);
+		EXPECT_LE(bound, value + value / 8);
+	}
+
+	EXPECT_EQ(LatencyHistogram::bucketOf(~0ull), LatencyHistogram::Buckets - 1);
+}
+
+TEST(LoggerStats, PercentilesOfHistogram)
+{
+	LatencyHistogram histogram;
+	for (uint64_t i = 1; i <= 1000; ++i)
+	{
+		histogram.record(i * 100);
+	}
+
+	LatencyHistogram::Counts counts{};
+	uint64_t				 max = 0;
+	histogram.addTo(counts, max);
+	auto latency = LatencyHistogram::summarize(counts, max);
+
+	EXPECT_EQ(latency.samples, 1000u);
+	EXPECT_EQ(latency.max, 100'000u);
+	EXPECT_GE(latency.p50, 50'000u);
+	EXPECT_LE(latency.p50, 50'000u + 50'000u / 8);
+	EXPECT_GE(latency.p99, 99'000u);
+	EXPECT_LE(latency.p999, latency.max);
+}
+
+TEST(LoggerStats, SinkListCountsWritesAndBytesPerSink)
+{
+	SinkList sinks;
+	auto	 verbose  = countingSink("%l %v");
+	auto	 terse	  = countingSink("%v", spdlog::level::warn);
+	auto	 verboseH = sinks.add(verbose, "verbose");
+	auto	 terseH	  = sinks.add(terse, "terse");
+
+	for (int i = 0; i < 30; ++i)
+	{
+		sinks.log(sampleMessage());
+	}
+	sinks.log(sampleMessage(spdlog::level::err));
+
+	const auto &verboseStats = outputStats(sinks, verboseH);
+	EXPECT_EQ(verboseStats.writes.load(), 31u);
+	EXPECT_EQ(verboseStats.bytes.load(), verbose->bytes);
+
+	const auto &terseStats = outputStats(sinks, terseH);
+	EXPECT_EQ(terseStats.writes.load(), 1u);
+	EXPECT_EQ(terseStats.bytes.load(), terse->bytes);
+
+	// One in every 16 writes of the thread is timed, 32 writes in all
+	LatencyHistogram::Counts counts{};
+	uint64_t				 max = 0;
+	verboseStats.writeLatency.addTo(counts, max);
+	terseStats.writeLatency.addTo(counts, max);
+	EXPECT_EQ(LatencyHistogram::summarize(counts, max).samples, 32u / LoggerStats::LatencySampleInterval);
+}
+
+TEST(LoggerStats, MessageNoSinkAcceptsIsFiltered)
+{
+	SinkList sinks;
+	sinks.add(countingSink("%v", spdlog::level::err));
+
+	auto before = logging::stats().filtered;
+	sinks.log(sampleMessage(spdlog::level::info));
+	sinks.log(sampleMessage(spdlog::level::err));
+
+	EXPECT_EQ(logging::stats().filtered - before, 1u);
+}
+
+TEST(LoggerStats, CountsOfExitedThreadsAreKept)
+{
+	auto before = logging::stats().messages[static_cast<size_t>(LogLevel::Critical)];
+
+	std::thread worker(
+		[]
+		{
+			for (int i = 0; i < 3; ++i)
+				LoggerStats::countMessage(LogLevel::Critical);
+		});
+	worker.join();
+
+	EXPECT_EQ(logging::stats().messages[static_cast<size_t>(LogLevel::Critical)] - before, 3u);
+}
+
+TEST(LoggerStats, StatsListOutputsOfNamedLoggers)
+{
+	auto directory = std::filesystem::temp_directory_path() / "logger_stats";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	auto		 logger = logging::get("stats_test");
+	auto		 file	= (directory / "stats.log").string();
+	OutputHandle output = OutputHandle::Invalid;
+	auto		 before = logging::stats();
+	logging::addFileOutput().setFilename(file).setMaxFileSize(256).setMaxFiles(1).setLogger(logger).storeHandleIn(output);
+
+	for (int i = 0; i < 10; ++i)
+	{
+		LOG_WARNING_TO(logger, "message number {} of the stats test", i);
+	}
+
+	auto stats = logging::stats();
+	EXPECT_EQ(stats.messages[static_cast<size_t>(LogLevel::Warn)] - before.messages[static_cast<size_t>(LogLevel::Warn)], 10u);
+	EXPECT_GT(stats.rotations, before.rotations);
+
+	auto entry = std::find_if(stats.outputs.begin(), stats.outputs.end(), [output](const logging::OutputStats &o) { return o.handle == output; });
+	ASSERT_NE(entry, stats.outputs.end());
+	EXPECT_EQ(entry->name, "file " + file);
+	EXPECT_EQ(entry->logger, "stats_test");
+	EXPECT_EQ(entry->writes, 10u);
+	EXPECT_GT(entry->bytes, 10u * 30u);
+
+	auto json = nlohmann::json::parse(stats.toJson());
+	EXPECT_EQ(json["messages"]["warn"].get<uint64_t>(), stats.messages[static_cast<size_t>(LogLevel::Warn)]);
+	EXPECT_EQ(json["rotations"].get<uint64_t>(), stats.rotations);
+	EXPECT_TRUE(json["outputs"].is_array());
+
+	auto text = stats.toText();
+	EXPECT_NE(text.find("\"file " + file + "\" (logger stats_test): writes=10"), std::string::npos);
+	EXPECT_NE(text.find("format_ns: samples="), std::string::npos);
+
+	EXPECT_TRUE(logging::removeOutput(output));
+	std::filesystem::remove_all(directory);
+}
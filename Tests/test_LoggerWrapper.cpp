@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
 #include "LoggerWrapper.h"
 
 
@@ -21,3 +26,24 @@ TEST(LogLevelOrdering, LevelsAreOrderedFromTraceToCritical)
 	EXPECT_LT(static_cast<int>(LogLevel::Warn), static_cast<int>(LogLevel::Error));
 	EXPECT_LT(static_cast<int>(LogLevel::Error), static_cast<int>(LogLevel::Critical));
 }
+
+TEST(LogEntryPoint, NamesFromTemporaryStringsOutliveTheCall)
+{
+	auto dumpFile = (std::filesystem::temp_directory_path() / "logger_entry_point.log").string();
+	logging::addRingBufferOutput().setCapacity(8);
+
+	// The std::string overload: file and function are temporaries gone before the ring is dumped
+	logging::log(LogLevel::Info, std::string("/src/net/Socket.cpp"), 42, std::string("connect"), std::string("connected"));
+	logging::log(LogLevel::Info, std::string("/src/net/Socket.cpp"), 43, std::string("overwrites the freed storage"), "again");
+
+	ASSERT_EQ(logging::dumpRing(dumpFile), 2u);
+
+	std::ifstream	  file(dumpFile);
+	std::stringstream contents;
+	contents << file.rdbuf();
+	EXPECT_NE(contents.str().find("Socket"), std::string::npos);
+	EXPECT_NE(contents.str().find("connect "), std::string::npos);
+	EXPECT_NE(contents.str().find("connected"), std::string::npos);
+
+	std::filesystem::remove(dumpFile);
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "Lz4Codec.h"
+
+
+namespace
+{
+
+std::string logText(size_t lines)
+{
+	std::string text;
+	for (size_t i = 0; i < lines; ++i)
+		text += "[2024-05-01 12:00:00.123456]   4711 info     Server               handle                                        request " + std::to_string(i) + " done\n";
+	return text;
+}
+
+
+std::string randomBytes(size_t size)
+{
+	std::mt19937 random(42);
+	std::string	 bytes(size, '\0');
+	for (auto &byte : bytes)
+		byte = static_cast<char>(random());
+	return bytes;
+}
+
+} // namespace
+
+
+TEST(Lz4Codec, RoundTripsLogText)
+{
+	auto text  = logText(10'000);
+	auto frame = lz4::compress(text);
+
+	EXPECT_EQ(lz4::decompress(frame), text);
+	EXPECT_LT(frame.size(), text.size() / 4);
+}
+
+TEST(Lz4Codec, RoundTripsEmptyAndShortInput)
+{
+	for (std::string text : {"", "a", "abcd", "aaaaaaaaaaaaaaaaaaaaaaa", "0123456789abc"})
+		EXPECT_EQ(lz4::decompress(lz4::compress(text)), text) << text;
+}
+
+TEST(Lz4Codec, StoresIncompressibleBlocksRaw)
+{
+	auto bytes = randomBytes(100'000);
+	auto frame = lz4::compress(bytes);
+
+	EXPECT_EQ(lz4::decompress(frame), bytes);
+	EXPECT_LE(frame.size(), bytes.size() + 16);
+}
+
+TEST(Lz4Codec, SpansSeveralBlocks)
+{
+	auto text = logText(60'000); // More than one 4 MB block
+	ASSERT_GT(text.size(), 4u * 1024 * 1024);
+
+	EXPECT_EQ(lz4::decompress(lz4::compress(text)), text);
+}
+
+TEST(Lz4Codec, WritesStandardFrameHeader)
+{
+	auto frame = lz4::compress("hello");
+
+	// Magic number, then version 01 with independent blocks, 4 MB blocks and the xxHash32 header checksum
+	EXPECT_EQ(frame.substr(0, 7), std::string("\x04\x22\x4D\x18\x60\x70\x73", 7));
+}
+
+TEST(Lz4Codec, ReadsFramesWithChecksumsFromTheReferenceEncoder)
+{
+	// Header as written by `lz4` with its defaults (content checksum, 4 MB blocks), one raw block, end mark, checksum
+	std::string frame("\x04\x22\x4D\x18\x64\x70\xB9", 7);
+	frame += std::string("\x05\x00\x00\x80", 4) + "hello";
+	frame += std::string("\x00\x00\x00\x00", 4) + std::string("\x01\x02\x03\x04", 4);
+
+	EXPECT_EQ(lz4::decompress(frame), "hello");
+}
+
+TEST(Lz4Codec, RejectsMalformedFrames)
+{
+	auto frame = lz4::compress(logText(100));
+
+	EXPECT_THROW(lz4::decompress("not a frame"), std::runtime_error);
+	EXPECT_THROW(lz4::decompress(frame.substr(0, frame.size() / 2)), std::runtime_error);
+
+	auto badChecksum = frame;
+	badChecksum[6] ^= 0x01;
+	EXPECT_THROW(lz4::decompress(badChecksum), std::runtime_error);
+}
+
+TEST(Lz4Codec, CompressesFiles)
+{
+	auto directory = std::filesystem::temp_directory_path() / "logger_lz4_files";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	auto source = (directory / "app.log").string();
+	auto target = (directory / "app.log.lz4").string();
+	auto copy	= (directory / "copy.log").string();
+	auto text	= logText(1'000);
+
+	{
+		std::ofstream file(source, std::ios::binary);
+		file << text;
+	}
+
+	lz4::compressFile(source, target);
+	lz4::decompressFile(target, copy);
+
+	std::ifstream	  file(copy, std::ios::binary);
+	std::stringstream content;
+	content << file.rdbuf();
+	EXPECT_EQ(content.str(), text);
+	EXPECT_LT(std::filesystem::file_size(target), text.size() / 4);
+
+	EXPECT_THROW(lz4::compressFile((directory / "missing.log").string(), target), std::runtime_error);
+
+	std::filesystem::remove_all(directory);
+}
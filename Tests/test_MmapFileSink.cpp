@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include "MmapFileSink.h"
+
+
+#ifndef _WIN32
+
+namespace
+{
+
+class MmapFileSinkTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		directory = std::filesystem::temp_directory_path() / (std::string("logger_mmap_") + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory);
+		fileName = (directory / "app.log").string();
+	}
+
+	void		TearDown() override { std::filesystem::remove_all(directory); }
+
+	std::string rotatedName(size_t index) const { return spdlog::sinks::rotating_file_sink_mt::calc_filename(fileName, index); }
+
+	static void log(MmapFileSink &sink, const std::string &payload)
+	{
+		spdlog::details::log_msg msg(spdlog::source_loc{}, "test_logger", spdlog::level::info, payload);
+		sink.log(msg);
+	}
+
+	static std::string read(const std::string &path)
+	{
+		std::ifstream	  file(path, std::ios::binary);
+		std::stringstream content;
+		content << file.rdbuf();
+		return content.str();
+	}
+
+	// All lines written, oldest file first
+	std::string readAll(size_t maxFiles) const
+	{
+		std::string content;
+		for (size_t i = maxFiles; i > 0; --i)
+			content += read(rotatedName(i));
+		return content + read(fileName);
+	}
+
+	std::filesystem::path directory;
+	std::string			  fileName;
+};
+
+
+// Payload-only formatter that counts its live instances, the sink's own and the threads' copies
+class CountingFormatter : public spdlog::formatter
+{
+public:
+	static inline std::atomic<int> live{0};
+
+	CountingFormatter() { ++live; }
+	~CountingFormatter() override { --live; }
+
+	void format(const spdlog::details::log_msg &msg, spdlog::memory_buf_t &dest) override
+	{
+		dest.append(msg.payload.data(), msg.payload.data() + msg.payload.size());
+		dest.push_back('\n');
+	}
+
+	std::unique_ptr<spdlog::formatter> clone() const override { return std::make_unique<CountingFormatter>(); }
+};
+
+} // namespace
+
+
+TEST_F(MmapFileSinkTest, TrimsFileToWrittenLinesOnClose)
+{
+	{
+		MmapFileSink sink(fileName, 4096, 3);
+		sink.set_pattern("%v");
+		log(sink, "first");
+		log(sink, "second");
+	}
+
+	EXPECT_EQ(read(fileName), "first\nsecond\n");
+}
+
+TEST_F(MmapFileSinkTest, LinesAreInTheFileBeforeClose)
+{
+	MmapFileSink sink(fileName, 4096, 3);
+	sink.set_pattern("%v");
+	log(sink, "visible without flush");
+
+	// The file is still at its preallocated size, the line sits in the shared mapping
+	auto content = read(fileName);
+	EXPECT_EQ(content.size(), 4096u);
+	EXPECT_EQ(content.substr(0, 22), "visible without flush\n");
+}
+
+TEST_F(MmapFileSinkTest, RollsOverToRotatedSegments)
+{
+	{
+		MmapFileSink sink(fileName, 16, 10);
+		sink.set_pattern("%v");
+		for (int i = 0; i < 10; ++i)
+			log(sink, "line " + std::to_string(i)); // 7 bytes each, two per segment
+	}
+
+	EXPECT_EQ(read(rotatedName(1)), "line 6\nline 7\n");
+	EXPECT_EQ(read(fileName), "line 8\nline 9\n");
+	EXPECT_EQ(readAll(10), "line 0\nline 1\nline 2\nline 3\nline 4\nline 5\nline 6\nline 7\nline 8\nline 9\n");
+}
+
+TEST_F(MmapFileSinkTest, GrowsSegmentForLinesLongerThanMaxFileSize)
+{
+	std::string longLine(100, 'x');
+	{
+		MmapFileSink sink(fileName, 16, 3);
+		sink.set_pattern("%v");
+		log(sink, "short");
+		log(sink, longLine);
+	}
+
+	EXPECT_EQ(readAll(3), "short\n" + longLine + "\n");
+}
+
+TEST_F(MmapFileSinkTest, RotatesExistingFileOnStartup)
+{
+	std::ofstream(fileName) << "previous run\n";
+	{
+		MmapFileSink sink(fileName, 4096, 3);
+		sink.set_pattern("%v");
+		log(sink, "this run");
+	}
+
+	EXPECT_EQ(read(rotatedName(1)), "previous run\n");
+	EXPECT_EQ(read(fileName), "this run\n");
+}
+
+TEST_F(MmapFileSinkTest, KeepsEveryLineFromConcurrentWriters)
+{
+	constexpr int threads		 = 4;
+	constexpr int linesPerThread = 2000;
+
+	{
+		MmapFileSink sink(fileName, 4096, 100);
+		sink.set_pattern("%v");
+
+		std::vector<std::thread> writers;
+		for (int t = 0; t < threads; ++t)
+		{
+			writers.emplace_back(
+				[&sink, t]
+				{
+					for (int i = 0; i < linesPerThread; ++i)
+						log(sink, "thread " + std::to_string(t) + " line " + std::to_string(i));
+				});
+		}
+		for (auto &writer : writers)
+			writer.join();
+	}
+
+	std::vector<std::string> lines;
+	std::istringstream		 content(readAll(100));
+	for (std::string line; std::getline(content, line);)
+		lines.push_back(line);
+
+	ASSERT_EQ(lines.size(), static_cast<size_t>(threads * linesPerThread));
+
+	std::vector<std::string> expected;
+	for (int t = 0; t < threads; ++t)
+		for (int i = 0; i < linesPerThread; ++i)
+			expected.push_back("thread " + std::to_string(t) + " line " + std::to_string(i));
+
+	std::sort(lines.begin(), lines.end());
+	std::sort(expected.begin(), expected.end());
+	EXPECT_EQ(lines, expected);
+}
+
+TEST_F(MmapFileSinkTest, ThreadCopyOfFormatterIsReleasedWhenThreadExits)
+{
+	MmapFileSink sink(fileName, 4096, 3);
+	sink.set_formatter(std::make_unique<CountingFormatter>());
+
+	std::thread writer([&sink] { log(sink, "from a short-lived thread"); });
+	writer.join();
+
+	EXPECT_EQ(CountingFormatter::live.load(), 1); // Only the sink's own
+}
+
+TEST_F(MmapFileSinkTest, FormatterCopiesAreReleasedWithTheSink)
+{
+	{
+		MmapFileSink sink(fileName, 4096, 3);
+		sink.set_formatter(std::make_unique<CountingFormatter>());
+		log(sink, "from the test thread, which outlives the sink");
+		EXPECT_EQ(CountingFormatter::live.load(), 2);
+	}
+
+	EXPECT_EQ(CountingFormatter::live.load(), 0);
+	EXPECT_EQ(read(fileName), "from the test thread, which outlives the sink\n");
+}
+
+#endif
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include "PrintMacros.h"
+
+
+namespace
+{
+
+class PrintMacrosTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		savedLevel		   = logging::minimumLevel.load();
+		savedCategoryLevel = logging::defaultCategoryLevel.load();
+	}
+
+	void TearDown() override
+	{
+		logging::minimumLevel.store(savedLevel);
+		logging::setDefaultCategoryLevel(savedCategoryLevel);
+	}
+
+	LogLevel savedLevel			= LogLevel::Info;
+	LogLevel savedCategoryLevel = LogLevel::Trace;
+};
+
+
+int countEvaluation(int &counter)
+{
+	return ++counter;
+}
+
+} // namespace
+
+
+TEST_F(PrintMacrosTest, IsEnabledComparesAgainstMinimumLevel)
+{
+	logging::minimumLevel.store(LogLevel::Warn);
+
+	EXPECT_FALSE(logging::isEnabled(LogLevel::Trace));
+	EXPECT_FALSE(logging::isEnabled(LogLevel::Info));
+	EXPECT_TRUE(logging::isEnabled(LogLevel::Warn));
+	EXPECT_TRUE(logging::isEnabled(LogLevel::Critical));
+}
+
+TEST_F(PrintMacrosTest, FilteredCallDoesNotEvaluateArguments)
+{
+	logging::minimumLevel.store(LogLevel::Error);
+
+	int evaluations = 0;
+	LOG_INFO("value {}", countEvaluation(evaluations));
+	LOG_WARNING("value {}", countEvaluation(evaluations));
+
+	EXPECT_EQ(evaluations, 0);
+}
+
+TEST_F(PrintMacrosTest, EnabledCallEvaluatesArguments)
+{
+	logging::minimumLevel.store(LogLevel::Trace);
+
+	int evaluations = 0;
+	LOG_ERROR("value {}", countEvaluation(evaluations));
+
+	EXPECT_EQ(evaluations, 1);
+}
+
+TEST_F(PrintMacrosTest, MacrosCanBeUsedAsSingleStatements)
+{
+	logging::minimumLevel.store(LogLevel::Critical);
+
+	int evaluations = 0;
+	if (evaluations == 0)
+		LOG_INFO("value {}", countEvaluation(evaluations));
+	else
+		LOG_ERROR("value {}", countEvaluation(evaluations));
+
+	EXPECT_EQ(evaluations, 0);
+}
+
+TEST_F(PrintMacrosTest, CategoryLevelFiltersBeforeArgumentEvaluation)
+{
+	logging::setCategoryLevel("test.macros", LogLevel::Error);
+
+	int evaluations = 0;
+	LOG_WARNING_CAT("test.macros", "value {}", countEvaluation(evaluations));
+	EXPECT_EQ(evaluations, 0);
+
+	LOG_ERROR_CAT("test.macros", "value {}", countEvaluation(evaluations));
+	EXPECT_EQ(evaluations, 1);
+}
+
+TEST_F(PrintMacrosTest, CategoryLevelChangeReachesResolvedCallSite)
+{
+	int	 evaluations = 0;
+	auto logWarning	 = [&] { LOG_WARNING_CAT("test.change", "value {}", countEvaluation(evaluations)); };
+
+	logging::setCategoryLevel("test.change", LogLevel::Critical);
+	logWarning();
+	EXPECT_EQ(evaluations, 0);
+
+	logging::setCategoryLevel("test.change", LogLevel::Warn);
+	logWarning();
+	EXPECT_EQ(evaluations, 1);
+}
+
+TEST_F(PrintMacrosTest, UncategorizedCallFollowsDefaultCategoryLevel)
+{
+	logging::minimumLevel.store(LogLevel::Trace); // An output accepts everything, as when one category is traced
+	logging::setDefaultCategoryLevel(LogLevel::Warn);
+	logging::setCategoryLevel("test.traced", LogLevel::Info);
+
+	int evaluations = 0;
+	LOG_INFO("value {}", countEvaluation(evaluations));
+	EXPECT_EQ(evaluations, 0);
+
+	LOG_INFO_CAT("test.traced", "value {}", countEvaluation(evaluations));
+	EXPECT_EQ(evaluations, 1);
+
+	LOG_WARNING("value {}", countEvaluation(evaluations));
+	EXPECT_EQ(evaluations, 2);
+}
+
+TEST(FormatMessage, FormatsArguments)
+{
+	EXPECT_EQ(logging::formatMessage("Integer : {}!", 12344), "Integer : 12344!");
+	EXPECT_EQ(logging::formatMessage("no arguments {{}}"), "no arguments {}");
+}
+
+TEST(FormatMessage, GrowsForMessagesLargerThanTheBuffer)
+{
+	std::string longText(4096, 'x');
+	auto		message = logging::formatMessage("[{}]", longText);
+
+	ASSERT_EQ(message.size(), longText.size() + 2);
+	EXPECT_EQ(message.front(), '[');
+	EXPECT_EQ(message.back(), ']');
+	EXPECT_EQ(logging::formatMessage("short {}", 1), "short 1");
+}
+
+TEST_F(PrintMacrosTest, EveryNLogsFirstAndEveryNthCall)
+{
+	logging::minimumLevel.store(LogLevel::Trace);
+
+	int evaluations = 0;
+	for (int i = 0; i < 10; ++i)
+		LOG_INFO_EVERY_N(3, "value {}", countEvaluation(evaluations));
+
+	EXPECT_EQ(evaluations, 4); // Calls 1, 4, 7 and 10
+}
+
+TEST_F(PrintMacrosTest, EveryNKeepsSeparateCountersPerCallSite)
+{
+	logging::minimumLevel.store(LogLevel::Trace);
+
+	int first  = 0;
+	int second = 0;
+	for (int i = 0; i < 4; ++i)
+	{
+		LOG_WARNING_EVERY_N(4, "first {}", countEvaluation(first));
+		LOG_WARNING_EVERY_N(2, "second {}", countEvaluation(second));
+	}
+
+	EXPECT_EQ(first, 1);
+	EXPECT_EQ(second, 2);
+}
+
+TEST_F(PrintMacrosTest, EveryMsLogsOncePerInterval)
+{
+	logging::minimumLevel.store(LogLevel::Trace);
+
+	int evaluations = 0;
+	for (int i = 0; i < 5; ++i)
+		LOG_WARNING_EVERY_MS(60000, "value {}", countEvaluation(evaluations));
+
+	EXPECT_EQ(evaluations, 1);
+}
+
+TEST_F(PrintMacrosTest, SampledHonorsProbabilityBounds)
+{
+	logging::minimumLevel.store(LogLevel::Trace);
+
+	int never  = 0;
+	int always = 0;
+	for (int i = 0; i < 100; ++i)
+	{
+		LOG_ERROR_SAMPLED(0.0, "never {}", countEvaluation(never));
+		LOG_ERROR_SAMPLED(1.0, "always {}", countEvaluation(always));
+	}
+
+	EXPECT_EQ(never, 0);
+	EXPECT_EQ(always, 100);
+}
+
+TEST_F(PrintMacrosTest, RateLimitedCallsStillRespectLevel)
+{
+	logging::minimumLevel.store(LogLevel::Error);
+
+	int evaluations = 0;
+	LOG_INFO_EVERY_N(1, "value {}", countEvaluation(evaluations));
+	LOG_INFO_SAMPLED(1.0, "value {}", countEvaluation(evaluations));
+
+	EXPECT_EQ(evaluations, 0);
+}
+
+TEST(RateLimit, SampledApproximatesProbability)
+{
+	int hits = 0;
+	for (int i = 0; i < 100000; ++i)
+		hits += logging::sampled(0.25) ? 1 : 0;
+
+	EXPECT_NEAR(hits / 100000.0, 0.25, 0.02);
+}
@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RingBufferSink.h"
+
+
+namespace
+{
+
+class RingBufferSinkTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		directory = std::filesystem::temp_directory_path() / (std::string("logger_ring_") + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory);
+		fileName = (directory / "ring.log").string();
+	}
+
+	void	   TearDown() override { std::filesystem::remove_all(directory); }
+
+	static void log(RingBufferSink &sink, const std::string &payload, spdlog::level::level_enum level = spdlog::level::trace,
+					spdlog::source_loc loc = {"/src/net/Socket.cpp", 42, "connect"})
+	{
+		spdlog::details::log_msg msg(loc, "test_logger", level, payload);
+		sink.log(msg);
+	}
+
+	static std::vector<std::string> readLines(const std::string &path)
+	{
+		std::ifstream			 file(path, std::ios::binary);
+		std::vector<std::string> lines;
+		for (std::string line; std::getline(file, line);)
+			lines.push_back(line);
+		return lines;
+	}
+
+	// Message column of a dumped line
+	static std::string messageOf(const std::string &line)
+	{
+		// time (27) thread (8) level (8) file (20) function (45), each followed by a space
+		constexpr size_t MessageColumn = 27 + 1 + 8 + 1 + 8 + 1 + 20 + 1 + 45 + 1;
+		return line.size() > MessageColumn ? line.substr(MessageColumn) : std::string();
+	}
+
+	std::filesystem::path directory;
+	std::string			  fileName;
+};
+
+} // namespace
+
+
+TEST_F(RingBufferSinkTest, KeepsTheLastRecordsOldestFirst)
+{
+	RingBufferSink sink(4);
+
+	for (int i = 0; i < 10; ++i)
+		log(sink, "message " + std::to_string(i));
+
+	EXPECT_EQ(sink.dump(fileName), 4u);
+
+	auto lines = readLines(fileName);
+	ASSERT_EQ(lines.size(), 4u);
+	for (size_t i = 0; i < lines.size(); ++i)
+		EXPECT_EQ(messageOf(lines[i]), "message " + std::to_string(6 + i));
+}
+
+
+TEST_F(RingBufferSinkTest, CapacityRoundsUpToPowerOfTwo)
+{
+	EXPECT_EQ(RingBufferSink(1000).capacity(), 1024u);
+	EXPECT_EQ(RingBufferSink(4096).capacity(), 4096u);
+	EXPECT_THROW(RingBufferSink(0), std::invalid_argument);
+}
+
+
+TEST_F(RingBufferSinkTest, EmptyRingDumpsNothing)
+{
+	RingBufferSink sink(8);
+
+	EXPECT_EQ(sink.dump(fileName), 0u);
+	EXPECT_TRUE(std::filesystem::exists(fileName));
+	EXPECT_EQ(std::filesystem::file_size(fileName), 0u);
+}
+
+
+TEST_F(RingBufferSinkTest, DumpedLineHasTheFormatterColumns)
+{
+	RingBufferSink sink(8);
+	log(sink, "connected", spdlog::level::debug);
+
+	sink.dump(fileName);
+	auto lines = readLines(fileName);
+	ASSERT_EQ(lines.size(), 1u);
+
+	std::regex layout(R"(\d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2}\.\d{6}Z +\d+ debug +Socket +connect +connected)");
+	EXPECT_TRUE(std::regex_match(lines[0], layout)) << lines[0];
+}
+
+
+TEST_F(RingBufferSinkTest, CutsLongMessages)
+{
+	RingBufferSink sink(8);
+	log(sink, std::string(1000, 'x'));
+
+	sink.dump(fileName);
+	auto lines = readLines(fileName);
+	ASSERT_EQ(lines.size(), 1u);
+	EXPECT_EQ(messageOf(lines[0]), std::string(RingBufferSink::MaxMessageLength, 'x'));
+}
+
+
+TEST_F(RingBufferSinkTest, RespectsSinkLevel)
+{
+	RingBufferSink sink(8);
+	sink.set_level(spdlog::level::info);
+
+	log(sink, "dropped", spdlog::level::debug);
+	log(sink, "kept", spdlog::level::info);
+
+	EXPECT_EQ(sink.dump(fileName), 1u);
+	EXPECT_EQ(messageOf(readLines(fileName)[0]), "kept");
+}
+
+
+TEST_F(RingBufferSinkTest, DumpWhileLoggingOnlyWritesCompleteRecords)
+{
+	RingBufferSink			 sink(64);
+	std::atomic<bool>		 stop{false};
+	std::atomic<int>		 written{0};
+	std::vector<std::thread> writers;
+
+	for (int t = 0; t < 4; ++t)
+	{
+		writers.emplace_back(
+			[&, t]
+			{
+				for (int i = 0; !stop.load(); ++i)
+				{
+					auto text = "writer " + std::to_string(t) + " record " + std::to_string(i) + " ";
+					log(sink, text + std::string(static_cast<size_t>(i % 100), static_cast<char>('a' + t)));
+					written.fetch_add(1);
+					if (i % 64 == 0)
+						std::this_thread::yield();
+				}
+			});
+	}
+
+	std::regex record(R"(writer (\d) record (\d+) ([a-d]*))");
+	for (int round = 0; round < 20; ++round)
+	{
+		// Let the writers lap the ring between dumps
+		for (int target = written.load() + 1000; written.load() < target;)
+			std::this_thread::yield();
+
+		EXPECT_GT(sink.dump(fileName), 0u);
+		for (const auto &line : readLines(fileName))
+		{
+			std::smatch match;
+			auto		message = messageOf(line);
+			ASSERT_TRUE(std::regex_match(message, match, record)) << line;
+
+			// The filler length and character are derived from the writer and index, so a torn slot shows
+			int writer = std::stoi(match[1]);
+			int index  = std::stoi(match[2]);
+			EXPECT_EQ(match[3].str(), std::string(static_cast<size_t>(index % 100), static_cast<char>('a' + writer)));
+		}
+	}
+
+	stop = true;
+	for (auto &writer : writers)
+		writer.join();
+}
+
+
+#ifndef _WIN32
+
+TEST_F(RingBufferSinkTest, CrashDumpWritesRingOnAbort)
+{
+	auto dumpFile = fileName;
+
+	EXPECT_EXIT(
+		{
+			auto sink = std::make_shared<RingBufferSink>(8);
+			log(*sink, "before the crash");
+			RingBufferSink::armCrashDump(sink, dumpFile);
+			std::abort();
+		},
+		::testing::KilledBySignal(SIGABRT), "");
+
+	auto lines = readLines(fileName);
+	ASSERT_EQ(lines.size(), 1u);
+	EXPECT_EQ(messageOf(lines[0]), "before the crash");
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <spdlog/logger.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include "DuplicateFilterSink.h"
+#include "Formatter.h"
+#include "SharedRendering.h"
+#include "SinkList.h"
+
+
+namespace
+{
+
+// Keeps each formatted line with the color range the formatter reported for it
+class CapturingSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+	std::vector<std::string> lines;
+	std::vector<std::string> colored;
+
+protected:
+	void sink_it_(const spdlog::details::log_msg &msg) override
+	{
+		spdlog::memory_buf_t dest;
+		dest.append(std::string_view("> ")); // Renderings are appended wherever the sink's buffer ends
+		formatter_->format(msg, dest);
+
+		lines.emplace_back(dest.data(), dest.size());
+		colored.emplace_back(msg.color_range_end > msg.color_range_start ? lines.back().substr(msg.color_range_start, msg.color_range_end - msg.color_range_start) : "");
+	}
+
+	void flush_() override {}
+};
+
+
+std::shared_ptr<CapturingSink> addSink(SinkList &sinks, const std::string &pattern)
+{
+	auto sink = std::make_shared<CapturingSink>();
+	sink->set_formatter(std::make_unique<Formatter>(pattern));
+	sinks.add(sink);
+	return sink;
+}
+
+
+spdlog::details::log_msg sampleMessage(const char *payload = "hello")
+{
+	return spdlog::details::log_msg(spdlog::source_loc("/path/MyModule.cpp", 42, "process"), "test_logger", spdlog::level::warn, payload);
+}
+
+} // namespace
+
+
+TEST(SharedRendering, SinksWithTheSameLayoutWriteTheSameLine)
+{
+	auto sinks	= std::make_shared<SinkList>();
+	auto first	= addSink(*sinks, "%l %s:%# %v");
+	auto second = addSink(*sinks, "%l %s:%# %v");
+	auto other	= addSink(*sinks, "%L %v");
+
+	spdlog::logger logger("test_logger", sinks);
+	logger.log(spdlog::source_loc("/path/MyModule.cpp", 42, "process"), spdlog::level::warn, "one");
+	logger.log(spdlog::source_loc("/path/MyModule.cpp", 43, "process"), spdlog::level::info, "two");
+
+	EXPECT_EQ(first->lines, (std::vector<std::string>{"> warning MyModule:42 one\n", "> info MyModule:43 two\n"}));
+	EXPECT_EQ(second->lines, first->lines);
+	EXPECT_EQ(other->lines, (std::vector<std::string>{"> W one\n", "> I two\n"}));
+}
+
+TEST(SharedRendering, CopyKeepsTheColorRange)
+{
+	auto sinks	 = std::make_shared<SinkList>();
+	auto first	 = addSink(*sinks, "[%^%l%$] %v");
+	auto plain	 = addSink(*sinks, "%l %v");
+	auto second	 = addSink(*sinks, "[%^%l%$] %v");
+
+	spdlog::logger logger("test_logger", sinks);
+	logger.warn("colored");
+
+	EXPECT_EQ(second->lines, (std::vector<std::string>{"> [warning] colored\n"}));
+	EXPECT_EQ(first->colored, (std::vector<std::string>{"warning"}));
+	EXPECT_EQ(plain->colored, (std::vector<std::string>{""}));
+	EXPECT_EQ(second->colored, (std::vector<std::string>{"warning"}));
+}
+
+TEST(SharedRendering, OnlyTheScopedMessageIsShared)
+{
+	auto					 msg	= sampleMessage();
+	auto					 notice = sampleMessage("Skipped 3 duplicate messages");
+	uint32_t				 layout = SharedRendering::layoutId("%v");
+	spdlog::memory_buf_t	 dest;
+
+	SharedRendering::Scope	 scope(msg);
+	dest.append(std::string_view("hello\n"));
+	SharedRendering::keep(msg, layout, dest, 0);
+
+	dest.clear();
+	EXPECT_FALSE(SharedRendering::copyTo(notice, layout, dest));
+	EXPECT_FALSE(SharedRendering::copyTo(msg, SharedRendering::layoutId("%l"), dest));
+	EXPECT_TRUE(SharedRendering::copyTo(msg, layout, dest));
+	EXPECT_EQ(std::string(dest.data(), dest.size()), "hello\n");
+}
+
+TEST(SharedRendering, NothingIsSharedOutsideAScope)
+{
+	auto				 msg	= sampleMessage();
+	uint32_t			 layout = SharedRendering::layoutId("%v");
+	spdlog::memory_buf_t dest;
+
+	{
+		SharedRendering::Scope scope(msg);
+		dest.append(std::string_view("hello\n"));
+		SharedRendering::keep(msg, layout, dest, 0);
+	}
+
+	EXPECT_FALSE(SharedRendering::copyTo(msg, layout, dest));
+}
+
+TEST(SharedRendering, DuplicateNoticeIsNotReplacedByTheMessage)
+{
+	auto sinks	= std::make_shared<SinkList>();
+	auto direct = addSink(*sinks, "%v");
+
+	auto filtered = std::make_shared<CapturingSink>();
+	filtered->set_formatter(std::make_unique<Formatter>("%v"));
+	auto filter = std::make_shared<DuplicateFilterSink>(std::chrono::seconds(10));
+	filter->add_sink(filtered);
+	sinks->add(filter);
+
+	spdlog::logger logger("test_logger", sinks);
+	logger.info("same");
+	logger.info("same");
+	logger.info("different");
+
+	EXPECT_EQ(direct->lines, (std::vector<std::string>{"> same\n", "> same\n", "> different\n"}));
+	EXPECT_EQ(filtered->lines, (std::vector<std::string>{"> same\n", "> Skipped 1 duplicate messages\n", "> different\n"}));
+}
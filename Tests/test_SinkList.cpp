@@ -0,0 +1,286 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/logger.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include "SinkList.h"
+
+
+namespace
+{
+
+class CountingSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+	std::atomic<size_t>		 count{0};
+	std::atomic<size_t>		 flushes{0};
+	std::vector<std::string> payloads;
+
+protected:
+	void sink_it_(const spdlog::details::log_msg &msg) override
+	{
+		payloads.emplace_back(msg.payload.data(), msg.payload.size());
+		count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void flush_() override { flushes.fetch_add(1, std::memory_order_relaxed); }
+};
+
+
+class ThrowingSink : public spdlog::sinks::base_sink<std::mutex>
+{
+protected:
+	void sink_it_(const spdlog::details::log_msg &) override { throw std::runtime_error("sink failure"); }
+	void flush_() override {}
+};
+
+
+// Blocks in log() until released, to keep a message in flight
+class GatedSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+	std::atomic<bool> entered{false};
+
+	void			  release()
+	{
+		{
+			std::lock_guard<std::mutex> lock(gateMutex);
+			open = true;
+		}
+		gate.notify_all();
+	}
+
+protected:
+	void sink_it_(const spdlog::details::log_msg &) override
+	{
+		entered = true;
+		std::unique_lock<std::mutex> lock(gateMutex);
+		gate.wait(lock, [this] { return open; });
+	}
+
+	void flush_() override {}
+
+private:
+	std::mutex				gateMutex;
+	std::condition_variable gate;
+	bool					open = false;
+};
+
+
+void log(spdlog::logger &logger, const std::string &payload, spdlog::level::level_enum level = spdlog::level::info)
+{
+	logger.log(level, payload);
+}
+
+} // namespace
+
+
+TEST(SinkList, HandlesAreUniqueAndNonZero)
+{
+	SinkList sinks;
+	auto	 first	= sinks.add(std::make_shared<CountingSink>());
+	auto	 second = sinks.add(std::make_shared<CountingSink>());
+
+	EXPECT_NE(first, 0u);
+	EXPECT_NE(second, 0u);
+	EXPECT_NE(first, second);
+	EXPECT_EQ(sinks.snapshot()->size(), 2u);
+}
+
+TEST(SinkList, ForwardsToSinksAcceptingTheLevel)
+{
+	auto sinks = std::make_shared<SinkList>();
+	auto info  = std::make_shared<CountingSink>();
+	auto error = std::make_shared<CountingSink>();
+	error->set_level(spdlog::level::err);
+	sinks->add(info);
+	sinks->add(error);
+
+	spdlog::logger logger("test_logger", sinks);
+	log(logger, "info");
+	log(logger, "error", spdlog::level::err);
+
+	EXPECT_EQ(info->payloads, (std::vector<std::string>{"info", "error"}));
+	EXPECT_EQ(error->payloads, (std::vector<std::string>{"error"}));
+}
+
+TEST(SinkList, RemovedSinkGetsNoMoreMessages)
+{
+	auto sinks	= std::make_shared<SinkList>();
+	auto kept	= std::make_shared<CountingSink>();
+	auto gone	= std::make_shared<CountingSink>();
+	sinks->add(kept);
+	auto handle = sinks->add(gone);
+
+	spdlog::logger logger("test_logger", sinks);
+	log(logger, "before");
+	EXPECT_TRUE(sinks->remove(handle));
+	log(logger, "after");
+
+	EXPECT_EQ(kept->payloads, (std::vector<std::string>{"before", "after"}));
+	EXPECT_EQ(gone->payloads, (std::vector<std::string>{"before"}));
+}
+
+TEST(SinkList, RemoveUnknownHandleFails)
+{
+	SinkList sinks;
+	auto	 handle = sinks.add(std::make_shared<CountingSink>());
+
+	EXPECT_FALSE(sinks.remove(handle + 1));
+	EXPECT_TRUE(sinks.remove(handle));
+	EXPECT_FALSE(sinks.remove(handle));
+}
+
+TEST(SinkList, SnapshotKeepsRemovedSinkAlive)
+{
+	SinkList					sinks;
+	auto						sink   = std::make_shared<CountingSink>();
+	std::weak_ptr<CountingSink> watch  = sink;
+	auto						handle = sinks.add(std::move(sink));
+
+	auto						inFlight = sinks.snapshot();
+	sinks.remove(handle);
+	EXPECT_FALSE(watch.expired());
+
+	inFlight.reset();
+	EXPECT_TRUE(watch.expired());
+}
+
+TEST(SinkList, RemovedSinkIsDestroyedOnceRemoveReturns)
+{
+	auto						sinks  = std::make_shared<SinkList>();
+	auto						sink   = std::make_shared<CountingSink>();
+	std::weak_ptr<CountingSink> watch  = sink;
+	auto						handle = sinks->add(std::move(sink));
+
+	spdlog::logger				logger("test_logger", sinks);
+	std::thread([&] { log(logger, "message"); }).join();
+	log(logger, "message");
+
+	// Neither the logging threads nor this one keep the snapshot they read
+	EXPECT_TRUE(sinks->remove(handle));
+	EXPECT_TRUE(watch.expired());
+}
+
+TEST(SinkList, RemoveWaitsForMessagesInFlight)
+{
+	auto					 sinks	= std::make_shared<SinkList>();
+	auto					 gated	= std::make_shared<GatedSink>();
+	std::weak_ptr<GatedSink> watch	= gated;
+	auto					 handle = sinks->add(gated);
+
+	spdlog::logger			 logger("test_logger", sinks);
+	std::thread				 writer([&] { log(logger, "in flight"); });
+	while (!gated->entered)
+		std::this_thread::yield();
+
+	std::atomic<bool> removed{false};
+	std::thread		  remover(
+		  [&]
+		  {
+			  sinks->remove(handle);
+			  removed = true;
+		  });
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_FALSE(removed.load());
+
+	gated->release();
+	gated.reset();
+	writer.join();
+	remover.join();
+	EXPECT_TRUE(removed.load());
+	EXPECT_TRUE(watch.expired());
+}
+
+TEST(SinkList, LowestLevelFollowsRegisteredSinks)
+{
+	SinkList sinks;
+	EXPECT_EQ(sinks.lowestLevel(), spdlog::level::off);
+
+	auto warn = std::make_shared<CountingSink>();
+	warn->set_level(spdlog::level::warn);
+	sinks.add(warn);
+	auto debug = std::make_shared<CountingSink>();
+	debug->set_level(spdlog::level::debug);
+	auto handle = sinks.add(debug);
+	EXPECT_EQ(sinks.lowestLevel(), spdlog::level::debug);
+
+	sinks.remove(handle);
+	EXPECT_EQ(sinks.lowestLevel(), spdlog::level::warn);
+}
+
+TEST(SinkList, FailingSinkDoesNotStopOthers)
+{
+	auto sinks = std::make_shared<SinkList>();
+	auto good  = std::make_shared<CountingSink>();
+	sinks->add(std::make_shared<ThrowingSink>());
+	sinks->add(good);
+
+	spdlog::logger logger("test_logger", sinks);
+	log(logger, "message");
+
+	EXPECT_EQ(good->payloads, (std::vector<std::string>{"message"}));
+}
+
+TEST(SinkList, FlushReachesEverySink)
+{
+	SinkList sinks;
+	auto	 first	= std::make_shared<CountingSink>();
+	auto	 second = std::make_shared<CountingSink>();
+	sinks.add(first);
+	sinks.add(second);
+
+	sinks.flush();
+
+	EXPECT_EQ(first->flushes.load(), 1u);
+	EXPECT_EQ(second->flushes.load(), 1u);
+}
+
+TEST(SinkList, SinksChangeWhileThreadsLog)
+{
+	auto			  sinks	 = std::make_shared<SinkList>();
+	auto			  stable = std::make_shared<CountingSink>();
+	sinks->add(stable);
+
+	spdlog::logger	  logger("test_logger", sinks);
+	std::atomic<bool> stop{false};
+	std::atomic<size_t> logged{0};
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t)
+	{
+		threads.emplace_back(
+			[&]
+			{
+				while (!stop.load(std::memory_order_relaxed))
+				{
+					log(logger, "message");
+					logged.fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+	}
+
+	for (int i = 0; i < 200; ++i)
+	{
+		auto handle = sinks->add(std::make_shared<CountingSink>());
+		std::this_thread::yield();
+		EXPECT_TRUE(sinks->remove(handle));
+	}
+
+	stop = true;
+	for (auto &thread : threads)
+		thread.join();
+
+	EXPECT_EQ(stable->count.load(), logged.load());
+	EXPECT_EQ(sinks->snapshot()->size(), 1u);
+}
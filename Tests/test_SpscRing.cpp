@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+#include "SpscRing.h"
+
+
+namespace
+{
+
+template <typename T>
+void push(SpscRing<T> &ring, T value)
+{
+	T *slot = ring.beginPush();
+	ASSERT_NE(slot, nullptr);
+	*slot = std::move(value);
+	ring.commitPush();
+}
+
+} // namespace
+
+
+TEST(SpscRing, RoundsCapacityUpToPowerOfTwo)
+{
+	SpscRing<int> ring(100);
+	EXPECT_EQ(ring.capacity(), 128u);
+}
+
+TEST(SpscRing, ReadsInFifoOrderAndRejectsPushWhenFull)
+{
+	SpscRing<int> ring(2);
+	push(ring, 1);
+	push(ring, 2);
+	EXPECT_EQ(ring.beginPush(), nullptr);
+	EXPECT_EQ(ring.size(), 2u);
+
+	ASSERT_NE(ring.front(), nullptr);
+	EXPECT_EQ(*ring.front(), 1);
+	ring.pop();
+	EXPECT_EQ(*ring.front(), 2);
+	ring.pop();
+	EXPECT_EQ(ring.front(), nullptr);
+}
+
+TEST(SpscRing, SlotsKeepTheirStorageAcrossLaps)
+{
+	SpscRing<std::string> ring(2);
+
+	std::string			 *slot = ring.beginPush();
+	slot->assign(100, 'x');
+	const char *storage = slot->data();
+	ring.commitPush();
+	ring.pop();
+
+	slot = ring.beginPush();
+	slot->assign("second slot");
+	ring.commitPush();
+	ring.pop();
+
+	// Back in the first slot: assigning a shorter string reuses its buffer
+	slot = ring.beginPush();
+	ASSERT_NE(slot, nullptr);
+	slot->assign("short");
+	EXPECT_EQ(slot->data(), storage);
+}
+
+TEST(SpscRing, DeliversEveryItemInOrderAcrossThreads)
+{
+	constexpr int items = 100000;
+	SpscRing<int> ring(64);
+
+	std::thread	  producer(
+		  [&]
+		  {
+			  for (int i = 0; i < items; ++i)
+			  {
+				  int *slot;
+				  while (!(slot = ring.beginPush()))
+					  std::this_thread::yield();
+				  *slot = i;
+				  ring.commitPush();
+			  }
+		  });
+
+	int expected = 0;
+	while (expected < items)
+	{
+		if (int *value = ring.front())
+		{
+			ASSERT_EQ(*value, expected++);
+			ring.pop();
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	producer.join();
+	EXPECT_EQ(ring.front(), nullptr);
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RecordingSink.h"
+#include "StagingWriter.h"
+
+
+namespace
+{
+
+void stage(StagingWriter &writer, const std::string &payload, size_t threadId, spdlog::log_clock::time_point time = spdlog::log_clock::now())
+{
+	writer.enqueue(time, threadId, spdlog::level::info, 10, "/src/Foo.cpp", "doWork", payload);
+}
+
+} // namespace
+
+
+TEST(StagingWriter, WritesAllStagedMessagesBeforeDestruction)
+{
+	auto sink	= std::make_shared<RecordingSink>();
+	auto logger = std::make_shared<spdlog::logger>("staging_test", sink);
+
+	{
+		StagingWriter writer(logger, 16, OverflowPolicy::Block);
+		for (int i = 0; i < 100; ++i)
+			stage(writer, "message " + std::to_string(i), 4242);
+	}
+
+	ASSERT_EQ(sink->payloads.size(), 100u);
+	EXPECT_EQ(sink->payloads.front(), "message 0");
+	EXPECT_EQ(sink->payloads.back(), "message 99");
+	EXPECT_EQ(sink->threadIds.front(), 4242u);
+}
+
+TEST(StagingWriter, MergesThreadsInTimestampOrder)
+{
+	constexpr int threads		   = 8;
+	constexpr int messagesPerThread = 2000;
+
+	auto		  sink			   = std::make_shared<RecordingSink>();
+	auto		  logger		   = std::make_shared<spdlog::logger>("staging_test", sink);
+
+	{
+		StagingWriter			 writer(logger, 64, OverflowPolicy::Block);
+		std::vector<std::thread> producers;
+
+		for (int t = 0; t < threads; ++t)
+		{
+			producers.emplace_back(
+				[&writer, t]
+				{
+					for (int i = 0; i < messagesPerThread; ++i)
+						stage(writer, std::to_string(i), static_cast<size_t>(t));
+				});
+		}
+
+		for (auto &producer : producers)
+			producer.join();
+	}
+
+	ASSERT_EQ(sink->payloads.size(), static_cast<size_t>(threads * messagesPerThread));
+
+	// Each thread's messages keep their order
+	std::vector<int> next(threads, 0);
+	for (size_t i = 0; i < sink->payloads.size(); ++i)
+	{
+		auto thread = sink->threadIds[i];
+		EXPECT_EQ(sink->payloads[i], std::to_string(next[thread]++));
+	}
+}
+
+TEST(StagingWriter, TakesEarliestRecordAcrossRings)
+{
+	auto sink	= std::make_shared<RecordingSink>();
+	auto logger = std::make_shared<spdlog::logger>("staging_test", sink);
+	auto start	= spdlog::log_clock::now();
+	sink->hold();
+
+	{
+		StagingWriter writer(logger, 16, OverflowPolicy::Block);
+		stage(writer, "blocker", 0, start);
+
+		// Staged while the writer is held in the sink, so both rings are filled when it merges
+		std::thread([&] { stage(writer, "late", 2, start + std::chrono::milliseconds(20)); }).join();
+		std::thread([&] { stage(writer, "early", 1, start + std::chrono::milliseconds(10)); }).join();
+
+		sink->release();
+	}
+
+	EXPECT_EQ(sink->payloads, (std::vector<std::string>{"blocker", "early", "late"}));
+}
+
+TEST(StagingWriter, DropsNewestWhenThreadRingIsFull)
+{
+	auto sink	= std::make_shared<RecordingSink>();
+	auto logger = std::make_shared<spdlog::logger>("staging_test", sink);
+
+	uint64_t dropped = 0;
+	{
+		StagingWriter writer(logger, 2, OverflowPolicy::DropNewest);
+		for (int i = 0; i < 1000; ++i)
+			stage(writer, "message " + std::to_string(i), 1);
+
+		dropped = writer.droppedMessages();
+	}
+
+	EXPECT_EQ(sink->payloads.size() + dropped, 1000u);
+	EXPECT_EQ(sink->payloads.front(), "message 0");
+}
+
+TEST(StagingWriter, RemovesRingsOfExitedThreads)
+{
+	auto		  sink	 = std::make_shared<RecordingSink>();
+	auto		  logger = std::make_shared<spdlog::logger>("staging_test", sink);
+	StagingWriter writer(logger, 16, OverflowPolicy::Block);
+
+	std::thread([&] { stage(writer, "from a short-lived thread", 7); }).join();
+
+	// The writer drops the ring once it is drained and its thread has exited
+	for (int i = 0; i < 1000; ++i)
+	{
+		stage(writer, "keep the writer busy", 1);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		if (writer.ringCount() == 1)
+			break;
+	}
+
+	EXPECT_EQ(writer.ringCount(), 1u); // Only the ring of this thread is left
+}
@@ -0,0 +1,64 @@
+/*
+==============================================================================
+	Module			logdecode
+	Description		Converts binary log files back into the regular text log
+==============================================================================
+*/
+
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "BinaryLogReader.h"
+
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2 || argc > 3)
+	{
+		std::cerr << "Usage: logdecode <binary log> [output file]\n";
+		return 2;
+	}
+
+	std::ifstream input(argv[1], std::ios::binary);
+	if (!input)
+	{
+		std::cerr << "logdecode: cannot open " << argv[1] << "\n";
+		return 1;
+	}
+
+	std::ofstream fileOutput;
+	if (argc == 3)
+	{
+		fileOutput.open(argv[2], std::ios::binary);
+		if (!fileOutput)
+		{
+			std::cerr << "logdecode: cannot create " << argv[2] << "\n";
+			return 1;
+		}
+	}
+	std::ostream &output = argc == 3 ? fileOutput : std::cout;
+
+	try
+	{
+		BinaryLogReader reader(input);
+		BinaryRecord	record;
+		std::string		line;
+
+		while (reader.next(record))
+		{
+			line.clear();
+			reader.render(record, line);
+			output.write(line.data(), static_cast<std::streamsize>(line.size()));
+		}
+	}
+	catch (const std::exception &e)
+	{
+		output.flush();
+		std::cerr << "logdecode: " << e.what() << "\n";
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,17 @@
+include(cpm)
+
+CPMAddPackage(
+        NAME benchmark
+        GITHUB_REPOSITORY google/benchmark
+        VERSION 1.9.1
+        SOURCE_DIR ${LIB_DIR}/benchmark
+        OPTIONS
+        "BENCHMARK_ENABLE_TESTING OFF"
+        "BENCHMARK_ENABLE_GTEST_TESTS OFF"
+        "BENCHMARK_ENABLE_INSTALL OFF"
+        )
+
+macro(AddBenchmarks target)
+    message("Adding benchmarks to ${target}")
+    target_link_libraries(${target} PRIVATE benchmark::benchmark_main)
+endmacro()
@@ -0,0 +1,136 @@
+/*
+==============================================================================
+	Module			AsyncQueue
+	Description		Bounded lock-free queue feeding the asynchronous writer
+==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+
+/*
+ *	@brief		Bounded multi-producer queue based on a ring of sequenced cells.
+ *				Producers and consumers only synchronize through per-cell sequence numbers, so no locks are
+ *				taken. Popping is also safe from several threads, which lets producers evict the oldest entry.
+ */
+template <typename T>
+class AsyncQueue
+{
+public:
+	explicit AsyncQueue(size_t capacity) : mCapacity(roundUpToPowerOfTwo(capacity)), mMask(mCapacity - 1), mCells(std::make_unique<Cell[]>(mCapacity))
+	{
+		for (size_t i = 0; i < mCapacity; ++i)
+		{
+			mCells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	AsyncQueue(const AsyncQueue &)			  = delete;
+	AsyncQueue &operator=(const AsyncQueue &) = delete;
+
+
+	// Moves the item into the queue. Leaves it untouched and returns false if the queue is full.
+	bool		tryPush(T &&item)
+	{
+		size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			Cell	 &cell	   = mCells[pos & mMask];
+			size_t	  sequence = cell.sequence.load(std::memory_order_acquire);
+			ptrdiff_t diff	   = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos);
+
+			if (diff == 0)
+			{
+				if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					cell.data = std::move(item);
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				return false; // Full
+			}
+			else
+			{
+				pos = mEnqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+
+	// Moves the oldest item out of the queue. Returns false if the queue is empty.
+	bool tryPop(T &item)
+	{
+		size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			Cell	 &cell	   = mCells[pos & mMask];
+			size_t	  sequence = cell.sequence.load(std::memory_order_acquire);
+			ptrdiff_t diff	   = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos + 1);
+
+			if (diff == 0)
+			{
+				if (mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					item = std::move(cell.data);
+					cell.sequence.store(pos + mCapacity, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				return false; // Empty
+			}
+			else
+			{
+				pos = mDequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+
+	size_t capacity() const noexcept { return mCapacity; }
+
+	// Approximate number of queued items; exact only while no other thread touches the queue
+	size_t size() const noexcept
+	{
+		size_t enqueued = mEnqueuePos.load(std::memory_order_relaxed);
+		size_t dequeued = mDequeuePos.load(std::memory_order_relaxed);
+		return enqueued > dequeued ? enqueued - dequeued : 0;
+	}
+
+
+private:
+	static size_t roundUpToPowerOfTwo(size_t value)
+	{
+		size_t result = 2;
+		while (result < value)
+		{
+			result <<= 1;
+		}
+		return result;
+	}
+
+	struct Cell
+	{
+		std::atomic<size_t> sequence{0};
+		T					data{};
+	};
+
+	static constexpr size_t			  CacheLineSize = 64;
+
+	const size_t					  mCapacity;
+	const size_t					  mMask;
+	std::unique_ptr<Cell[]>			  mCells;
+
+	alignas(CacheLineSize) std::atomic<size_t> mEnqueuePos{0};
+	alignas(CacheLineSize) std::atomic<size_t> mDequeuePos{0};
+};
@@ -0,0 +1,82 @@
+/*
+==============================================================================
+	Module			AsyncWriter
+	Description		Background thread draining queued messages into the sinks
+==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <spdlog/logger.h>
+
+#include "AsyncQueue.h"
+#include "DeferredFormat.h"
+#include "LoggerWrapper.h"
+
+
+/*
+ *	@brief		A message captured on the logging thread, owning everything the sinks need later
+ */
+struct AsyncRecord
+{
+	spdlog::log_clock::time_point time;
+	size_t						  threadId = 0;
+	spdlog::level::level_enum	  level	   = spdlog::level::off;
+	int							  line	   = 0;
+	const char					 *file	   = nullptr; // Static literals, see logging::log()
+	const char					 *function = nullptr;
+	std::string					  payload;
+	std::string					  fields; // Encoded key-value fields of a LOG_*_KV call, empty otherwise
+
+	// Set for a message with deferred formatting: the payload holds the captured arguments, which the writer
+	// thread formats with the call site's format string
+	logging::deferred::FormatFn	  format = nullptr;
+	std::string_view			  formatString;
+};
+
+
+// Writes the record to every sink of the logger that accepts its level, formatting captured arguments first.
+// Formatting and sink errors are reported on stderr.
+void writeRecord(spdlog::logger &logger, const AsyncRecord &record);
+
+void flushSinks(spdlog::logger &logger);
+
+
+class AsyncWriter
+{
+public:
+	AsyncWriter(std::shared_ptr<spdlog::logger> logger, size_t queueSize, OverflowPolicy overflowPolicy);
+
+	// Writes out everything still queued, flushes the sinks and joins the writer thread
+	~AsyncWriter();
+
+	AsyncWriter(const AsyncWriter &)			= delete;
+	AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+	void		 enqueue(AsyncRecord &&record);
+
+	uint64_t	 droppedMessages() const noexcept { return mDropped.load(std::memory_order_relaxed); }
+
+	size_t		 queueDepth() const noexcept { return mQueue.size(); }
+
+private:
+	void							run();
+
+	void							wakeWriter();
+
+	std::shared_ptr<spdlog::logger> mLogger;
+	AsyncQueue<AsyncRecord>			mQueue;
+	const OverflowPolicy			mOverflowPolicy;
+
+	std::atomic<uint64_t>			mDropped{0};
+	std::atomic<bool>				mSleeping{false};
+	std::atomic<bool>				mStop{false};
+
+	std::thread						mWorker;
+};
@@ -0,0 +1,101 @@
+/*
+==============================================================================
+	Module			BatchedFileSink
+	Description		Rotating file sink writing formatted lines in batches
+==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <spdlog/sinks/base_sink.h>
+
+#include "LoggerWrapper.h"
+#include "RotationArchiver.h"
+
+
+/*
+ *	@brief		Rotating file sink that gathers formatted lines and writes them with one vectored write per
+ *				batch instead of one write per message. Pending lines are written when
+ *				- the batch reaches writeBatchBytes (0 writes every line right away),
+ *				- a message at or above flushLevel arrives (Error and Critical always qualify),
+ *				- flushInterval elapsed (checked by a background thread; 0 disables it),
+ *				- the sink is flushed or destroyed.
+ *				File names and rotation follow the rotating file sink: app.log -> app.1.log -> ...
+ *				Besides the size limit, a rotate interval rotates before the first line of each new interval.
+ *				With a codec, rotated files go to a RotationArchiver instead and become app.1.log.lz4 -> ...
+ */
+class BatchedFileSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+	BatchedFileSink(std::string fileName, size_t maxFileSize, size_t maxFiles, bool rotateOnOpen, spdlog::level::level_enum flushLevel,
+					std::chrono::milliseconds flushInterval, size_t writeBatchBytes, Codec compressOnRotate = Codec::None,
+					std::chrono::seconds rotateInterval = std::chrono::seconds(0));
+
+	~BatchedFileSink() override;
+
+	BatchedFileSink(const BatchedFileSink &)			= delete;
+	BatchedFileSink &operator=(const BatchedFileSink &) = delete;
+
+	// Number of write calls made so far, for tests and benchmarks
+	size_t			 writeCount() const noexcept { return mWriteCount.load(std::memory_order_relaxed); }
+
+	// Blocks until the rotated files handed to the archiver are compressed, for tests
+	void			 waitForArchives();
+
+protected:
+	void sink_it_(const spdlog::details::log_msg &msg) override;
+
+	void flush_() override;
+
+private:
+	void		openFile(bool truncate);
+
+	void		closeFile();
+
+	void		rotate();
+
+	// Start of the next rotate interval after `time`
+	spdlog::log_clock::time_point nextRotationAfter(spdlog::log_clock::time_point time) const;
+
+	// Writes the pending batch followed by `line` (may be empty) in one call
+	void		writePending(const char *line, size_t lineLength);
+
+	void		runFlusher();
+
+	const std::string				mFileName;
+	const size_t					mMaxFileSize;
+	const size_t					mMaxFiles;
+	const spdlog::level::level_enum mFlushLevel;
+	const std::chrono::milliseconds mFlushInterval;
+	const size_t					mWriteBatchBytes;
+	const std::chrono::seconds		mRotateInterval;
+	spdlog::log_clock::time_point	mNextRotation;
+
+#ifdef _WIN32
+	std::FILE					   *mFile = nullptr;
+#else
+	int								mFd	  = -1;
+#endif
+	size_t							mFileSize	= 0; // Bytes in the file, without the pending batch
+	spdlog::memory_buf_t			mPending;
+	spdlog::memory_buf_t			mFormatted;
+	std::atomic<size_t>				mWriteCount{0};
+
+	// Set if rotated files are compressed
+	std::unique_ptr<RotationArchiver> mArchiver;
+
+	// Interval flushing
+	std::mutex						mFlusherMutex;
+	std::condition_variable			mFlusherWake;
+	bool							mStopFlusher = false;
+	std::thread						mFlusher;
+};
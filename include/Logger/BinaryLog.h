@@ -0,0 +1,259 @@
+/*
+==============================================================================
+	Module			BinaryLog
+	Description		Call-site encoding of log arguments for the binary output
+==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "LoggerWrapper.h"
+
+
+namespace logging
+{
+namespace binary
+{
+
+/*
+ *	@brief		Type tags of encoded arguments. Values are part of the file format - only append.
+ */
+enum class ArgType : uint8_t
+{
+	Bool = 1,
+	Char,
+	Int8,
+	Int16,
+	Int32,
+	Int64,
+	UInt8,
+	UInt16,
+	UInt32,
+	UInt64,
+	Float,
+	Double,
+	String,
+	Pointer
+};
+
+
+// Type signature of a call site whose arguments cannot be encoded; its records carry the formatted message
+inline constexpr std::string_view Preformatted	= "P";
+
+
+/*
+ *	File layout, all values in the writer's native byte order:
+ *		header		"LGBN", u32 version, u32 byte order mark
+ *		call site	'D', u32 id, u8 level, i32 line, str file, str function, str format, str signature
+ *		record		'R', u32 id, i64 time (ns since epoch), u64 thread id, u32 size, encoded arguments
+ *	where str is a u32 length followed by the bytes. A call site is written once, before its first record.
+ */
+inline constexpr char			  FileMagic[4]	= {'L', 'G', 'B', 'N'};
+inline constexpr uint32_t		  FileVersion	= 1;
+inline constexpr uint32_t		  ByteOrderMark = 0x01020304;
+inline constexpr char			  CallSiteTag	= 'D';
+inline constexpr char			  RecordTag		= 'R';
+
+
+template <typename T>
+constexpr ArgType integralType()
+{
+	if constexpr (std::is_signed_v<T>)
+	{
+		if constexpr (sizeof(T) == 1)
+			return ArgType::Int8;
+		else if constexpr (sizeof(T) == 2)
+			return ArgType::Int16;
+		else if constexpr (sizeof(T) == 4)
+			return ArgType::Int32;
+		else
+			return ArgType::Int64;
+	}
+	else
+	{
+		if constexpr (sizeof(T) == 1)
+			return ArgType::UInt8;
+		else if constexpr (sizeof(T) == 2)
+			return ArgType::UInt16;
+		else if constexpr (sizeof(T) == 4)
+			return ArgType::UInt32;
+		else
+			return ArgType::UInt64;
+	}
+}
+
+
+/*
+ *	@brief		Maps an argument type to its tag. `encodable` is false for types that are only formattable
+ *				through a user-provided std::formatter; such call sites fall back to preformatted records.
+ */
+template <typename T, typename = void>
+struct ArgTraits
+{
+	static constexpr bool encodable = false;
+};
+
+template <>
+struct ArgTraits<bool>
+{
+	static constexpr bool	 encodable = true;
+	static constexpr ArgType type	   = ArgType::Bool;
+};
+
+template <>
+struct ArgTraits<char>
+{
+	static constexpr bool	 encodable = true;
+	static constexpr ArgType type	   = ArgType::Char;
+};
+
+template <typename T>
+struct ArgTraits<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char> && sizeof(T) <= 8>>
+{
+	static constexpr bool	 encodable = true;
+	static constexpr ArgType type	   = integralType<T>();
+};
+
+template <>
+struct ArgTraits<float>
+{
+	static constexpr bool	 encodable = true;
+	static constexpr ArgType type	   = ArgType::Float;
+};
+
+template <>
+struct ArgTraits<double>
+{
+	static constexpr bool	 encodable = true;
+	static constexpr ArgType type	   = ArgType::Double;
+};
+
+template <typename T>
+struct ArgTraits<T, std::enable_if_t<std::is_same_v<T, const char *> || std::is_same_v<T, char *> || std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>>>
+{
+	static constexpr bool	 encodable = true;
+	static constexpr ArgType type	   = ArgType::String;
+};
+
+template <size_t N>
+struct ArgTraits<char[N]>
+{
+	static constexpr bool	 encodable = true;
+	static constexpr ArgType type	   = ArgType::String;
+};
+
+template <typename T>
+struct ArgTraits<T, std::enable_if_t<std::is_same_v<T, const void *> || std::is_same_v<T, void *> || std::is_same_v<T, std::nullptr_t>>>
+{
+	static constexpr bool	 encodable = true;
+	static constexpr ArgType type	   = ArgType::Pointer;
+};
+
+
+template <typename T>
+using ArgTraitsOf = ArgTraits<std::remove_cvref_t<T>>;
+
+template <typename... Args>
+inline constexpr bool allEncodable = (ArgTraitsOf<Args>::encodable && ...);
+
+
+// Type signature of a call site: one tag byte per argument
+template <typename... Args>
+struct Signature
+{
+	static constexpr char			  tags[sizeof...(Args) + 1] = {static_cast<char>(ArgTraitsOf<Args>::type)..., '\0'};
+	static constexpr std::string_view value{tags, sizeof...(Args)};
+};
+
+
+template <typename T>
+void appendRaw(std::string &out, const T &value)
+{
+	char bytes[sizeof(T)];
+	std::memcpy(bytes, &value, sizeof(T));
+	out.append(bytes, sizeof(T));
+}
+
+
+inline void appendString(std::string &out, std::string_view text)
+{
+	appendRaw(out, static_cast<uint32_t>(text.size()));
+	out.append(text.data(), text.size());
+}
+
+
+template <typename T>
+void encodeArg(std::string &out, const T &value)
+{
+	using Decayed = std::remove_cvref_t<T>;
+
+	if constexpr (std::is_array_v<Decayed>)
+		appendString(out, std::string_view(value, strnlen(value, std::extent_v<Decayed>)));
+	else if constexpr (ArgTraits<Decayed>::type == ArgType::String)
+		appendString(out, value ? std::string_view(value) : std::string_view());
+	else if constexpr (ArgTraits<Decayed>::type == ArgType::Pointer)
+		appendRaw(out, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(static_cast<const void *>(value))));
+	else
+		appendRaw(out, value);
+}
+
+inline void encodeArg(std::string &out, const std::string &value)
+{
+	appendString(out, value);
+}
+
+inline void encodeArg(std::string &out, std::string_view value)
+{
+	appendString(out, value);
+}
+
+
+// Per-thread scratch space for encoded arguments, separate from the text message buffer
+inline std::string &encodeBuffer()
+{
+	thread_local std::string buffer;
+	return buffer;
+}
+
+
+template <typename... Args>
+std::string_view encodeArgs(const Args &...args)
+{
+	auto &buffer = encodeBuffer();
+	buffer.clear();
+	(encodeArg(buffer, args), ...);
+	return buffer;
+}
+
+} // namespace binary
+
+
+void writeBinary(const CallSite &site, std::string_view signature, std::string_view encodedArgs);
+
+
+/*
+ *	@brief		Writes a record for the binary output: the raw argument bytes if every argument type can be
+ *				encoded, the formatted message otherwise.
+ */
+template <typename... Args>
+void logBinary(const CallSite &site, std::format_string<Args...> fmtStr, Args &&...args)
+{
+	if constexpr (binary::allEncodable<Args...>)
+	{
+		writeBinary(site, binary::Signature<Args...>::value, binary::encodeArgs(args...));
+	}
+	else
+	{
+		auto message = std::format(fmtStr, std::forward<Args>(args)...);
+		writeBinary(site, binary::Preformatted, binary::encodeArgs(message));
+	}
+}
+
+} // namespace logging
@@ -0,0 +1,68 @@
+/*
+==============================================================================
+	Module			BinaryLogReader
+	Description		Reads binary log files and renders their records as text
+==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "Formatter.h"
+#include "LoggerWrapper.h"
+
+
+/*
+ *	@brief		Call site as stored in a binary log file
+ */
+struct BinaryCallSite
+{
+	LogLevel	level = LogLevel::Info;
+	int			line  = 0;
+	std::string file;
+	std::string function;
+	std::string format;
+	std::string signature;
+};
+
+
+/*
+ *	@brief		A decoded record. `site` points into the reader and stays valid for its lifetime.
+ */
+struct BinaryRecord
+{
+	const BinaryCallSite *site	   = nullptr;
+	int64_t				  timeNs   = 0;
+	uint64_t			  threadId = 0;
+	std::string			  message;
+};
+
+
+class BinaryLogReader
+{
+public:
+	// Reads and checks the file header. Throws std::runtime_error if the stream is not a binary log.
+	explicit BinaryLogReader(std::istream &input);
+
+	// Reads the next record, formatting its message. Returns false at the end of the stream; throws on corrupt input.
+	bool			   next(BinaryRecord &record);
+
+	// Appends the record as the text sinks would have written it
+	void			   render(const BinaryRecord &record, std::string &dest);
+
+	// Substitutes encoded arguments into a std::format string, honoring indices, format specs and nested widths
+	static std::string formatArguments(std::string_view format, std::string_view signature, std::string_view encodedArgs);
+
+private:
+	void							  readCallSite();
+
+	std::istream					 &mInput;
+	std::unordered_map<uint32_t, BinaryCallSite> mCallSites; // Node based, so record site pointers stay valid
+	std::string						  mArgs;
+	Formatter						  mFormatter;
+};
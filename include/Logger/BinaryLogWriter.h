@@ -0,0 +1,49 @@
+/*
+==============================================================================
+	Module			BinaryLogWriter
+	Description		Appends call sites and raw argument records to a binary log file
+==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "LoggerWrapper.h"
+
+
+/*
+ *	@brief		Writes the binary log format described in BinaryLog.h. Each call site is stored once, records
+ *				only reference it by id, so a record costs a few bytes on top of its arguments.
+ *				Output is buffered and flushed on Error and above and when the writer is closed or destroyed.
+ */
+class BinaryLogWriter
+{
+public:
+	explicit BinaryLogWriter(const std::string &fileName);
+	~BinaryLogWriter();
+
+	BinaryLogWriter(const BinaryLogWriter &)			= delete;
+	BinaryLogWriter &operator=(const BinaryLogWriter &) = delete;
+
+	void			 write(const logging::CallSite &site, std::string_view signature, std::string_view encodedArgs, int64_t timeNs, uint64_t threadId);
+
+	void			 flush();
+
+	// Flushes and closes the file. Later writes are dropped, so a thread still holding the writer does no harm.
+	void			 close();
+
+private:
+	// Returns the id of the call site, writing its description first if it has not been seen yet
+	uint32_t		 callSiteId(const logging::CallSite &site, std::string_view signature);
+
+	std::mutex											 mMutex;
+	std::FILE											*mFile = nullptr;
+	std::unordered_map<const logging::CallSite *, uint32_t> mCallSites;
+	std::string											 mScratch; // Reused to build each entry in one fwrite
+};
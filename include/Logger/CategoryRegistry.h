@@ -0,0 +1,67 @@
+/*
+==============================================================================
+	Module			CategoryRegistry
+	Description		Named log categories with their own level
+==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "LoggerWrapper.h"
+
+
+/*
+ *	@brief		Levels of named categories (e.g. "net", "db"). Every category has a threshold atomic with a
+ *				stable address, so a call site resolves its category once and afterwards checks the level with
+ *				a single load. The threshold combines the category's level (or the default level for
+ *				categories without one) with the lowest level any output accepts, so a category set to Trace
+ *				still formats nothing while no output wants Trace messages.
+ */
+class CategoryRegistry
+{
+public:
+	explicit CategoryRegistry(LogLevel minimumLevel = LogLevel::Trace);
+
+	CategoryRegistry(const CategoryRegistry &)			  = delete;
+	CategoryRegistry &operator=(const CategoryRegistry &) = delete;
+
+	// Threshold of the category, created on first use. The reference stays valid for the registry's lifetime.
+	std::atomic<LogLevel> &threshold(std::string_view category);
+
+	void				   setLevel(std::string_view category, LogLevel level);
+
+	// Level for categories without one of their own. Trace by default, which filters nothing.
+	void				   setDefaultLevel(LogLevel level);
+
+	// Replaces all category levels at once; categories not listed fall back to the default level
+	void				   configure(const std::map<std::string, LogLevel, std::less<>> &levels, LogLevel defaultLevel);
+
+	// Lowest level accepted by any output, kept up to date by the logger as outputs change
+	void				   setMinimumLevel(LogLevel level);
+
+private:
+	struct Category
+	{
+		std::optional<LogLevel> level;
+		std::atomic<LogLevel>	threshold{LogLevel::Trace};
+	};
+
+	Category &getOrCreate(std::string_view category);
+
+	void	  publish(Category &category) const;
+
+	void	  publishAll() const;
+
+	mutable std::mutex								   mMutex;
+	std::map<std::string, std::unique_ptr<Category>, std::less<>> mCategories;
+	LogLevel										   mDefaultLevel = LogLevel::Trace;
+	LogLevel										   mMinimumLevel;
+};
@@ -0,0 +1,60 @@
+/*
+==============================================================================
+	Module			ConfigWatcher
+	Description		Background thread reporting changes to a configuration file
+==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+/*
+ *	@brief		Calls onChange on its own thread whenever the watched file was written or replaced.
+ *				On Linux the file's directory is watched with inotify, so saving in place and the
+ *				write-to-temp-then-rename of most editors are both seen. Events arriving within the settle
+ *				time of each other are reported once. Other platforms poll the modification time.
+ */
+class ConfigWatcher
+{
+public:
+	ConfigWatcher(std::filesystem::path path, std::function<void()> onChange, std::chrono::milliseconds settleTime = std::chrono::milliseconds(50));
+
+	// Stops and joins the watcher thread; a running onChange call is finished first
+	~ConfigWatcher();
+
+	ConfigWatcher(const ConfigWatcher &)			= delete;
+	ConfigWatcher &operator=(const ConfigWatcher &) = delete;
+
+private:
+	void							run();
+
+#ifdef __linux__
+	bool							runInotify();
+#endif
+
+	void							runPolling();
+
+	void							notify();
+
+	const std::filesystem::path		mPath;
+	const std::function<void()>		mOnChange;
+	const std::chrono::milliseconds mSettleTime;
+
+#ifdef __linux__
+	int								mInotifyFd = -1;
+	int								mWakeFd	   = -1; // eventfd signalled on shutdown
+#endif
+
+	std::mutex						mStopMutex;
+	std::condition_variable			mStopWake;
+	bool							mStop = false;
+	std::thread						mThread;
+};
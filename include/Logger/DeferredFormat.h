@@ -0,0 +1,152 @@
+/*
+==============================================================================
+	Module			DeferredFormat
+	Description		Captures log arguments so the writer thread can format them later
+==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include "BinaryLog.h"
+#include "LoggerWrapper.h"
+
+
+namespace logging
+{
+namespace deferred
+{
+
+/*
+ *	@brief		Renders captured arguments with the call site's format string, appending to `out`.
+ *				One instantiation per argument type list, so the record only needs this pointer to be
+ *				formatted by a thread that knows nothing about the types.
+ */
+using FormatFn = void (*)(std::string &out, std::string_view format, std::string_view captured);
+
+
+template <typename T>
+inline constexpr bool isString = std::is_same_v<T, const char *> || std::is_same_v<T, char *> || std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+								 (std::is_array_v<T> && std::is_same_v<std::remove_extent_t<T>, char>);
+
+template <typename T>
+inline constexpr bool isChrono = false;
+
+template <typename Rep, typename Period>
+inline constexpr bool isChrono<std::chrono::duration<Rep, Period>> = true;
+
+template <typename Clock, typename Duration>
+inline constexpr bool isChrono<std::chrono::time_point<Clock, Duration>> = true;
+
+
+/*
+ *	@brief		Opts a trivially copyable type that owns all of its data (no pointers or views into other memory)
+ *				into deferred formatting. Specialize it as true for such types; the value is copied as its bytes
+ *				and formatted on the writer thread.
+ */
+template <typename T>
+struct CaptureAsBytes : std::false_type
+{
+};
+
+
+/*
+ *	@brief		Strings are copied into the record. Numbers, enums, void pointers, std::chrono durations and
+ *				time points, and types that opt in through CaptureAsBytes are copied as their bytes. Calls with
+ *				any other argument type are formatted by the caller.
+ */
+template <typename T>
+inline constexpr bool capturable = isString<T> || std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_same_v<T, void *> || std::is_same_v<T, const void *> ||
+								   std::is_same_v<T, std::nullptr_t> || isChrono<T> || (CaptureAsBytes<T>::value && std::is_trivially_copyable_v<T>);
+
+template <typename... Args>
+inline constexpr bool allCapturable = (capturable<std::remove_cvref_t<Args>> && ...);
+
+// What an argument is formatted from on the writer thread: strings as a view into the record
+template <typename T>
+using Stored = std::conditional_t<isString<T>, std::string_view, T>;
+
+
+template <typename T>
+void captureArg(std::string &out, const T &value)
+{
+	using Decayed = std::remove_cvref_t<T>;
+
+	if constexpr (std::is_array_v<Decayed>)
+		binary::appendString(out, std::string_view(value, strnlen(value, std::extent_v<Decayed>)));
+	else if constexpr (std::is_pointer_v<Decayed> && isString<Decayed>)
+		binary::appendString(out, value ? std::string_view(value) : std::string_view());
+	else if constexpr (isString<Decayed>)
+		binary::appendString(out, std::string_view(value));
+	else
+		binary::appendRaw(out, value);
+}
+
+
+template <typename T>
+Stored<T> restoreArg(const char *&cursor)
+{
+	if constexpr (isString<T>)
+	{
+		uint32_t length;
+		std::memcpy(&length, cursor, sizeof(length));
+		std::string_view text(cursor + sizeof(length), length);
+		cursor += sizeof(length) + length;
+		return text;
+	}
+	else
+	{
+		std::array<char, sizeof(T)> bytes;
+		std::memcpy(bytes.data(), cursor, sizeof(T));
+		cursor += sizeof(T);
+		return std::bit_cast<T>(bytes);
+	}
+}
+
+
+template <typename... Args>
+void formatCaptured(std::string &out, std::string_view format, std::string_view captured)
+{
+	[[maybe_unused]] const char *cursor = captured.data(); // Unused for a format string without arguments
+	std::tuple<Stored<Args>...> values{restoreArg<Args>(cursor)...}; // Braced initialization restores in order
+
+	std::apply([&](auto &...args) { std::vformat_to(std::back_inserter(out), format, std::make_format_args(args...)); }, values);
+}
+
+
+// Per-thread scratch space for captured arguments, separate from the text and binary buffers
+inline std::string &captureBuffer()
+{
+	thread_local std::string buffer;
+	return buffer;
+}
+
+
+template <typename... Args>
+std::string_view captureArgs(const Args &...args)
+{
+	auto &buffer = captureBuffer();
+	buffer.clear();
+	(captureArg(buffer, args), ...);
+	return buffer;
+}
+
+} // namespace deferred
+
+
+// Hands captured arguments to the asynchronous writer, which formats them with the call site's format string
+void logCaptured(const CallSite &site, deferred::FormatFn format, std::string_view captured);
+
+} // namespace logging
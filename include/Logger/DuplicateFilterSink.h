@@ -0,0 +1,39 @@
+/*
+==============================================================================
+	Module			DuplicateFilterSink
+	Description		Sink wrapper suppressing repeated identical messages
+==============================================================================
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include <spdlog/sinks/dist_sink.h>
+
+
+/*
+ *	@brief		Forwards messages to its wrapped sinks, dropping a message that repeats the previous one
+ *				(same source location, payload and key-value fields) within maxSkipDuration of the last forwarded message.
+ *				Messages are compared by hash, and the number of dropped repeats is reported as
+ *				"Skipped N duplicate messages" before the next forwarded message.
+ */
+class DuplicateFilterSink : public spdlog::sinks::dist_sink<std::mutex>
+{
+public:
+	explicit DuplicateFilterSink(std::chrono::microseconds maxSkipDuration);
+
+	static uint64_t hashMessage(const spdlog::details::log_msg &msg);
+
+protected:
+	void sink_it_(const spdlog::details::log_msg &msg) override;
+
+private:
+	std::chrono::microseconds	  mMaxSkipDuration;
+	spdlog::log_clock::time_point mLastMessageTime;
+	uint64_t					  mLastMessageHash = 0;
+	bool						  mHasLastMessage  = false;
+	size_t						  mSkipCount	   = 0;
+};
@@ -7,21 +7,144 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include <spdlog/formatter.h>
 #include <spdlog/details/log_msg.h>
 
 
+/*
+ *	@brief		Writes log lines laid out by a pattern. The pattern is compiled once, in the constructor, into a
+ *				flat list of operations, so formatting a message only walks that list. The default pattern
+ *				(logging::DefaultPattern) skips the list and runs a hand-written version of the same layout.
+ *				Formatters built from the same pattern render a message only once when SinkList hands it to
+ *				several sinks; the others copy that rendering (see SharedRendering).
+ *
+ *				Flags follow spdlog's pattern syntax:
+ *					%Y %m %d %H %M %S %T	date and time in local time, as well as the other strftime flags
+ *											spdlog knows: %a %A %b %B %c %C %y %D %I %p %r %R %z
+ *					%e %f %F				milli-, micro- and nanoseconds of the second
+ *					%l %L					level name, one-letter level
+ *					%t %n					thread id, logger name
+ *					%s %g %# %!				source basename without extension, full path, line, function
+ *					%v						message, followed by the " key=value" fields of LOG_*_KV calls
+ *					%^ %$					start and end of the colored range (console only)
+ *					%%						a percent sign
+ *				A flag may be padded: %8l right-aligns in 8 columns, %-8l left-aligns, %=8l centers, and a
+ *				'!' after the width (%-8!l) cuts longer text. Unknown flags throw std::invalid_argument.
+ */
 class Formatter : public spdlog::formatter
 {
 public:
 	Formatter();
 
+	explicit Formatter(std::string_view pattern);
+
 	void							   format(const spdlog::details::log_msg &msg, spdlog::memory_buf_t &dest) override;
 
 	std::unique_ptr<spdlog::formatter> clone() const override;
 
+	// Appends encoded key-value fields (see KeyValue.h) as " key=value" text
+	static void						   appendFields(spdlog::memory_buf_t &dest, std::string_view fields);
+
 private:
-	static std::string format_time(const spdlog::log_clock::time_point &tp);
+	enum class Field : uint8_t
+	{
+		Literal,
+		SecondsText, // Date and time flags of second resolution, rendered once per second
+		Milliseconds,
+		Microseconds,
+		Nanoseconds,
+		Level,
+		ShortLevel,
+		Thread,
+		LoggerName,
+		Basename,
+		Path,
+		Line,
+		Function,
+		Payload,
+		ColorStart,
+		ColorEnd
+	};
+
+	enum class Align : uint8_t
+	{
+		None,
+		Left,
+		Right,
+		Center
+	};
+
+	struct Op
+	{
+		Field	 field	  = Field::Literal;
+		Align	 align	  = Align::None;
+		bool	 truncate = false;
+		uint16_t width	  = 0;
+		uint32_t offset	  = 0; // Literal: position in mLiterals. SecondsText: index into mSecondsTexts.
+		uint32_t length	  = 0;
+	};
+
+	// strftime format of a SecondsText op and its text for the cached second
+	struct SecondsText
+	{
+		std::string format;
+		size_t		maxLength = 0; // Upper bound of the rendered text
+		char		text[64]  = {};
+		size_t		length	  = 0;
+	};
+
+	void					compile(std::string_view pattern);
+
+	// Formats the message without looking at renderings shared by other sinks
+	void					render(const spdlog::details::log_msg &msg, spdlog::memory_buf_t &dest);
+
+	// The list of operations, for every pattern but the default one
+	void					runProgram(const spdlog::details::log_msg &msg, spdlog::memory_buf_t &dest);
+
+	// Text of a field op; numbers are rendered into `buffer`
+	std::string_view		fieldText(const Op &op, const spdlog::details::log_msg &msg, char *buffer, size_t size);
+
+	// Refreshes the cached local time and seconds texts when `t` is a new second
+	void					updateSecond(std::time_t t);
+
+	// Writes "YYYY-MM-DD HH:MM:SS.mmm" into buffer and returns the number of characters written
+	size_t					format_time(const spdlog::log_clock::time_point &tp, char *buffer, size_t size);
+
+	static std::string_view get_basename_no_ext(const char *fullpath);
+
+	// Looks up the basename of a __FILE__ literal by its address, trimming it only on first sight
+	std::string_view		cached_basename(const char *fullpath);
+
+	// Appends text left-aligned in a column of exactly `width` characters, truncating if it is longer
+	static void				append_column(spdlog::memory_buf_t &dest, std::string_view text, size_t width);
+
+	// Appends text padded and cut as the op says
+	static void				append_padded(spdlog::memory_buf_t &dest, std::string_view text, const Op &op);
+
+	uint32_t				mLayout		   = 0; // SharedRendering id of the pattern
+	bool					mDefaultLayout = true;
+	std::vector<Op>			mProgram;
+	std::string				mLiterals;
+	std::vector<SecondsText> mSecondsTexts;
+
+	// Local time of the last second seen, so localtime only runs once per second
+	std::time_t				mCachedSecond		= 0;
+	bool					mCacheValid			= false;
+	char					mCachedPrefix[32]	= {}; // "YYYY-MM-DD HH:MM:SS" for the default layout
+	size_t					mCachedPrefixLength = 0;
 
-	static std::string get_basename_no_ext(const char *fullpath);
+	// Direct-mapped cache from source file pointer to its trimmed basename
+	struct BasenameEntry
+	{
+		const char		*path = nullptr;
+		std::string_view basename;
+	};
+	std::array<BasenameEntry, 64> mBasenames{};
 };
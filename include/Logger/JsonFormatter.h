@@ -0,0 +1,44 @@
+/*
+==============================================================================
+	Module			JsonFormatter
+	Description		Formats log messages as JSON Lines
+==============================================================================
+*/
+
+#pragma once
+
+#include <ctime>
+#include <string_view>
+
+#include <spdlog/formatter.h>
+#include <spdlog/details/log_msg.h>
+
+
+/*
+ *	@brief		Writes one JSON object per message:
+ *				{"time":"2024-05-01T12:00:00.123456Z","level":"info","thread":42,"file":"src/Net.cpp","line":10,
+ *				 "function":"connect","message":"...", <key-value fields>}
+ *				Fields of LOG_*_KV calls keep their type (numbers, booleans, strings). The serialization is
+ *				written by hand into the destination buffer and does not allocate.
+ */
+class JsonFormatter : public spdlog::formatter
+{
+public:
+	void							   format(const spdlog::details::log_msg &msg, spdlog::memory_buf_t &dest) override;
+
+	std::unique_ptr<spdlog::formatter> clone() const override;
+
+	// Appends text as a quoted JSON string, escaping quotes, backslashes and control characters
+	static void						   appendString(spdlog::memory_buf_t &dest, std::string_view text);
+
+	// Appends encoded key-value fields (see KeyValue.h) as ,"key":value members
+	static void						   appendFields(spdlog::memory_buf_t &dest, std::string_view fields);
+
+private:
+	void							   appendTime(spdlog::memory_buf_t &dest, spdlog::log_clock::time_point time);
+
+	// "YYYY-MM-DDTHH:MM:SS" of the last second seen, so gmtime only runs once per second
+	std::time_t						   mCachedSecond = 0;
+	bool							   mCacheValid	 = false;
+	char							   mCachedPrefix[24]{};
+};
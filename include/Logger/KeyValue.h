@@ -0,0 +1,289 @@
+/*
+==============================================================================
+	Module			KeyValue
+	Description		Typed key-value fields of structured log calls
+==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "BinaryLog.h"
+#include "LoggerWrapper.h"
+
+
+namespace logging
+{
+namespace kv
+{
+
+/*
+ *	Fields are encoded back to back, each as
+ *		str key, u8 type (binary::ArgType), value
+ *	using the same value encoding as the binary output. Values of other types are formatted and stored as strings.
+ */
+
+template <typename T>
+void encodeField(std::string &out, std::string_view key, const T &value)
+{
+	using binary::ArgType;
+	using Traits = binary::ArgTraitsOf<T>;
+
+	binary::appendString(out, key);
+
+	if constexpr (Traits::encodable)
+	{
+		out.push_back(static_cast<char>(Traits::type));
+		binary::encodeArg(out, value);
+	}
+	else
+	{
+		out.push_back(static_cast<char>(ArgType::String));
+
+		// Length is patched in once the value is formatted in place
+		size_t lengthPos = out.size();
+		binary::appendRaw(out, uint32_t{0});
+		std::format_to(std::back_inserter(out), "{}", value);
+
+		auto length = static_cast<uint32_t>(out.size() - lengthPos - sizeof(uint32_t));
+		std::memcpy(out.data() + lengthPos, &length, sizeof(length));
+	}
+}
+
+
+// Strings are quoted if they would otherwise be ambiguous in key=value text
+template <typename Buffer>
+void appendTextString(Buffer &out, std::string_view text)
+{
+	if (!text.empty() && text.find_first_of(" =\"\\\t\n") == std::string_view::npos)
+	{
+		out.append(text.data(), text.data() + text.size());
+		return;
+	}
+
+	out.push_back('"');
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+			out.push_back('\\');
+		out.push_back(c);
+	}
+	out.push_back('"');
+}
+
+
+template <typename T>
+void appendTextField(std::string &out, std::string_view key, const T &value)
+{
+	out.push_back(' ');
+	out.append(key);
+	out.push_back('=');
+
+	if constexpr (std::is_convertible_v<const T &, std::string_view>)
+		appendTextString(out, std::string_view(value));
+	else if constexpr (std::is_same_v<std::remove_cvref_t<T>, bool>)
+		out.append(value ? "true" : "false");
+	else
+		std::format_to(std::back_inserter(out), "{}", value);
+}
+
+
+inline void appendTextFields(std::string &)
+{
+}
+
+template <typename Value, typename... Rest>
+void appendTextFields(std::string &text, std::string_view key, const Value &value, const Rest &...rest)
+{
+	appendTextField(text, key, value);
+	appendTextFields(text, rest...);
+}
+
+
+inline void encodeFields(std::string &)
+{
+}
+
+template <typename Value, typename... Rest>
+void encodeFields(std::string &fields, std::string_view key, const Value &value, const Rest &...rest)
+{
+	encodeField(fields, key, value);
+	encodeFields(fields, rest...);
+}
+
+
+// Decoded pointer value, kept apart from the integers
+struct PointerValue
+{
+	uint64_t address;
+};
+
+
+// Reads a fixed-size value and advances; returns false if the fields are truncated
+template <typename T>
+bool readRaw(std::string_view &fields, T &value)
+{
+	if (fields.size() < sizeof(T))
+		return false;
+
+	std::memcpy(&value, fields.data(), sizeof(T));
+	fields.remove_prefix(sizeof(T));
+	return true;
+}
+
+
+inline bool readString(std::string_view &fields, std::string_view &text)
+{
+	uint32_t length = 0;
+	if (!readRaw(fields, length) || fields.size() < length)
+		return false;
+
+	text = fields.substr(0, length);
+	fields.remove_prefix(length);
+	return true;
+}
+
+
+// Reads the key and type of the next field; returns false if the fields are truncated
+inline bool readKey(std::string_view &fields, std::string_view &key, binary::ArgType &type)
+{
+	uint8_t raw = 0;
+	if (!readString(fields, key) || !readRaw(fields, raw))
+		return false;
+
+	type = static_cast<binary::ArgType>(raw);
+	return true;
+}
+
+
+/*
+ *	@brief		Reads a value of the given type and passes it to visit as bool, char, a fixed-width integer, float,
+ *				double, std::string_view or PointerValue. Returns false if the value is truncated or the type unknown.
+ */
+template <typename Visitor>
+bool readValue(std::string_view &fields, binary::ArgType type, Visitor &&visit)
+{
+	using binary::ArgType;
+
+	auto readAs = [&fields, &visit]<typename T>(T value)
+	{
+		if (!readRaw(fields, value))
+			return false;
+		visit(value);
+		return true;
+	};
+
+	switch (type)
+	{
+	case ArgType::Bool: return readAs(bool{});
+	case ArgType::Char: return readAs(char{});
+	case ArgType::Int8: return readAs(int8_t{});
+	case ArgType::Int16: return readAs(int16_t{});
+	case ArgType::Int32: return readAs(int32_t{});
+	case ArgType::Int64: return readAs(int64_t{});
+	case ArgType::UInt8: return readAs(uint8_t{});
+	case ArgType::UInt16: return readAs(uint16_t{});
+	case ArgType::UInt32: return readAs(uint32_t{});
+	case ArgType::UInt64: return readAs(uint64_t{});
+	case ArgType::Float: return readAs(float{});
+	case ArgType::Double: return readAs(double{});
+	case ArgType::String:
+	{
+		std::string_view text;
+		if (!readString(fields, text))
+			return false;
+		visit(text);
+		return true;
+	}
+	case ArgType::Pointer:
+	{
+		uint64_t address = 0;
+		if (!readRaw(fields, address))
+			return false;
+		visit(PointerValue{address});
+		return true;
+	}
+	}
+	return false;
+}
+
+
+// Per-thread scratch space for the text rendering of a structured message
+inline std::string &textBuffer()
+{
+	thread_local std::string buffer;
+	return buffer;
+}
+
+
+// Fields of the message the calling thread is currently handing to the sinks; empty for plain messages
+inline std::string_view &currentFieldsSlot()
+{
+	thread_local std::string_view fields;
+	return fields;
+}
+
+inline std::string_view currentFields()
+{
+	return currentFieldsSlot();
+}
+
+
+/*
+ *	@brief		Makes the fields visible to formatters through currentFields() while the message is written
+ */
+class ScopedFields
+{
+public:
+	explicit ScopedFields(std::string_view fields) : mPrevious(currentFieldsSlot()) { currentFieldsSlot() = fields; }
+	~ScopedFields() { currentFieldsSlot() = mPrevious; }
+
+	ScopedFields(const ScopedFields &)			  = delete;
+	ScopedFields &operator=(const ScopedFields &) = delete;
+
+private:
+	std::string_view mPrevious;
+};
+
+} // namespace kv
+
+
+// Hands a message with encoded key-value fields to the text sinks
+void logStructured(LogLevel level, const char *file, int line, const char *function, std::string_view message, std::string_view fields);
+
+
+/*
+ *	@brief		Structured log call: message followed by key, value pairs. The message and the encoded fields
+ *				travel separately: text formatters append the fields as " key=value", the JSON Lines output
+ *				writes them as typed members. The binary output stores the text form.
+ */
+template <typename... KeyValues>
+void logKeyValues(const CallSite &site, std::string_view message, const KeyValues &...keyValues)
+{
+	static_assert(sizeof...(KeyValues) % 2 == 0, "LOG_*_KV expects a message followed by key, value pairs");
+
+	if (site.level >= minimumTextLevel.load(std::memory_order_relaxed))
+	{
+		auto &fields = binary::encodeBuffer();
+		fields.clear();
+		kv::encodeFields(fields, keyValues...);
+		logStructured(site.level, site.file, site.line, site.function, message, fields);
+	}
+
+	if (site.level >= minimumBinaryLevel.load(std::memory_order_relaxed))
+	{
+		auto &text = kv::textBuffer();
+		text.assign(message);
+		kv::appendTextFields(text, keyValues...);
+		writeBinary(site, binary::Preformatted, binary::encodeArgs(std::string_view(text)));
+	}
+}
+
+} // namespace logging
@@ -1,49 +1,75 @@
 /*
-  ==============================================================================
-
+==============================================================================
 	Module			LoggerRegistry
-	Description		Singleton of the Logger Registry
-
-  ==============================================================================
+	Description		Named loggers with their own outputs and level
+==============================================================================
 */
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <vector>
+#include <string_view>
 
-#include <spdlog/spdlog.h>
-#include <spdlog/sinks/base_sink.h>
-#include <spdlog/sinks/dup_filter_sink.h>
 #include <spdlog/logger.h>
 
-#include "Helper.h"
+#include "LoggerWrapper.h"
+#include "SinkList.h"
+
+
+/*
+ *	@brief		State behind a logging::Logger handle: the logger's own sink list and the threshold its handle
+ *				checks. The threshold combines the logger's level with the lowest level any of its outputs
+ *				accepts, so a logger without outputs rejects every message before it is formatted.
+ */
+struct NamedLogger
+{
+	explicit NamedLogger(const std::string &name);
+
+	std::shared_ptr<SinkList>		sinks;
+	std::shared_ptr<spdlog::logger> logger;
+	std::atomic<LogLevel>			threshold{LogLevel::Off};
+	LogLevel						level = LogLevel::Trace; // Set with Logger::setLevel, guarded by the registry
+};
 
 
+/*
+ *	@brief		Named loggers, created on first use and kept for the registry's lifetime, so a handle resolved
+ *				once stays valid and logging through it never looks up the name again.
+ */
 class LoggerRegistry
 {
 public:
-	static LoggerRegistry &sInstance()
-	{
-		static LoggerRegistry instance;
-		return instance;
-	}
+	LoggerRegistry() = default;
 
-	std::vector<spdlog::sink_ptr> &sinks()	{return mSinks;}
+	LoggerRegistry(const LoggerRegistry &)			  = delete;
+	LoggerRegistry &operator=(const LoggerRegistry &) = delete;
 
-	LogLevel &defaultLogLevel()	{return mDefaultLogLevel;}
+	// Logger with this name, created without outputs on first use
+	NamedLogger &get(std::string_view name);
 
-private:
-	LoggerRegistry()												= default;
+	void		 setLevel(NamedLogger &logger, LogLevel level);
+
+	// Replaces all logger levels at once; loggers not listed go back to Trace
+	void		 configure(const std::map<std::string, LogLevel, std::less<>> &levels);
 
-	~LoggerRegistry()												= default;
-	
-	LoggerRegistry(const LoggerRegistry &)							= delete;
-	
-	LoggerRegistry				 &operator=(const LoggerRegistry &) = delete;
+	// Republishes the threshold after the logger's outputs or their levels changed
+	void		 publish(NamedLogger &logger);
 
-	std::vector<spdlog::sink_ptr> mSinks;
+	// Logger that holds the output with this handle, or nullptr
+	NamedLogger *ownerOf(uint64_t handle);
+
+	// Calls `visit` with the name of every logger, in name order
+	void		 forEach(const std::function<void(const std::string &, NamedLogger &)> &visit);
+
+private:
+	void											  publishLocked(NamedLogger &logger);
 
-	LogLevel					  mDefaultLogLevel = {LogLevel::Info};
+	std::mutex										  mMutex;
+	std::map<std::string, std::unique_ptr<NamedLogger>, std::less<>> mLoggers;
 };
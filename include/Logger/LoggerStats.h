@@ -0,0 +1,135 @@
+/*
+==============================================================================
+	Module			LoggerStats
+	Description		Counters and latency histograms of the logging pipeline itself
+==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <spdlog/common.h>
+
+#include "LoggerWrapper.h"
+
+
+/*
+ *	@brief		HDR-style latency histogram in nanoseconds: values below 8 have a bucket each, above that every
+ *				power of two is split into 8 buckets, so a bucket's upper bound is within 12.5% of any value
+ *				in it. Values beyond ~9 minutes land in the last bucket. The exact maximum is kept on the side.
+ */
+class LatencyHistogram
+{
+public:
+	static constexpr size_t SubBuckets = 8;
+	static constexpr size_t Buckets	   = SubBuckets + 37 * SubBuckets; // Powers of two 2^3 .. 2^39
+
+	using Counts					   = std::array<uint64_t, Buckets>;
+
+	void			record(uint64_t ns) noexcept;
+
+	// Single-writer variant: only the owning thread records, so no read-modify-write is needed
+	void			recordOwned(uint64_t ns) noexcept;
+
+	// Adds this histogram's counts to `counts` and raises `max` to its maximum
+	void			addTo(Counts &counts, uint64_t &max) const noexcept;
+
+	static size_t	bucketOf(uint64_t ns) noexcept;
+
+	// Highest value that falls into the bucket
+	static uint64_t upperBoundOf(size_t bucket) noexcept;
+
+	static logging::LatencyStats summarize(const Counts &counts, uint64_t max) noexcept;
+
+private:
+	std::array<std::atomic<uint64_t>, Buckets> mCounts{};
+	std::atomic<uint64_t>					   mMax{0};
+};
+
+
+/*
+ *	@brief		Self-metrics of the logger, collected by logging::stats().
+ *				Messages, filtered messages and format latency are counted in one cache-line aligned block per
+ *				thread that only that thread writes, so counting never makes threads contend; stats() sums the
+ *				blocks. A block is handed to the next new thread once its thread exits, so counts never reset.
+ *				Each output's counters live in one block shared by the threads writing to it; those threads
+ *				already take the output's own lock, so the counters add no contention of their own.
+ *				Latency is only measured for one in every LatencySampleInterval writes of a thread, which keeps
+ *				the clock reads off most messages.
+ */
+class LoggerStats
+{
+public:
+	static constexpr uint64_t LatencySampleInterval = 16;
+
+	class Format;
+
+	// Counters of one output
+	struct alignas(64) Output
+	{
+		std::atomic<uint64_t> writes{0};
+		std::atomic<uint64_t> bytes{0};
+		LatencyHistogram	  writeLatency; // Time spent in the output beyond formatting
+	};
+
+	/*
+	 *	@brief		Counts one message handed to an output (in SinkList). Formatters and sinks running inside it
+	 *				report the bytes they produced, and on sampled writes the formatting time, which is taken out
+	 *				of the output's write latency.
+	 */
+	class Write
+	{
+	public:
+		explicit Write(Output &output) noexcept;
+		~Write();
+
+		Write(const Write &)			= delete;
+		Write &operator=(const Write &) = delete;
+
+	private:
+		Output	&mOutput;
+		Write	*mOuter;
+		uint64_t mBytes		= 0;
+		uint64_t mFormatNs	= 0;
+		uint64_t mStartNs	= 0; // 0 unless this write is sampled
+
+		friend class LoggerStats;
+		friend class Format;
+	};
+
+	// Counts what a formatter appends to `dest` and times it on sampled writes; does nothing outside of a Write
+	class Format
+	{
+	public:
+		explicit Format(const spdlog::memory_buf_t &dest) noexcept;
+		~Format();
+
+		Format(const Format &)			  = delete;
+		Format &operator=(const Format &) = delete;
+
+	private:
+		const spdlog::memory_buf_t &mDest;
+		size_t						mBegin;
+		uint64_t					mStartNs = 0;
+	};
+
+	static void countMessage(LogLevel level) noexcept;
+
+	// A message rejected by the logger's level or by the level of every output
+	static void countFiltered() noexcept;
+
+	static void countRotation() noexcept;
+
+	// Bytes written by the output of the current Write, for outputs that keep messages without formatting them
+	static void countBytes(size_t bytes) noexcept;
+
+	// Sums the per-thread blocks into `stats`; outputs and async figures are filled in by the caller
+	static void collect(logging::Stats &stats);
+
+	static void addOutput(logging::Stats &stats, const Output &output, OutputHandle handle, const std::string &name, const std::string &logger);
+};
@@ -7,8 +7,14 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
 
 enum class LogLevel
 {
@@ -17,7 +23,48 @@ enum class LogLevel
 	Info,
 	Warn,
 	Error,
-	Critical
+	Critical,
+	Off
+};
+
+
+/*
+ *	@brief		What an asynchronous logger does when its queue is full
+ */
+enum class OverflowPolicy
+{
+	Block,		// Wait until the writer thread frees a slot
+	DropNewest, // Discard the message being logged
+	DropOldest	// Discard the oldest queued message to make room
+};
+
+
+/*
+ *	@brief		How logging threads hand messages to the asynchronous writer thread
+ */
+enum class AsyncMode
+{
+	SharedQueue, // One lock-free queue shared by all threads
+	PerThread	 // One ring per logging thread, merged by timestamp; producers never contend
+};
+
+
+/*
+ *	@brief		Compression applied to the files a file output rotates away
+ */
+enum class Codec
+{
+	None, // Rotated files stay plain text: app.1.log, app.2.log, ...
+	LZ4	  // Rotated files are LZ4 frames compressed in the background: app.1.log.lz4, ... (readable with `lz4 -d`)
+};
+
+
+/*
+ *	@brief		Identifies an output added at runtime, so it can be removed again with removeOutput().
+ */
+enum class OutputHandle : uint64_t
+{
+	Invalid = 0 // Returned when no output was added (e.g. the MSVC output outside Windows)
 };
 
 
@@ -37,20 +84,235 @@ inline constexpr unsigned long long operator""_MB(unsigned long long value)
 
 using namespace filesize;
 
+struct NamedLogger; // Defined in LoggerRegistry.h
+
 namespace logging
 {
 
 class LoggerImpl;
 
-void addConsoleOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &pattern = "[%Y-%m-%d %H:%M:%S.%e] [%l] %v");
 
-void addFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles, bool rotateOnSession);
+/*
+ *	@brief		Lowest level accepted by any registered sink. Kept up to date by LoggerImpl when sinks are
+ *				added, so the LOG_* macros can reject a message before its arguments are formatted.
+ */
+inline std::atomic<LogLevel> minimumLevel{LogLevel::Info};
+
+// Split of minimumLevel by output kind: text sinks get formatted messages, the binary output raw arguments
+inline std::atomic<LogLevel> minimumTextLevel{LogLevel::Info};
+inline std::atomic<LogLevel> minimumBinaryLevel{LogLevel::Off};
+
+// Level of categories without one of their own, which call sites without a category follow as well. Trace unless set.
+inline std::atomic<LogLevel> defaultCategoryLevel{LogLevel::Trace};
+
+// Set once asynchronous mode formats messages on its writer thread, see AsyncOptions::setDeferFormatting()
+inline std::atomic<bool>	 deferredFormatting{false};
+
+/*
+ *	@brief		Layout of text outputs that are not given a pattern, in spdlog's pattern syntax:
+ *				time, thread id, level, source file, function and message in fixed-width columns.
+ *				Outputs using it run a hand-written formatter instead of the compiled pattern.
+ */
+inline constexpr char		 DefaultPattern[] = "%Y-%m-%d %H:%M:%S.%e   %8t %-8!l %-20!s %-45!! %v";
+
+// Whether a call site without a category logs at this level: an output and the default category level must accept it
+inline bool					 isEnabled(LogLevel level) noexcept
+{
+	return level >= minimumLevel.load(std::memory_order_relaxed) && level >= defaultCategoryLevel.load(std::memory_order_relaxed);
+}
+
+
+/*
+ *	@brief		Handle of a named logger, resolved once with logging::get(). A named logger has its own outputs
+ *				and level, separate from the default logger the LOG_* macros write to, so a high-rate component
+ *				can log to a cheaper set of outputs. Logging through the handle (LOG_*_TO) checks the level with
+ *				one atomic load and never looks up the name. Named loggers always write on the calling thread.
+ *				Handles are cheap to copy and stay valid until the process ends. A default-constructed handle
+ *				logs to the default logger.
+ */
+class Logger
+{
+public:
+	Logger() = default;
+
+	bool isEnabled(LogLevel level) const noexcept { return level >= mThreshold->load(std::memory_order_relaxed); }
+
+	// Level of the logger itself, Trace until set, which leaves filtering to its outputs. Not available for the default logger.
+	void setLevel(LogLevel level) const;
+
+	// Like logging::log(), for this logger's outputs
+	void log(LogLevel level, const char *file, int line, const char *function, std::string_view msg) const;
 
-void addMSVCOutput(LogLevel level, bool checkForDebuggerPresent, std::chrono::microseconds maxSkipDuration);
+private:
+	friend class LoggerImpl;
+
+	Logger(NamedLogger *logger, const std::atomic<LogLevel> *threshold) : mLogger(logger), mThreshold(threshold) {}
+
+	NamedLogger					*mLogger	= nullptr;
+	const std::atomic<LogLevel> *mThreshold = &minimumTextLevel;
+};
+
+
+// Logger with this name, created without outputs on first use. Resolve it once and keep the handle.
+Logger		 get(std::string_view name);
+
+
+// The `logger` argument adds the output to a named logger instead of the default one
+
+OutputHandle addConsoleOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &pattern = DefaultPattern, const Logger &logger = Logger());
+
+OutputHandle addFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles, bool rotateOnSession,
+						   LogLevel flushLevel = LogLevel::Error, std::chrono::milliseconds flushInterval = std::chrono::milliseconds(0), size_t writeBatchBytes = 4_KB,
+						   Codec compressOnRotate = Codec::None, std::chrono::seconds rotateInterval = std::chrono::seconds(0), const std::string &pattern = DefaultPattern,
+						   const Logger &logger = Logger());
+
+OutputHandle addMSVCOutput(LogLevel level, bool checkForDebuggerPresent, std::chrono::microseconds maxSkipDuration, const Logger &logger = Logger());
+
+OutputHandle addMmapFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles,
+							   const std::string &pattern = DefaultPattern, const Logger &logger = Logger());
+
+OutputHandle addJsonFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles,
+							   const Logger &logger = Logger());
+
+OutputHandle addRingBufferOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, size_t capacity, const std::string &crashDumpFile = "",
+								 const Logger &logger = Logger());
+
+/*
+ *	@brief		Writes the records kept by the ring buffer output to `fileName`, oldest first, and returns how
+ *				many were written. Uses the most recently added ring buffer output; throws std::logic_error
+ *				if there is none. A removed ring buffer output no longer records but can still be dumped.
+ */
+size_t		 dumpRing(const std::string &fileName);
+
+/*
+ *	@brief		Removes an output while the process keeps logging. Messages already on their way to a text
+ *				output are still written; the output is closed once the last of them is done. The binary
+ *				output is flushed and closed right away.
+ *				Returns false if the handle is unknown or was removed before.
+ */
+bool		 removeOutput(OutputHandle handle);
+
+// Changes the level of an output while the process keeps logging. Returns false if the handle is unknown.
+bool		 setOutputLevel(OutputHandle handle, LogLevel level);
 
 void initializeLogger(const std::string &configFilePath);
 
-void log(LogLevel level, const std::string &file, int line, const std::string &function, const std::string &msg);
+/*
+ *	@brief		Configures the logger from the JSON file like initializeLogger() and keeps watching the file.
+ *				When it changes, only the difference is applied on a background thread: outputs whose
+ *				settings changed are replaced, level changes are applied to the running output, and added
+ *				and removed entries are created and closed. Logging threads are never blocked and messages
+ *				already on their way to a replaced output are still written. An invalid file is reported on
+ *				stderr and the current configuration is kept. The async section is only read on the first load.
+ */
+void watchConfig(const std::string &configFilePath);
+
+
+/*
+ *	@brief		Level of a named category, used by the LOG_*_CAT macros and in translation units that define
+ *				LOGGER_CATEGORY. Messages of a category are logged if they reach both its level and the level
+ *				of an output, so a single subsystem can be traced while the others stay at Info.
+ */
+void				   setCategoryLevel(std::string_view category, LogLevel level);
+
+// Level of categories without a level of their own, and of call sites without a category. Trace by default,
+// which leaves filtering to the outputs.
+void				   setDefaultCategoryLevel(LogLevel level);
+
+// Threshold a category's call sites check. Resolved once per call site by the macros.
+std::atomic<LogLevel> &categoryThreshold(std::string_view category);
+
+void enableAsync(size_t queueSize, OverflowPolicy overflowPolicy, AsyncMode mode = AsyncMode::SharedQueue, bool deferFormatting = false);
+
+size_t droppedMessages();
+
+
+/*
+ *	@brief		Latency distribution in nanoseconds. Percentiles are reported as the upper bound of their
+ *				histogram bucket, at most 12.5% above the measured value; max is exact.
+ */
+struct LatencyStats
+{
+	uint64_t samples = 0;
+	uint64_t p50	 = 0;
+	uint64_t p90	 = 0;
+	uint64_t p99	 = 0;
+	uint64_t p999	 = 0;
+	uint64_t max	 = 0;
+};
+
+// Counters of one text output
+struct OutputStats
+{
+	OutputHandle handle = OutputHandle::Invalid;
+	std::string	 name;	 // Kind of output and its file, e.g. "file app.log"
+	std::string	 logger; // Named logger the output belongs to, empty for the default logger
+	uint64_t	 writes = 0;
+	uint64_t	 bytes	= 0;
+	LatencyStats writeLatency; // Time spent in the output, formatting excluded
+};
+
+/*
+ *	@brief		Snapshot of the logger's own counters, returned by logging::stats(). Counts are totals since
+ *				the process started; outputs that were removed are no longer listed. Latencies are measured
+ *				for one in every 16 writes of each thread.
+ */
+struct Stats
+{
+	std::array<uint64_t, 6>	 messages{}; // Messages logged, indexed by LogLevel from Trace to Critical
+	uint64_t				 filtered = 0; // Rejected by the logger's level or by the level of every output
+	bool					 async		= false;
+	uint64_t				 queueDepth = 0; // Messages waiting for the async writer thread
+	uint64_t				 dropped	= 0; // Messages the async queue discarded on overflow
+	uint64_t				 rotations	= 0; // File rotations of all file outputs
+	LatencyStats			 formatLatency;
+	std::vector<OutputStats> outputs;
+
+	// One line per figure, for a log message or a console
+	std::string				 toText() const;
+
+	std::string				 toJson() const;
+};
+
+/*
+ *	@brief		Collects the logger's self-metrics. Logging threads count into cache-line aligned blocks of
+ *				their own, so collecting never blocks or slows them down.
+ */
+Stats stats();
+
+// Only one binary output can exist at a time; adding a second one throws until the first is removed
+OutputHandle addBinaryFileOutput(LogLevel level, const std::string &fileName);
+
+
+/*
+ *	@brief		Static description of a LOG_* call site. Each call site owns one with static storage, so its
+ *				address identifies the call site for the binary output.
+ */
+struct CallSite
+{
+	LogLevel		 level;
+	const char		*file;
+	int				 line;
+	const char		*function;
+	std::string_view format;
+};
+
+/*
+ *	@brief		Entry point used by the LOG_* macros. Nothing is copied on the way to the sinks: file and
+ *				function are kept by pointer and must be string literals (__FILE__, __FUNCTION__) or
+ *				otherwise outlive the logger.
+ */
+void log(LogLevel level, const char *file, int line, const char *function, std::string_view msg);
+
+/*
+ *	@brief		Entry point for callers whose file or function name is not a literal (the signature taking
+ *				std::string before the LOG_* macros moved to the overload above). File and function are
+ *				copied once per distinct name and kept for the life of the process, so a temporary
+ *				std::string is safe here even with asynchronous logging. A repeated name is found in a
+ *				per-thread cache without locking or allocating; pass names from a bounded set, since
+ *				every distinct one stays in memory.
+ */
+void log(LogLevel level, std::string_view file, int line, std::string_view function, std::string_view msg);
 
 
 /*
@@ -66,48 +328,165 @@ public:
 		return static_cast<LogOutput &>(*this);
 	}
 
+	// Suppress a message repeating the previous one (same call site and text) within this duration. 0 disables it.
 	LogOutput &setMaxSkipDuration(std::chrono::microseconds maxSkipDuration) noexcept
 	{
 		this->maxSkipDuration = maxSkipDuration;
 		return static_cast<LogOutput &>(*this);
 	}
 
+	// Receives the handle of the output once it is created, for a later removeOutput()
+	LogOutput &storeHandleIn(OutputHandle &handle) noexcept
+	{
+		this->handleTarget = &handle;
+		return static_cast<LogOutput &>(*this);
+	}
+
+	// Adds the output to a named logger instead of the default one
+	LogOutput &setLogger(const Logger &logger) noexcept
+	{
+		this->logger = logger;
+		return static_cast<LogOutput &>(*this);
+	}
+
 protected:
+	void keepHandle(OutputHandle handle) noexcept
+	{
+		if (handleTarget)
+			*handleTarget = handle;
+	}
+
 	LogLevel				  level = LogLevel::Info;
-	std::chrono::microseconds maxSkipDuration;
+	std::chrono::microseconds maxSkipDuration{0};
+	OutputHandle			 *handleTarget = nullptr;
+	Logger					  logger;
 };
 
 
 /*
- *	@brief		Options to create a console output sink
+ *	@brief		Options to create a console output sink. The pattern (spdlog syntax, see DefaultPattern) is
+ *				compiled once when the output is created; %^ and %$ mark the part that is colored by level.
  */
 struct ConsoleOptions : Options<ConsoleOptions>
 {
 	ConsoleOptions()							= default;
 	ConsoleOptions(const ConsoleOptions &other) = delete;
-	~ConsoleOptions() { logging::addConsoleOutput(level, maxSkipDuration); }
+	~ConsoleOptions() { keepHandle(logging::addConsoleOutput(level, maxSkipDuration, pattern, logger)); }
+
+	ConsoleOptions &setPattern(const std::string &pattern);
+
+private:
+	std::string pattern = DefaultPattern;
 };
 
 
 /*
- *	@brief		Options to create a file output sink
+ *	@brief		Options to create a file output sink.
+ *				Lines are gathered and written in batches of writeBatchBytes. The batch is written out right
+ *				away for messages at or above flushLevel (Error and Critical always), every flushInterval if
+ *				set, and whenever the logger is flushed.
+ *				The file is rotated when the next line would exceed maxFileSize and, if a rotate interval is
+ *				set, before the first line past each multiple of the interval (counted in UTC from the epoch,
+ *				so std::chrono::hours(1) rotates on the hour). With compressOnRotate, rotated files are
+ *				compressed on a background thread; logging only waits for one rename.
  */
 struct FileOptions : Options<FileOptions>
 {
 	FileOptions()						  = default;
 	FileOptions(const FileOptions &other) = delete;
-	~FileOptions() { logging::addFileOutput(level, maxSkipDuration, filename, maxFileSize, maxFiles, rotateOnSession); }
+	~FileOptions()
+	{
+		keepHandle(logging::addFileOutput(level, maxSkipDuration, filename, maxFileSize, maxFiles, rotateOnSession, flushLevel, flushInterval, writeBatchBytes, compressOnRotate,
+										  rotateInterval, pattern, logger));
+	}
 
 	FileOptions &setFilename(const std::string &filename);
 	FileOptions &setMaxFileSize(size_t maxFileSize);
 	FileOptions &setMaxFiles(size_t maxFiles);
 	FileOptions &setRotateOnSession(bool rotateOnSession);
+	FileOptions &setFlushLevel(LogLevel flushLevel);
+	FileOptions &setFlushInterval(std::chrono::milliseconds flushInterval);
+	FileOptions &setWriteBatchBytes(size_t writeBatchBytes);
+	FileOptions &setCompressOnRotate(Codec codec);
+	FileOptions &setRotateInterval(std::chrono::seconds rotateInterval);
+	FileOptions &setPattern(const std::string &pattern);
+
+private:
+	std::string				  filename		  = "";
+	size_t					  maxFileSize	  = 10_MB;
+	size_t					  maxFiles		  = 3;
+	bool					  rotateOnSession = false;
+	LogLevel				  flushLevel	  = LogLevel::Error;
+	std::chrono::milliseconds flushInterval{0};
+	size_t					  writeBatchBytes = 4_KB;
+	Codec					  compressOnRotate = Codec::None;
+	std::chrono::seconds	  rotateInterval{0};
+	std::string				  pattern = DefaultPattern;
+};
+
+
+/*
+ *	@brief		Options to create a memory-mapped file output. Each file is preallocated to maxFileSize and
+ *				written through a shared mapping, so logging makes no system calls until a file is full and
+ *				written lines survive a process crash. Falls back to the rotating file output on Windows.
+ */
+struct MmapFileOptions : Options<MmapFileOptions>
+{
+	MmapFileOptions()							  = default;
+	MmapFileOptions(const MmapFileOptions &other) = delete;
+	~MmapFileOptions() { keepHandle(logging::addMmapFileOutput(level, maxSkipDuration, filename, maxFileSize, maxFiles, pattern, logger)); }
+
+	MmapFileOptions &setFilename(const std::string &filename);
+	MmapFileOptions &setMaxFileSize(size_t maxFileSize);
+	MmapFileOptions &setMaxFiles(size_t maxFiles);
+	MmapFileOptions &setPattern(const std::string &pattern);
 
 private:
-	std::string filename		= "";
-	size_t		maxFileSize		= 10_MB;
-	size_t		maxFiles		= 3;
-	bool		rotateOnSession = false;
+	std::string filename	= "";
+	size_t		maxFileSize = 10_MB;
+	size_t		maxFiles	= 3;
+	std::string pattern		= DefaultPattern;
+};
+
+
+/*
+ *	@brief		Options to create a JSON Lines file output: one JSON object per message, with the typed fields
+ *				of LOG_*_KV calls as members. Written and rotated like the file output.
+ */
+struct JsonFileOptions : Options<JsonFileOptions>
+{
+	JsonFileOptions()							  = default;
+	JsonFileOptions(const JsonFileOptions &other) = delete;
+	~JsonFileOptions() { keepHandle(logging::addJsonFileOutput(level, maxSkipDuration, filename, maxFileSize, maxFiles, logger)); }
+
+	JsonFileOptions &setFilename(const std::string &filename);
+	JsonFileOptions &setMaxFileSize(size_t maxFileSize);
+	JsonFileOptions &setMaxFiles(size_t maxFiles);
+
+private:
+	std::string filename	= "";
+	size_t		maxFileSize = 10_MB;
+	size_t		maxFiles	= 3;
+};
+
+
+/*
+ *	@brief		Options to create a ring buffer output: a flight recorder keeping the last `capacity` records
+ *				(rounded up to a power of two) in memory. Records are written out by dumpRing() and, if a
+ *				crash dump file is set, when the process crashes. Accepts every level unless set otherwise.
+ */
+struct RingBufferOptions : Options<RingBufferOptions>
+{
+	RingBufferOptions() { level = LogLevel::Trace; }
+	RingBufferOptions(const RingBufferOptions &other) = delete;
+	~RingBufferOptions() { keepHandle(logging::addRingBufferOutput(level, maxSkipDuration, capacity, crashDumpFile, logger)); }
+
+	RingBufferOptions &setCapacity(size_t capacity);
+	RingBufferOptions &setCrashDumpFile(const std::string &crashDumpFile);
+
+private:
+	size_t		capacity	  = 4096;
+	std::string crashDumpFile = "";
 };
 
 
@@ -119,7 +498,7 @@ struct MSVCOptions : Options<MSVCOptions>
 public:
 	MSVCOptions()						  = default;
 	MSVCOptions(const MSVCOptions &other) = delete;
-	~MSVCOptions() { logging::addMSVCOutput(level, checkForDebugger, maxSkipDuration); }
+	~MSVCOptions() { keepHandle(logging::addMSVCOutput(level, checkForDebugger, maxSkipDuration, logger)); }
 
 	MSVCOptions &checkForPresentDebugger(bool check);
 
@@ -128,10 +507,82 @@ private:
 };
 
 
+/*
+ *	@brief		Options to switch the logger into asynchronous mode.
+ *				Messages are queued and written to the sinks by a background thread. Has no effect once
+ *				asynchronous mode is already running. In PerThread mode the queue size applies to each thread.
+ *				With deferred formatting, LOG_* calls copy their arguments instead of formatting them and the
+ *				writer thread runs std::format. Strings are copied; numbers, enums, void pointers and std::chrono
+ *				values are copied as their bytes, as are types opted in with logging::deferred::CaptureAsBytes.
+ *				Calls with other argument types are still formatted by the caller.
+ */
+struct AsyncOptions
+{
+public:
+	AsyncOptions()							= default;
+	AsyncOptions(const AsyncOptions &other) = delete;
+	~AsyncOptions() { logging::enableAsync(queueSize, overflowPolicy, mode, deferFormatting); }
+
+	AsyncOptions &setQueueSize(size_t queueSize);
+	AsyncOptions &setOverflowPolicy(OverflowPolicy overflowPolicy);
+	AsyncOptions &setMode(AsyncMode mode);
+	AsyncOptions &setDeferFormatting(bool deferFormatting);
+
+private:
+	size_t		   queueSize	   = 8192;
+	OverflowPolicy overflowPolicy  = OverflowPolicy::Block;
+	AsyncMode	   mode			   = AsyncMode::SharedQueue;
+	bool		   deferFormatting = false;
+};
+
+
+/*
+ *	@brief		Options to create a binary file output. Records hold the call site id and the raw arguments
+ *				instead of formatted text; the logdecode tool turns the file back into the regular log lines.
+ */
+struct BinaryFileOptions
+{
+public:
+	BinaryFileOptions()								= default;
+	BinaryFileOptions(const BinaryFileOptions &other) = delete;
+	~BinaryFileOptions()
+	{
+		auto handle = logging::addBinaryFileOutput(level, filename);
+		if (handleTarget)
+			*handleTarget = handle;
+	}
+
+	BinaryFileOptions &setFilename(const std::string &filename);
+	BinaryFileOptions &setLevel(LogLevel level);
+
+	// Receives the handle of the output once it is created, for a later removeOutput()
+	BinaryFileOptions &storeHandleIn(OutputHandle &handle) noexcept
+	{
+		handleTarget = &handle;
+		return *this;
+	}
+
+private:
+	std::string	  filename	   = "";
+	LogLevel	  level		   = LogLevel::Info;
+	OutputHandle *handleTarget = nullptr;
+};
+
+
 ConsoleOptions addConsoleOutput();
 
 FileOptions	   addFileOutput();
 
 MSVCOptions	   addMSVCOutput();
 
+MmapFileOptions addMmapFileOutput();
+
+JsonFileOptions addJsonFileOutput();
+
+RingBufferOptions addRingBufferOutput();
+
+AsyncOptions   enableAsync();
+
+BinaryFileOptions addBinaryFileOutput();
+
 }; // namespace logging
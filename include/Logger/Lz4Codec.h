@@ -0,0 +1,35 @@
+/*
+==============================================================================
+	Module			Lz4Codec
+	Description		Built-in LZ4 frame compression for rotated log files
+==============================================================================
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+
+/*
+ *	@brief		Writes and reads the LZ4 frame format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md),
+ *				so rotated files can be read with the stock `lz4 -d` or `unlz4`. Blocks are independent and
+ *				4 MB at most; frames carry no checksums. The compressor is a plain greedy matcher: log text
+ *				is repetitive enough that it shrinks several times without the search of the reference encoder.
+ *				All functions throw std::runtime_error on I/O errors and malformed input.
+ */
+namespace lz4
+{
+
+inline constexpr std::string_view FileExtension = ".lz4";
+
+std::string						  compress(std::string_view data);
+
+std::string						  decompress(std::string_view frame);
+
+// Streams `source` into a new LZ4 frame at `target`, replacing it if it exists
+void							  compressFile(const std::string &source, const std::string &target);
+
+void							  decompressFile(const std::string &source, const std::string &target);
+
+} // namespace lz4
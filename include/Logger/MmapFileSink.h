@@ -0,0 +1,88 @@
+/*
+==============================================================================
+	Module			MmapFileSink
+	Description		File sink writing into memory-mapped, preallocated segments
+==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <spdlog/sinks/sink.h>
+
+
+/*
+ *	@brief		Writes log lines into a memory-mapped file of maxFileSize bytes, preallocated up front.
+ *				Writers reserve their range with an atomic bump of the write offset and copy the line in,
+ *				so the common case takes no lock and makes no system call. The kernel owns the mapped pages:
+ *				what was written survives a crash of the process.
+ *				A full segment is cut to its used length and rotated like the rotating file sink
+ *				(app.log -> app.1.log ...), then writing continues in a fresh app.log. An existing app.log is
+ *				rotated away on startup. After a crash the last file still has its zero-filled tail.
+ */
+class MmapFileSink : public spdlog::sinks::sink
+{
+public:
+	MmapFileSink(std::string fileName, size_t maxFileSize, size_t maxFiles);
+
+	// Cuts the current segment to its used length and unmaps it
+	~MmapFileSink() override;
+
+	MmapFileSink(const MmapFileSink &)			  = delete;
+	MmapFileSink &operator=(const MmapFileSink &) = delete;
+
+	void		  log(const spdlog::details::log_msg &msg) override;
+
+	// The mapped pages already belong to the kernel; there is nothing to hand over
+	void		  flush() override {}
+
+	void		  set_pattern(const std::string &pattern) override;
+
+	void		  set_formatter(std::unique_ptr<spdlog::formatter> sinkFormatter) override;
+
+private:
+	struct Segment
+	{
+		char			   *base = nullptr;
+		size_t				size = 0;
+		int					fd	 = -1;
+		std::atomic<size_t> offset{0}; // Next free byte; may run past size once the segment is full
+		std::atomic<int>	users{0};  // Writers currently copying into the mapping
+		bool				closed = false;
+	};
+
+	// The sink's formatter and the copies threads format with, shared with the threads' caches
+	struct Formatters;
+
+	// Thread's copy of the formatter, so formatting needs no lock either
+	spdlog::formatter &threadFormatter();
+
+	// Writes the formatted line, rolling over to a new segment as often as needed
+	void			   append(const char *data, size_t length);
+
+	// Called by the writer whose reservation crossed the end of `full`, which was reserved up to `usedLength`
+	void			   rollOver(Segment *full, size_t usedLength, size_t minimumSize);
+
+	Segment			  *openSegment(size_t size);
+
+	void			   closeSegment(Segment &segment, size_t usedLength);
+
+	void			   rotateFiles();
+
+	const std::string					  mFileName;
+	const size_t						  mSegmentSize;
+	const size_t						  mMaxFiles;
+
+	std::atomic<Segment *>				  mCurrent{nullptr};
+	std::vector<std::unique_ptr<Segment>> mSegments; // Never freed while the sink lives, a writer may still probe a closed one
+	std::vector<Segment *>				  mClosed;	 // Reused by the next rollover, so mSegments stays at a few entries
+	std::mutex							  mSegmentsMutex;
+
+	std::shared_ptr<Formatters>			  mFormatters;
+};
@@ -8,15 +8,305 @@
 */
 
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <format>
+#include <string>
+#include <string_view>
 #include "LoggerWrapper.h"
+#include "BinaryLog.h"
+#include "DeferredFormat.h"
+#include "KeyValue.h"
 
 
-#define LOG(level, fmtStr, ...)	  logging::log(LogLevel::level, __FILE__, __LINE__, __FUNCTION__, std::format(fmtStr, ##__VA_ARGS__))
+// Numeric values of the LogLevel enum, usable in preprocessor conditions
+#define LOGGER_LEVEL_TRACE	  0
+#define LOGGER_LEVEL_DEBUG	  1
+#define LOGGER_LEVEL_INFO	  2
+#define LOGGER_LEVEL_WARN	  3
+#define LOGGER_LEVEL_ERROR	  4
+#define LOGGER_LEVEL_CRITICAL 5
+#define LOGGER_LEVEL_OFF	  6
 
-#define LOG_TRACE(fmtStr, ...)	  LOG(Trace, fmtStr, ##__VA_ARGS__)
-#define LOG_DEBUG(fmtStr, ...)	  LOG(Debug, fmtStr, ##__VA_ARGS__)
-#define LOG_INFO(fmtStr, ...)	  LOG(Info, fmtStr, ##__VA_ARGS__)
-#define LOG_WARNING(fmtStr, ...)  LOG(Warn, fmtStr, ##__VA_ARGS__)
-#define LOG_ERROR(fmtStr, ...)	  LOG(Error, fmtStr, ##__VA_ARGS__)
-#define LOG_CRITICAL(fmtStr, ...) LOG(Critical, fmtStr, ##__VA_ARGS__)
+// Calls below this level are removed at compile time. Release builds drop Trace and Debug unless overridden.
+#ifndef LOGGER_ACTIVE_LEVEL
+#ifdef NDEBUG
+#define LOGGER_ACTIVE_LEVEL LOGGER_LEVEL_INFO
+#else
+#define LOGGER_ACTIVE_LEVEL LOGGER_LEVEL_TRACE
+#endif
+#endif
+
+static_assert(static_cast<int>(LogLevel::Trace) == LOGGER_LEVEL_TRACE && static_cast<int>(LogLevel::Critical) == LOGGER_LEVEL_CRITICAL && static_cast<int>(LogLevel::Off) == LOGGER_LEVEL_OFF,
+			  "LOGGER_LEVEL_* values must match the LogLevel enum");
+
+
+namespace logging
+{
+
+// Per-thread scratch space for formatted messages. Only ever grows, so steady-state logging does not allocate.
+inline std::string &messageBuffer()
+{
+	thread_local std::string buffer(256, '\0');
+	return buffer;
+}
+
+
+/*
+ *	@brief		Formats a message into the calling thread's message buffer.
+ *				The returned view is valid until the same thread formats its next message.
+ */
+template <typename... Args>
+std::string_view formatMessage(std::format_string<Args...> fmtStr, Args &&...args)
+{
+	auto &buffer = messageBuffer();
+	auto  result = std::format_to_n(buffer.data(), buffer.size(), fmtStr, std::forward<Args>(args)...);
+
+	if (static_cast<size_t>(result.size) > buffer.size())
+	{
+		// Message did not fit: grow once and format again
+		buffer.resize(static_cast<size_t>(result.size));
+		std::format_to_n(buffer.data(), buffer.size(), fmtStr, std::forward<Args>(args)...);
+	}
+
+	return {buffer.data(), static_cast<size_t>(result.size)};
+}
+
+
+/*
+ *	@brief		Hands a message to the text sinks. With deferred formatting, arguments that can be captured are
+ *				copied and formatted by the writer thread; everything else is formatted here.
+ */
+template <typename... Args>
+void logText(const CallSite &site, std::format_string<Args...> fmtStr, Args &&...args)
+{
+	// Without arguments there is nothing to defer
+	if constexpr (sizeof...(Args) > 0 && deferred::allCapturable<Args...>)
+	{
+		if (deferredFormatting.load(std::memory_order_relaxed))
+		{
+			logCaptured(site, deferred::formatCaptured<std::remove_cvref_t<Args>...>, deferred::captureArgs(args...));
+			return;
+		}
+	}
+
+	log(site.level, site.file, site.line, site.function, formatMessage(fmtStr, std::forward<Args>(args)...));
+}
+
+
+/*
+ *	@brief		Hands a message to the text sinks and the binary output, each only if it accepts the level.
+ *				Text sinks get the formatted message, the binary output the raw arguments.
+ */
+template <typename... Args>
+void dispatch(const CallSite &site, std::format_string<Args...> fmtStr, Args &&...args)
+{
+	if (site.level >= minimumTextLevel.load(std::memory_order_relaxed))
+		logText<Args...>(site, fmtStr, std::forward<Args>(args)...);
+
+	if (site.level >= minimumBinaryLevel.load(std::memory_order_relaxed))
+		logBinary<Args...>(site, fmtStr, std::forward<Args>(args)...);
+}
+
+
+// Category of a LOG_*_CAT call site. A call site resolves its category once and keeps it, so the name has to be a
+// compile-time constant (a literal or a constexpr string); anything else fails to compile.
+struct CategoryName
+{
+	consteval CategoryName(const char *name) : value(name) {}
+
+	std::string_view value;
+};
+
+
+// Rate limiting helpers for the LOG_*_EVERY_N / _EVERY_MS / _SAMPLED macros. Each call site owns its state.
+
+// True for the 1st, (n+1)th, (2n+1)th, ... call
+inline bool everyN(std::atomic<uint64_t> &callCount, uint64_t n) noexcept
+{
+	return n <= 1 || callCount.fetch_add(1, std::memory_order_relaxed) % n == 0;
+}
+
+
+// True at most once per interval; the first caller after the interval elapsed wins
+inline bool everyInterval(std::atomic<int64_t> &nextAllowedMs, int64_t intervalMs) noexcept
+{
+	auto now  = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	auto next = nextAllowedMs.load(std::memory_order_relaxed);
+	return now >= next && nextAllowedMs.compare_exchange_strong(next, now + intervalMs, std::memory_order_relaxed);
+}
+
+
+// True with the given probability (0.0 - 1.0), using a per-thread xorshift generator
+inline bool sampled(double probability) noexcept
+{
+	if (probability >= 1.0)
+		return true;
+	if (probability <= 0.0)
+		return false;
+
+	thread_local uint64_t state = 0x9E3779B97F4A7C15ULL ^ reinterpret_cast<uintptr_t>(&state);
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return static_cast<double>(state >> 11) * 0x1.0p-53 < probability;
+}
+
+} // namespace logging
+
+
+// The level checks run before std::format, so filtered-out calls never evaluate or format their arguments.
+// The condition is only evaluated once the level passed. `dispatcher` receives the call site and the arguments.
+#define LOGGER_DISPATCH_IF(level, condition, dispatcher, fmtStr, ...)                                                                                                              \
+	do                                                                                                                                                                             \
+	{                                                                                                                                                                              \
+		if constexpr (static_cast<int>(LogLevel::level) >= LOGGER_ACTIVE_LEVEL)                                                                                                    \
+		{                                                                                                                                                                          \
+			if (logging::isEnabled(LogLevel::level) && (condition))                                                                                                                \
+			{                                                                                                                                                                      \
+				static const logging::CallSite loggerCallSite{LogLevel::level, __FILE__, __LINE__, __FUNCTION__, fmtStr};                                                          \
+				dispatcher(loggerCallSite, fmtStr, ##__VA_ARGS__);                                                                                                                 \
+			}                                                                                                                                                                      \
+		}                                                                                                                                                                          \
+	} while (0)
+
+// Same for a named category. The call site looks up its category once and then only loads the category's
+// threshold, which already includes the lowest level any output accepts. `category` must be a compile-time constant.
+#define LOGGER_DISPATCH_IF_CAT(level, category, condition, dispatcher, fmtStr, ...)                                                                                                \
+	do                                                                                                                                                                             \
+	{                                                                                                                                                                              \
+		if constexpr (static_cast<int>(LogLevel::level) >= LOGGER_ACTIVE_LEVEL)                                                                                                    \
+		{                                                                                                                                                                          \
+			static std::atomic<LogLevel> &loggerCategoryThreshold = logging::categoryThreshold(logging::CategoryName(category).value);                                             \
+			if (LogLevel::level >= loggerCategoryThreshold.load(std::memory_order_relaxed) && (condition))                                                                         \
+			{                                                                                                                                                                      \
+				static const logging::CallSite loggerCallSite{LogLevel::level, __FILE__, __LINE__, __FUNCTION__, fmtStr};                                                          \
+				dispatcher(loggerCallSite, fmtStr, ##__VA_ARGS__);                                                                                                                 \
+			}                                                                                                                                                                      \
+		}                                                                                                                                                                          \
+	} while (0)
+
+// A translation unit that defines LOGGER_CATEGORY (e.g. "net") before including this header logs all its
+// messages in that category
+#ifdef LOGGER_CATEGORY
+#define LOG_IF(level, condition, fmtStr, ...)	LOGGER_DISPATCH_IF_CAT(level, LOGGER_CATEGORY, condition, logging::dispatch, fmtStr, ##__VA_ARGS__)
+#define LOG_KV(level, message, ...)				LOGGER_DISPATCH_IF_CAT(level, LOGGER_CATEGORY, true, logging::logKeyValues, message, ##__VA_ARGS__)
+#else
+#define LOG_IF(level, condition, fmtStr, ...)	LOGGER_DISPATCH_IF(level, condition, logging::dispatch, fmtStr, ##__VA_ARGS__)
+#define LOG_KV(level, message, ...)				LOGGER_DISPATCH_IF(level, true, logging::logKeyValues, message, ##__VA_ARGS__)
+#endif
+
+#define LOG_IF_CAT(level, category, condition, fmtStr, ...) LOGGER_DISPATCH_IF_CAT(level, category, condition, logging::dispatch, fmtStr, ##__VA_ARGS__)
+
+// Same for a named logger handle (logging::get). Its level check is one atomic load on the handle, with no lookup by
+// name. `logger` is evaluated more than once, so pass a variable.
+#define LOG_IF_TO(logger, level, condition, fmtStr, ...)                                                                                                                           \
+	do                                                                                                                                                                             \
+	{                                                                                                                                                                              \
+		if constexpr (static_cast<int>(LogLevel::level) >= LOGGER_ACTIVE_LEVEL)                                                                                                    \
+		{                                                                                                                                                                          \
+			if ((logger).isEnabled(LogLevel::level) && (condition))                                                                                                                \
+				(logger).log(LogLevel::level, __FILE__, __LINE__, __FUNCTION__, logging::formatMessage(fmtStr, ##__VA_ARGS__));                                                    \
+		}                                                                                                                                                                          \
+	} while (0)
+
+#define LOG(level, fmtStr, ...) LOG_IF(level, true, fmtStr, ##__VA_ARGS__)
+
+#define LOG_CAT(level, category, fmtStr, ...) LOG_IF_CAT(level, category, true, fmtStr, ##__VA_ARGS__)
+
+#define LOG_TO(logger, level, fmtStr, ...) LOG_IF_TO(logger, level, true, fmtStr, ##__VA_ARGS__)
+
+
+// Logs the 1st call of this call site and then every n-th
+#define LOG_EVERY_N(level, n, fmtStr, ...)                                                                                                                                         \
+	do                                                                                                                                                                             \
+	{                                                                                                                                                                              \
+		static std::atomic<uint64_t> loggerCallCount{0};                                                                                                                           \
+		LOG_IF(level, logging::everyN(loggerCallCount, (n)), fmtStr, ##__VA_ARGS__);                                                                                               \
+	} while (0)
+
+// Logs at most once per `ms` milliseconds from this call site
+#define LOG_EVERY_MS(level, ms, fmtStr, ...)                                                                                                                                       \
+	do                                                                                                                                                                             \
+	{                                                                                                                                                                              \
+		static std::atomic<int64_t> loggerNextAllowedMs{0};                                                                                                                        \
+		LOG_IF(level, logging::everyInterval(loggerNextAllowedMs, (ms)), fmtStr, ##__VA_ARGS__);                                                                                   \
+	} while (0)
+
+// Logs each call with probability `p` (0.0 - 1.0)
+#define LOG_SAMPLED(level, p, fmtStr, ...) LOG_IF(level, logging::sampled(p), fmtStr, ##__VA_ARGS__)
+
+
+#if LOGGER_ACTIVE_LEVEL <= LOGGER_LEVEL_TRACE
+#define LOG_TRACE(fmtStr, ...)					LOG(Trace, fmtStr, ##__VA_ARGS__)
+#define LOG_TRACE_EVERY_N(n, fmtStr, ...)		LOG_EVERY_N(Trace, n, fmtStr, ##__VA_ARGS__)
+#define LOG_TRACE_EVERY_MS(ms, fmtStr, ...)		LOG_EVERY_MS(Trace, ms, fmtStr, ##__VA_ARGS__)
+#define LOG_TRACE_SAMPLED(p, fmtStr, ...)		LOG_SAMPLED(Trace, p, fmtStr, ##__VA_ARGS__)
+#define LOG_TRACE_CAT(category, fmtStr, ...)	LOG_CAT(Trace, category, fmtStr, ##__VA_ARGS__)
+#define LOG_TRACE_KV(message, ...)				LOG_KV(Trace, message, ##__VA_ARGS__)
+#define LOG_TRACE_TO(logger, fmtStr, ...)		LOG_TO(logger, Trace, fmtStr, ##__VA_ARGS__)
+#else
+#define LOG_TRACE(fmtStr, ...)					(void)0
+#define LOG_TRACE_EVERY_N(n, fmtStr, ...)		(void)0
+#define LOG_TRACE_EVERY_MS(ms, fmtStr, ...)		(void)0
+#define LOG_TRACE_SAMPLED(p, fmtStr, ...)		(void)0
+#define LOG_TRACE_CAT(category, fmtStr, ...)	(void)0
+#define LOG_TRACE_KV(message, ...)				(void)0
+#define LOG_TRACE_TO(logger, fmtStr, ...)		(void)0
+#endif
+
+#if LOGGER_ACTIVE_LEVEL <= LOGGER_LEVEL_DEBUG
+#define LOG_DEBUG(fmtStr, ...)					LOG(Debug, fmtStr, ##__VA_ARGS__)
+#define LOG_DEBUG_EVERY_N(n, fmtStr, ...)		LOG_EVERY_N(Debug, n, fmtStr, ##__VA_ARGS__)
+#define LOG_DEBUG_EVERY_MS(ms, fmtStr, ...)		LOG_EVERY_MS(Debug, ms, fmtStr, ##__VA_ARGS__)
+#define LOG_DEBUG_SAMPLED(p, fmtStr, ...)		LOG_SAMPLED(Debug, p, fmtStr, ##__VA_ARGS__)
+#define LOG_DEBUG_CAT(category, fmtStr, ...)	LOG_CAT(Debug, category, fmtStr, ##__VA_ARGS__)
+#define LOG_DEBUG_KV(message, ...)				LOG_KV(Debug, message, ##__VA_ARGS__)
+#define LOG_DEBUG_TO(logger, fmtStr, ...)		LOG_TO(logger, Debug, fmtStr, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmtStr, ...)					(void)0
+#define LOG_DEBUG_EVERY_N(n, fmtStr, ...)		(void)0
+#define LOG_DEBUG_EVERY_MS(ms, fmtStr, ...)		(void)0
+#define LOG_DEBUG_SAMPLED(p, fmtStr, ...)		(void)0
+#define LOG_DEBUG_CAT(category, fmtStr, ...)	(void)0
+#define LOG_DEBUG_KV(message, ...)				(void)0
+#define LOG_DEBUG_TO(logger, fmtStr, ...)		(void)0
+#endif
+
+#define LOG_INFO(fmtStr, ...)					LOG(Info, fmtStr, ##__VA_ARGS__)
+#define LOG_WARNING(fmtStr, ...)				LOG(Warn, fmtStr, ##__VA_ARGS__)
+#define LOG_ERROR(fmtStr, ...)					LOG(Error, fmtStr, ##__VA_ARGS__)
+#define LOG_CRITICAL(fmtStr, ...)				LOG(Critical, fmtStr, ##__VA_ARGS__)
+
+#define LOG_INFO_EVERY_N(n, fmtStr, ...)		LOG_EVERY_N(Info, n, fmtStr, ##__VA_ARGS__)
+#define LOG_WARNING_EVERY_N(n, fmtStr, ...)		LOG_EVERY_N(Warn, n, fmtStr, ##__VA_ARGS__)
+#define LOG_ERROR_EVERY_N(n, fmtStr, ...)		LOG_EVERY_N(Error, n, fmtStr, ##__VA_ARGS__)
+#define LOG_CRITICAL_EVERY_N(n, fmtStr, ...)	LOG_EVERY_N(Critical, n, fmtStr, ##__VA_ARGS__)
+
+#define LOG_INFO_EVERY_MS(ms, fmtStr, ...)		LOG_EVERY_MS(Info, ms, fmtStr, ##__VA_ARGS__)
+#define LOG_WARNING_EVERY_MS(ms, fmtStr, ...)	LOG_EVERY_MS(Warn, ms, fmtStr, ##__VA_ARGS__)
+#define LOG_ERROR_EVERY_MS(ms, fmtStr, ...)		LOG_EVERY_MS(Error, ms, fmtStr, ##__VA_ARGS__)
+#define LOG_CRITICAL_EVERY_MS(ms, fmtStr, ...)	LOG_EVERY_MS(Critical, ms, fmtStr, ##__VA_ARGS__)
+
+#define LOG_INFO_SAMPLED(p, fmtStr, ...)		LOG_SAMPLED(Info, p, fmtStr, ##__VA_ARGS__)
+#define LOG_WARNING_SAMPLED(p, fmtStr, ...)		LOG_SAMPLED(Warn, p, fmtStr, ##__VA_ARGS__)
+#define LOG_ERROR_SAMPLED(p, fmtStr, ...)		LOG_SAMPLED(Error, p, fmtStr, ##__VA_ARGS__)
+#define LOG_CRITICAL_SAMPLED(p, fmtStr, ...)	LOG_SAMPLED(Critical, p, fmtStr, ##__VA_ARGS__)
+
+#define LOG_INFO_CAT(category, fmtStr, ...)		LOG_CAT(Info, category, fmtStr, ##__VA_ARGS__)
+#define LOG_WARNING_CAT(category, fmtStr, ...)	LOG_CAT(Warn, category, fmtStr, ##__VA_ARGS__)
+#define LOG_ERROR_CAT(category, fmtStr, ...)	LOG_CAT(Error, category, fmtStr, ##__VA_ARGS__)
+#define LOG_CRITICAL_CAT(category, fmtStr, ...)	LOG_CAT(Critical, category, fmtStr, ##__VA_ARGS__)
+
+// Structured messages: LOG_INFO_KV("request done", "user_id", id, "latency_us", t)
+#define LOG_INFO_KV(message, ...)				LOG_KV(Info, message, ##__VA_ARGS__)
+#define LOG_WARNING_KV(message, ...)			LOG_KV(Warn, message, ##__VA_ARGS__)
+#define LOG_ERROR_KV(message, ...)				LOG_KV(Error, message, ##__VA_ARGS__)
+#define LOG_CRITICAL_KV(message, ...)			LOG_KV(Critical, message, ##__VA_ARGS__)
+
+// Through a named logger: auto db = logging::get("db"); LOG_INFO_TO(db, "query took {} us", t)
+#define LOG_INFO_TO(logger, fmtStr, ...)		LOG_TO(logger, Info, fmtStr, ##__VA_ARGS__)
+#define LOG_WARNING_TO(logger, fmtStr, ...)		LOG_TO(logger, Warn, fmtStr, ##__VA_ARGS__)
+#define LOG_ERROR_TO(logger, fmtStr, ...)		LOG_TO(logger, Error, fmtStr, ##__VA_ARGS__)
+#define LOG_CRITICAL_TO(logger, fmtStr, ...)	LOG_TO(logger, Critical, fmtStr, ##__VA_ARGS__)
@@ -0,0 +1,103 @@
+/*
+==============================================================================
+	Module			RingBufferSink
+	Description		In-memory flight recorder keeping the last records for a crash dump
+==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <spdlog/sinks/sink.h>
+
+
+/*
+ *	@brief		Keeps the most recent records in a fixed ring of preallocated slots and writes them out on
+ *				request or when the process crashes. Logging stores the raw record (time, thread, level,
+ *				source location and the message, cut to MaxMessageLength bytes) - nothing is formatted and no
+ *				lock is taken. A writer claims its slot with one atomic increment and guards it with a
+ *				sequence number, so a dump running next to logging threads skips slots that are being
+ *				rewritten instead of printing torn lines.
+ *				Dumping only uses async-signal-safe calls, which lets the crash handler run it. For that
+ *				reason the dump renders times in UTC.
+ */
+class RingBufferSink : public spdlog::sinks::sink
+{
+public:
+	static constexpr size_t MaxMessageLength = 208; // Longer messages are cut, keeping a slot at 256 bytes
+
+	// Capacity is rounded up to a power of two
+	explicit RingBufferSink(size_t capacity);
+
+	RingBufferSink(const RingBufferSink &)			  = delete;
+	RingBufferSink &operator=(const RingBufferSink &) = delete;
+
+	void			log(const spdlog::details::log_msg &msg) override;
+
+	// Records stay in memory until dumped
+	void			flush() override {}
+
+	// Dumps are rendered in a fixed layout
+	void			set_pattern(const std::string &) override {}
+
+	void			set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+	size_t			capacity() const noexcept { return mCapacity; }
+
+	// Writes the records still in the ring, oldest first, to `fileName`. Returns the number of records written.
+	size_t			dump(const std::string &fileName) const;
+
+	// Same as above, to an open file descriptor. Async-signal-safe.
+	size_t			dump(int fd) const noexcept;
+
+	/*
+	 *	@brief		Dumps the ring to `fileName` when the process receives SIGSEGV, SIGABRT, SIGBUS, SIGFPE or
+	 *				SIGILL, then hands the signal to the handler that was installed before. One ring per process
+	 *				can be armed; arming another replaces it. Armed rings are kept alive until the process ends.
+	 */
+	static void		armCrashDump(const std::shared_ptr<RingBufferSink> &ring, const std::string &fileName);
+
+	static void		disarmCrashDump();
+
+private:
+	static constexpr size_t TextWords = MaxMessageLength / sizeof(uint64_t);
+
+	// Every field is atomic so a dump may read a slot while it is rewritten; the sequence tells it apart
+	struct Slot
+	{
+		std::atomic<uint64_t>	 sequence{0}; // 0 empty, odd while written, 2 * (position + 1) once complete
+		std::atomic<int64_t>	 time{0};	  // ns since epoch
+		std::atomic<uint64_t>	 threadId{0};
+		std::atomic<const char *> file{nullptr};
+		std::atomic<const char *> function{nullptr};
+		std::atomic<int32_t>	 line{0};
+		std::atomic<uint16_t>	 length{0};
+		std::atomic<uint8_t>	 level{0};
+		std::atomic<uint64_t>	 text[TextWords];
+	};
+
+	struct Record
+	{
+		int64_t		time;
+		uint64_t	threadId;
+		const char *file;
+		const char *function;
+		int32_t		line;
+		uint16_t	length;
+		uint8_t		level;
+		char		text[MaxMessageLength];
+	};
+
+	// Copies the slot of `position` into `record`. False if it was overwritten or is being written.
+	bool					readSlot(uint64_t position, Record &record) const noexcept;
+
+	const size_t			mCapacity;
+	const size_t			mMask;
+	std::unique_ptr<Slot[]> mSlots;
+
+	alignas(64) std::atomic<uint64_t> mNext{0}; // Position of the next record
+};
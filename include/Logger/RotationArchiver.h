@@ -0,0 +1,62 @@
+/*
+==============================================================================
+	Module			RotationArchiver
+	Description		Compresses rotated log files on a background thread
+==============================================================================
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+
+/*
+ *	@brief		Turns the files a sink rotates away into the numbered archives app.1.log.lz4 -> app.2.log.lz4 -> ...
+ *				The sink only renames its full file to a staging name (stagingName()) and hands it over with
+ *				archive(); shifting the older archives and compressing happen on the archiver's thread, so the
+ *				sink lock is never held for more than one rename. Files are archived in the order they were
+ *				handed over. Staging files left behind by a process that ended before archiving them are picked
+ *				up on construction.
+ */
+class RotationArchiver
+{
+public:
+	RotationArchiver(std::string fileName, size_t maxFiles);
+
+	// Archives everything handed over so far before returning
+	~RotationArchiver();
+
+	RotationArchiver(const RotationArchiver &)			  = delete;
+	RotationArchiver &operator=(const RotationArchiver &) = delete;
+
+	// Unused name to rename the full log file to before handing it to archive()
+	std::string		  stagingName();
+
+	void			  archive(std::string stagedFile);
+
+	// Blocks until every file handed over so far is archived
+	void			  waitUntilIdle();
+
+	// app.log, 2 -> app.2.log.lz4
+	static std::string archiveName(const std::string &fileName, size_t index);
+
+private:
+	void			  run();
+
+	void			  archiveOne(const std::string &stagedFile);
+
+	const std::string		mFileName;
+	const size_t			mMaxFiles;
+
+	std::mutex				mMutex;
+	std::condition_variable mWake;
+	std::condition_variable mIdle;
+	std::deque<std::string> mQueue;	  // Front is the file being archived
+	size_t					mNextStagingIndex = 0;
+	bool					mStop			  = false;
+	std::thread				mWorker;
+};
@@ -0,0 +1,49 @@
+/*
+==============================================================================
+	Module			SharedRendering
+	Description		Renders a message once for all sinks that share a layout
+==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include <spdlog/details/log_msg.h>
+
+
+/*
+ *	@brief		Lets the formatters of several sinks share one rendering of a message. SinkList opens a Scope
+ *				around a message it hands to more than one sink. Inside it, the first Formatter of a layout
+ *				keeps the bytes it rendered in a thread-local slot, and every other Formatter with the same
+ *				layout appends those bytes instead of formatting again. The console color range is kept as
+ *				offsets into the rendering. Only the scoped message itself is shared, so messages a sink
+ *				makes up on its own (such as the duplicate filter's notice) are formatted as usual.
+ */
+class SharedRendering
+{
+public:
+	class Scope
+	{
+	public:
+		// Nested scopes have no effect, the outer one keeps sharing
+		explicit Scope(const spdlog::details::log_msg &msg);
+		~Scope();
+
+		Scope(const Scope &)			= delete;
+		Scope &operator=(const Scope &) = delete;
+
+	private:
+		bool mActive = false;
+	};
+
+	// Identifies a layout by its pattern; formatters built from the same pattern get the same id
+	static uint32_t layoutId(std::string_view pattern);
+
+	// Appends the rendering of `layout` if one was kept for `msg` in the current scope. False otherwise.
+	static bool		copyTo(const spdlog::details::log_msg &msg, uint32_t layout, spdlog::memory_buf_t &dest);
+
+	// Keeps everything `dest` holds from `begin` on as the rendering of `layout`, if `msg` is the scoped message
+	static void		keep(const spdlog::details::log_msg &msg, uint32_t layout, const spdlog::memory_buf_t &dest, size_t begin);
+};
@@ -0,0 +1,88 @@
+/*
+==============================================================================
+	Module			SinkList
+	Description		Copy-on-write set of sinks that can change while messages are logged
+==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <spdlog/sinks/sink.h>
+
+#include "LoggerStats.h"
+
+
+/*
+ *	@brief		Forwards every message to a set of sinks that is published as an immutable snapshot.
+ *				Logging threads read the current snapshot without a lock or a shared reference count: each
+ *				thread announces the snapshot it reads in a slot of its own (a hazard pointer). Adding or
+ *				removing a sink copies the set, publishes the new snapshot and then waits until no other
+ *				thread still reads the previous one, so a removed sink is destroyed (and flushed) once the
+ *				last message in flight has reached it, before remove() returns.
+ *				The logger holds one SinkList as its only sink, so its own sink vector never changes.
+ *				When a message goes to several sinks, those with the same layout share one rendering of it.
+ *				Every sink has its own LoggerStats counters, which stay with the snapshots that hold it.
+ */
+class SinkList : public spdlog::sinks::sink
+{
+public:
+	struct Entry
+	{
+		uint64_t							 handle;
+		spdlog::sink_ptr					 sink;
+		std::string							 name; // Shown in logging::stats()
+		std::shared_ptr<LoggerStats::Output> stats;
+	};
+
+	using Snapshot = std::vector<Entry>;
+
+	SinkList();
+
+	// Adds the sink and returns its handle (never 0). Handles are unique across all sink lists of the process.
+	uint64_t						add(spdlog::sink_ptr sink, std::string name = {});
+
+	// Next handle, for an output that is not kept in a sink list (the binary output)
+	static uint64_t					newHandle() noexcept { return sNextHandle.fetch_add(1, std::memory_order_relaxed); }
+
+	// Removes the sink with this handle. Returns false if no such sink is registered.
+	bool							remove(uint64_t handle);
+
+	// The sink with this handle, or nullptr
+	spdlog::sink_ptr				find(uint64_t handle) const;
+
+	// Counted copy of the current snapshot, for callers outside the logging path
+	std::shared_ptr<const Snapshot> snapshot() const;
+
+	// Lowest level accepted by any sink, off if there is none
+	spdlog::level::level_enum		lowestLevel() const;
+
+	void							log(const spdlog::details::log_msg &msg) override;
+
+	void							flush() override;
+
+	// Each sink keeps its own pattern and formatter
+	void							set_pattern(const std::string &) override {}
+	void							set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+private:
+	using Retired = std::vector<std::shared_ptr<const Snapshot>>;
+
+	// Publishes next (with mMutex held) and returns the replaced snapshots no thread reads any more
+	Retired								publish(std::shared_ptr<const Snapshot> next);
+
+	// Hands the message to the sinks of one snapshot
+	void								forward(const Snapshot &sinks, const spdlog::details::log_msg &msg);
+
+	mutable std::mutex					mMutex; // Serializes add() and remove(), guards mCurrent and mRetired
+	std::shared_ptr<const Snapshot>		mCurrent;
+	std::atomic<const Snapshot *>		mPublished; // mCurrent's snapshot, read by logging threads
+	Retired								mRetired;	// Replaced snapshots the updating thread itself was still reading
+	static inline std::atomic<uint64_t>	sNextHandle{1};
+};
@@ -0,0 +1,97 @@
+/*
+==============================================================================
+	Module			SpscRing
+	Description		Bounded single-producer single-consumer ring of reusable slots
+==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+
+/*
+ *	@brief		Ring buffer for exactly one producer and one consumer thread.
+ *				Slots are filled and read in place, so items that own memory (strings) keep their capacity
+ *				from one lap to the next. Each side caches the other side's index and only rereads it when
+ *				the ring looks full or empty, so the common case touches no shared cache line.
+ */
+template <typename T>
+class SpscRing
+{
+public:
+	explicit SpscRing(size_t capacity) : mCapacity(roundUpToPowerOfTwo(capacity)), mMask(mCapacity - 1), mSlots(std::make_unique<T[]>(mCapacity)) {}
+
+	SpscRing(const SpscRing &)			  = delete;
+	SpscRing &operator=(const SpscRing &) = delete;
+
+
+	// Producer: slot to fill for the next item, or nullptr if the ring is full. Publish it with commitPush().
+	T		 *beginPush() noexcept
+	{
+		size_t head = mHead.load(std::memory_order_relaxed);
+
+		if (head - mCachedTail == mCapacity)
+		{
+			mCachedTail = mTail.load(std::memory_order_acquire);
+			if (head - mCachedTail == mCapacity)
+				return nullptr; // Full
+		}
+
+		return &mSlots[head & mMask];
+	}
+
+	void commitPush() noexcept { mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+
+	// Consumer: oldest item, or nullptr if the ring is empty. Release it with pop() once done.
+	T	*front() noexcept
+	{
+		size_t tail = mTail.load(std::memory_order_relaxed);
+
+		if (tail == mCachedHead)
+		{
+			mCachedHead = mHead.load(std::memory_order_acquire);
+			if (tail == mCachedHead)
+				return nullptr; // Empty
+		}
+
+		return &mSlots[tail & mMask];
+	}
+
+	void   pop() noexcept { mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+
+	size_t capacity() const noexcept { return mCapacity; }
+
+	// Approximate number of items; exact only while neither side is active
+	size_t size() const noexcept { return mHead.load(std::memory_order_acquire) - mTail.load(std::memory_order_acquire); }
+
+
+private:
+	static size_t roundUpToPowerOfTwo(size_t value)
+	{
+		size_t result = 2;
+		while (result < value)
+		{
+			result <<= 1;
+		}
+		return result;
+	}
+
+	static constexpr size_t CacheLineSize = 64;
+
+	const size_t			mCapacity;
+	const size_t			mMask;
+	std::unique_ptr<T[]>	mSlots;
+
+	// Producer side: head and its view of the tail
+	alignas(CacheLineSize) std::atomic<size_t> mHead{0};
+	size_t mCachedTail = 0;
+
+	// Consumer side: tail and its view of the head
+	alignas(CacheLineSize) std::atomic<size_t> mTail{0};
+	size_t mCachedHead = 0;
+};
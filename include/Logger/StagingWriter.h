@@ -0,0 +1,84 @@
+/*
+==============================================================================
+	Module			StagingWriter
+	Description		Per-thread staging rings merged into the sinks by one writer thread
+==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <spdlog/logger.h>
+
+#include "AsyncWriter.h"
+#include "SpscRing.h"
+
+
+/*
+ *	@brief		Asynchronous writer without a shared queue. Every logging thread gets its own SPSC ring on
+ *				its first message, so producers never contend with each other. The writer thread drains all
+ *				rings, always taking the staged record with the earliest timestamp next.
+ *				A thread can only discard its own newest message, so DropOldest behaves like DropNewest.
+ */
+class StagingWriter
+{
+public:
+	StagingWriter(std::shared_ptr<spdlog::logger> logger, size_t ringSize, OverflowPolicy overflowPolicy);
+
+	// Writes out everything still staged, flushes the sinks and joins the writer thread
+	~StagingWriter();
+
+	StagingWriter(const StagingWriter &)			= delete;
+	StagingWriter &operator=(const StagingWriter &) = delete;
+
+	void		   enqueue(spdlog::log_clock::time_point time, size_t threadId, spdlog::level::level_enum level, int line, const char *file, const char *function, std::string_view payload,
+						   std::string_view fields = {}, logging::deferred::FormatFn format = nullptr, std::string_view formatString = {});
+
+	uint64_t	   droppedMessages() const noexcept { return mDropped.load(std::memory_order_relaxed); }
+
+	// Records staged in all rings, not yet written
+	size_t		   queueDepth();
+
+	// Number of rings, one per thread that logged and has not exited yet (or whose ring still holds records)
+	size_t		   ringCount();
+
+private:
+	struct Ring
+	{
+		explicit Ring(size_t size) : records(size) {}
+
+		SpscRing<AsyncRecord> records;
+		std::atomic<bool>	  closed{false}; // Owning thread exited, remove once drained
+	};
+
+	Ring										 &localRing();
+
+	void										  run();
+
+	// Writes the earliest staged record of all rings. Returns false if all rings were empty.
+	bool										  writeEarliest(std::vector<std::shared_ptr<Ring>> &rings);
+
+	void										  wakeWriter();
+
+	std::shared_ptr<spdlog::logger>				  mLogger;
+	const size_t								  mRingSize;
+	const OverflowPolicy						  mOverflowPolicy;
+	const uint64_t								  mId; // Distinguishes writers in the threads' ring lists
+
+	std::mutex									  mRingsMutex;
+	std::vector<std::shared_ptr<Ring>>			  mRings;
+	std::atomic<uint64_t>						  mRingsVersion{0}; // Bumped when a ring is added
+
+	std::atomic<uint64_t>						  mDropped{0};
+	std::atomic<bool>							  mSleeping{false};
+	std::atomic<bool>							  mStop{false};
+
+	std::thread									  mWorker;
+};
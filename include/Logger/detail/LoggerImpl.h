@@ -9,29 +9,83 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <chrono>
 
+#include <nlohmann/json_fwd.hpp>
+#include <spdlog/common.h>
+
+#include "DeferredFormat.h"
 #include "LoggerWrapper.h" // For function delaration
 
 
 namespace logging
 {
 
+spdlog::level::level_enum toSpdLogLevel(LogLevel level);
+
+LogLevel				  fromSpdLogLevel(spdlog::level::level_enum level);
+
+
 class LoggerImpl
 {
 
 public:
 	static LoggerImpl &GetInstance();
 
-	void			   addConsoleOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &pattern);
+	OutputHandle	   addConsoleOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &pattern, const Logger &logger);
+
+	OutputHandle addFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles, bool rotateOnSession,
+							   LogLevel flushLevel, std::chrono::milliseconds flushInterval, size_t writeBatchBytes, Codec compressOnRotate, std::chrono::seconds rotateInterval,
+							   const std::string &pattern, const Logger &logger);
+
+	OutputHandle addMSVCOutput(LogLevel level, bool checkForDebuggerPresent, std::chrono::microseconds maxSkipDuration, const Logger &logger);
+
+	OutputHandle addMmapFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles,
+								   const std::string &pattern, const Logger &logger);
+
+	OutputHandle addJsonFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles,
+								   const Logger &logger);
+
+	OutputHandle addRingBufferOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, size_t capacity, const std::string &crashDumpFile, const Logger &logger);
+
+	size_t		 dumpRing(const std::string &fileName);
+
+	bool		 removeOutput(OutputHandle handle);
+
+	bool		 setOutputLevel(OutputHandle handle, LogLevel level);
+
+	void		 initializeLogger(const std::string &configFilePath);
+
+	void		 watchConfig(const std::string &configFilePath);
+
+	std::atomic<LogLevel> &categoryThreshold(std::string_view category);
+
+	Logger				   getLogger(std::string_view name);
 
-	void addFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles, bool rotateOnSession);
+	void				   setLoggerLevel(const Logger &logger, LogLevel level);
 
-	void addMSVCOutput(LogLevel level, bool checkForDebuggerPresent, std::chrono::microseconds maxSkipDuration);
+	void				   setCategoryLevel(std::string_view category, LogLevel level);
 
-	void initializeLogger(const std::string &configFilePath);
+	void				   setDefaultCategoryLevel(LogLevel level);
 
-	void log(LogLevel level, const std::string &file, int line, const std::string &function, const std::string &msg);
+	void enableAsync(size_t queueSize, OverflowPolicy overflowPolicy, AsyncMode mode, bool deferFormatting);
+
+	size_t droppedMessages() const;
+
+	Stats  stats();
+
+	OutputHandle addBinaryFileOutput(LogLevel level, const std::string &fileName);
+
+	void   writeBinary(const CallSite &site, std::string_view signature, std::string_view encodedArgs);
+
+	void log(LogLevel level, const char *file, int line, const char *function, std::string_view msg);
+
+	void logStructured(LogLevel level, const char *file, int line, const char *function, std::string_view msg, std::string_view fields);
+
+	void logCaptured(const CallSite &site, deferred::FormatFn format, std::string_view captured);
+
+	void logTo(const Logger &logger, LogLevel level, const char *file, int line, const char *function, std::string_view msg);
 
 
 private:
@@ -39,6 +93,24 @@ private:
 	LoggerImpl(const LoggerImpl &)			  = delete;
 	LoggerImpl &operator=(const LoggerImpl &) = delete;
 
+	// Adds the sink to the logger's outputs; a default handle means the default logger. The name is shown in stats().
+	OutputHandle registerSink(const spdlog::sink_ptr &sink, LogLevel level, const Logger &logger, std::string name);
+
+	// Publishes the lowest level of the registered outputs; requires data->mtx
+	void		 updateLevels();
+
+	void		 applyAsyncConfig(const nlohmann::json &config);
+
+	void		 applyCategoryConfig(const nlohmann::json &config);
+
+	void		 applyLoggerConfig(const nlohmann::json &config);
+
+	// Creates the output described by one entry of the config's sink list
+	OutputHandle addOutput(const nlohmann::json &sinkConfig);
+
+	// Applies the difference between the watched config file and the outputs created from it
+	void		 reloadConfig(const std::string &configFilePath);
+
 	class ImplData; // Defined in the cpp
 	std::unique_ptr<ImplData> data;
 };
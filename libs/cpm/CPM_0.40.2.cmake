@@ -0,0 +1,15 @@
+# Offline shim: resolve CPM packages from locally installed copies
+function(CPMAddPackage)
+  cmake_parse_arguments(CPM "" "NAME" "" ${ARGN})
+  if(CPM_NAME STREQUAL "spdlog")
+    find_package(spdlog REQUIRED)
+  elseif(CPM_NAME STREQUAL "nlohmann_json")
+    find_package(nlohmann_json REQUIRED PATHS /root/miniconda/share/cmake/nlohmann_json NO_DEFAULT_PATH)
+  elseif(CPM_NAME STREQUAL "GOOGLETEST")
+    if(NOT TARGET gtest_main)
+      add_subdirectory(/usr/src/googletest ${CMAKE_BINARY_DIR}/googletest EXCLUDE_FROM_ALL)
+    endif()
+  elseif(CPM_NAME STREQUAL "benchmark")
+    find_package(benchmark REQUIRED)
+  endif()
+endfunction()
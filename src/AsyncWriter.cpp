@@ -0,0 +1,187 @@
+/*
+==============================================================================
+	Module			AsyncWriter
+	Description		Background thread draining queued messages into the sinks
+==============================================================================
+*/
+
+#include "AsyncWriter.h"
+
+#include <cstdio>
+
+#include <spdlog/details/log_msg.h>
+#include <spdlog/sinks/sink.h>
+
+#include "KeyValue.h"
+
+
+AsyncWriter::AsyncWriter(std::shared_ptr<spdlog::logger> logger, size_t queueSize, OverflowPolicy overflowPolicy)
+	: mLogger(std::move(logger)), mQueue(queueSize), mOverflowPolicy(overflowPolicy)
+{
+	mWorker = std::thread(&AsyncWriter::run, this);
+}
+
+
+AsyncWriter::~AsyncWriter()
+{
+	mStop.store(true);
+	mSleeping.store(false);
+	mSleeping.notify_one();
+
+	if (mWorker.joinable())
+		mWorker.join();
+}
+
+
+void AsyncWriter::enqueue(AsyncRecord &&record)
+{
+	if (!mQueue.tryPush(std::move(record)))
+	{
+		switch (mOverflowPolicy)
+		{
+		case OverflowPolicy::Block:
+		{
+			while (!mQueue.tryPush(std::move(record)))
+			{
+				wakeWriter();
+				std::this_thread::yield();
+			}
+			break;
+		}
+		case OverflowPolicy::DropNewest:
+		{
+			mDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		case OverflowPolicy::DropOldest:
+		{
+			AsyncRecord evicted;
+			do
+			{
+				if (mQueue.tryPop(evicted))
+					mDropped.fetch_add(1, std::memory_order_relaxed);
+			} while (!mQueue.tryPush(std::move(record)));
+			break;
+		}
+		}
+	}
+
+	wakeWriter();
+}
+
+
+void AsyncWriter::wakeWriter()
+{
+	// Pairs with the fence in run(): either the writer sees the new record, or we see it sleeping
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (mSleeping.load(std::memory_order_relaxed))
+	{
+		mSleeping.store(false, std::memory_order_relaxed);
+		mSleeping.notify_one();
+	}
+}
+
+
+void AsyncWriter::run()
+{
+	AsyncRecord record;
+
+	while (true)
+	{
+		if (mQueue.tryPop(record))
+		{
+			writeRecord(*mLogger, record);
+			continue;
+		}
+
+		if (mStop.load())
+			break;
+
+		// Queue ran empty: push what was written so far to disk before going to sleep
+		flushSinks(*mLogger);
+
+		mSleeping.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (mQueue.tryPop(record))
+		{
+			mSleeping.store(false, std::memory_order_relaxed);
+			writeRecord(*mLogger, record);
+			continue;
+		}
+
+		if (mStop.load())
+			break;
+
+		mSleeping.wait(true);
+	}
+
+	while (mQueue.tryPop(record))
+	{
+		writeRecord(*mLogger, record);
+	}
+
+	flushSinks(*mLogger);
+}
+
+
+void writeRecord(spdlog::logger &logger, const AsyncRecord &record)
+{
+	std::string_view payload = record.payload;
+
+	if (record.format)
+	{
+		// Only the writer thread formats, so its buffer keeps its capacity from record to record
+		thread_local std::string text;
+		text.clear();
+
+		try
+		{
+			record.format(text, record.formatString, record.payload);
+		}
+		catch (const std::exception &ex)
+		{
+			std::fprintf(stderr, "[Logger] Deferred formatting failed: %s\n", ex.what());
+			return;
+		}
+		payload = text;
+	}
+
+	spdlog::source_loc		 loc{record.file, record.line, record.function};
+	spdlog::details::log_msg msg(record.time, loc, logger.name(), record.level, spdlog::string_view_t(payload.data(), payload.size()));
+	msg.thread_id = record.threadId; // Report the thread that logged, not the writer thread
+
+	logging::kv::ScopedFields fields(record.fields);
+
+	for (auto &sink : logger.sinks())
+	{
+		if (!sink->should_log(msg.level))
+			continue;
+
+		try
+		{
+			sink->log(msg);
+		}
+		catch (const std::exception &ex)
+		{
+			std::fprintf(stderr, "[Logger] Asynchronous sink write failed: %s\n", ex.what());
+		}
+	}
+}
+
+
+void flushSinks(spdlog::logger &logger)
+{
+	for (auto &sink : logger.sinks())
+	{
+		try
+		{
+			sink->flush();
+		}
+		catch (const std::exception &ex)
+		{
+			std::fprintf(stderr, "[Logger] Asynchronous sink flush failed: %s\n", ex.what());
+		}
+	}
+}
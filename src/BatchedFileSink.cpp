@@ -0,0 +1,274 @@
+/*
+==============================================================================
+	Module			BatchedFileSink
+	Description		Rotating file sink writing formatted lines in batches
+==============================================================================
+*/
+
+#include "BatchedFileSink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include "LoggerStats.h"
+
+
+BatchedFileSink::BatchedFileSink(std::string fileName, size_t maxFileSize, size_t maxFiles, bool rotateOnOpen, spdlog::level::level_enum flushLevel,
+								 std::chrono::milliseconds flushInterval, size_t writeBatchBytes, Codec compressOnRotate, std::chrono::seconds rotateInterval)
+	: mFileName(std::move(fileName)), mMaxFileSize(maxFileSize), mMaxFiles(maxFiles), mFlushLevel(std::min(flushLevel, spdlog::level::err)), mFlushInterval(flushInterval),
+	  mWriteBatchBytes(writeBatchBytes), mRotateInterval(rotateInterval)
+{
+	if (mFileName.empty())
+		throw std::invalid_argument("File name cannot be empty");
+	if (mMaxFileSize == 0)
+		throw std::invalid_argument("Maximum file size cannot be zero");
+	if (mRotateInterval.count() < 0)
+		throw std::invalid_argument("Rotate interval cannot be negative");
+
+	// A batch never grows past writeBatchBytes, so reserving it once keeps writes free of allocations
+	mPending.reserve(mWriteBatchBytes);
+
+	if (compressOnRotate != Codec::None)
+		mArchiver = std::make_unique<RotationArchiver>(mFileName, mMaxFiles);
+
+	if (mRotateInterval.count() > 0)
+		mNextRotation = nextRotationAfter(spdlog::log_clock::now());
+
+	openFile(false);
+
+	if (rotateOnOpen && mFileSize > 0)
+		rotate();
+
+	if (mFlushInterval.count() > 0)
+		mFlusher = std::thread(&BatchedFileSink::runFlusher, this);
+}
+
+
+BatchedFileSink::~BatchedFileSink()
+{
+	if (mFlusher.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mFlusherMutex);
+			mStopFlusher = true;
+		}
+		mFlusherWake.notify_one();
+		mFlusher.join();
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	try
+	{
+		writePending(nullptr, 0);
+	}
+	catch (const std::exception &ex)
+	{
+		std::fprintf(stderr, "[Logger] Could not write pending log lines to %s: %s\n", mFileName.c_str(), ex.what());
+	}
+	closeFile();
+}
+
+
+void BatchedFileSink::sink_it_(const spdlog::details::log_msg &msg)
+{
+	mFormatted.clear();
+	formatter_->format(msg, mFormatted);
+
+	if (mRotateInterval.count() > 0 && msg.time >= mNextRotation)
+	{
+		writePending(nullptr, 0);
+		if (mFileSize > 0)
+			rotate();
+		mNextRotation = nextRotationAfter(msg.time);
+	}
+
+	// Same rotation rule as the rotating file sink: rotate before a line that would exceed the size
+	if (mFileSize + mPending.size() + mFormatted.size() > mMaxFileSize)
+	{
+		writePending(nullptr, 0);
+		if (mFileSize > 0)
+			rotate();
+	}
+
+	bool flushNow = msg.level >= mFlushLevel;
+	if (flushNow || mPending.size() + mFormatted.size() > mWriteBatchBytes)
+	{
+		// Hand the line to the same write as the batch instead of copying it in first
+		writePending(mFormatted.data(), mFormatted.size());
+		return;
+	}
+
+	mPending.append(mFormatted.data(), mFormatted.data() + mFormatted.size());
+}
+
+
+void BatchedFileSink::flush_()
+{
+	writePending(nullptr, 0);
+}
+
+
+void BatchedFileSink::writePending(const char *line, size_t lineLength)
+{
+	size_t total = mPending.size() + lineLength;
+	if (total == 0)
+		return;
+
+#ifdef _WIN32
+	if (std::fwrite(mPending.data(), 1, mPending.size(), mFile) != mPending.size() || std::fwrite(line, 1, lineLength, mFile) != lineLength || std::fflush(mFile) != 0)
+		throw std::runtime_error("Could not write to log file " + mFileName);
+#else
+	iovec  parts[2] = {{mPending.data(), mPending.size()}, {const_cast<char *>(line), lineLength}};
+	iovec *next		= parts;
+	int	   count	= lineLength > 0 ? 2 : 1;
+
+	while (count > 0)
+	{
+		ssize_t written = ::writev(mFd, next, count);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			throw std::runtime_error("Could not write to log file " + mFileName + ": " + std::strerror(errno));
+		}
+
+		// Short write: skip what went out and write the rest
+		auto remaining = static_cast<size_t>(written);
+		while (count > 0 && remaining >= next->iov_len)
+		{
+			remaining -= next->iov_len;
+			++next;
+			--count;
+		}
+		if (count > 0)
+		{
+			next->iov_base = static_cast<char *>(next->iov_base) + remaining;
+			next->iov_len -= remaining;
+		}
+	}
+#endif
+
+	mWriteCount.fetch_add(1, std::memory_order_relaxed);
+	mFileSize += total;
+	mPending.clear();
+}
+
+
+void BatchedFileSink::openFile(bool truncate)
+{
+	auto directory = std::filesystem::path(mFileName).parent_path();
+	if (!directory.empty())
+		std::filesystem::create_directories(directory);
+
+#ifdef _WIN32
+	mFile = std::fopen(mFileName.c_str(), truncate ? "wb" : "ab");
+	if (!mFile)
+		throw std::runtime_error("Could not open log file " + mFileName);
+#else
+	mFd = ::open(mFileName.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+	if (mFd < 0)
+		throw std::runtime_error("Could not open log file " + mFileName + ": " + std::strerror(errno));
+#endif
+
+	std::error_code error;
+	mFileSize = truncate ? 0 : static_cast<size_t>(std::filesystem::file_size(mFileName, error));
+	if (error)
+		mFileSize = 0;
+}
+
+
+void BatchedFileSink::closeFile()
+{
+#ifdef _WIN32
+	if (mFile)
+		std::fclose(mFile);
+	mFile = nullptr;
+#else
+	if (mFd >= 0)
+		::close(mFd);
+	mFd = -1;
+#endif
+}
+
+
+void BatchedFileSink::rotate()
+{
+	namespace fs = std::filesystem;
+	using spdlog::sinks::rotating_file_sink_mt;
+
+	LoggerStats::countRotation();
+	closeFile();
+
+	// Only the rename is done here; shifting the archives and compressing run on the archiver's thread
+	if (mArchiver)
+	{
+		auto			stagedFile = mArchiver->stagingName();
+		std::error_code error;
+		fs::rename(mFileName, stagedFile, error);
+		if (!error)
+			mArchiver->archive(stagedFile);
+
+		openFile(true);
+		return;
+	}
+
+	// app.log -> app.1.log -> ... -> app.<maxFiles>.log, the oldest one is dropped
+	std::error_code error;
+	for (size_t i = mMaxFiles; i > 0; --i)
+	{
+		auto source = i == 1 ? mFileName : rotating_file_sink_mt::calc_filename(mFileName, i - 1);
+		auto target = rotating_file_sink_mt::calc_filename(mFileName, i);
+
+		if (!fs::exists(source, error))
+			continue;
+
+		fs::remove(target, error);
+		fs::rename(source, target, error);
+	}
+
+	openFile(true);
+}
+
+
+spdlog::log_clock::time_point BatchedFileSink::nextRotationAfter(spdlog::log_clock::time_point time) const
+{
+	// Boundaries are multiples of the interval since the epoch, so an hourly interval rotates on the hour
+	auto sinceEpoch = std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch());
+	return spdlog::log_clock::time_point((sinceEpoch / mRotateInterval + 1) * mRotateInterval);
+}
+
+
+void BatchedFileSink::waitForArchives()
+{
+	if (mArchiver)
+		mArchiver->waitUntilIdle();
+}
+
+
+void BatchedFileSink::runFlusher()
+{
+	std::unique_lock<std::mutex> lock(mFlusherMutex);
+
+	while (!mFlusherWake.wait_for(lock, mFlushInterval, [this] { return mStopFlusher; }))
+	{
+		try
+		{
+			flush(); // Takes the sink mutex
+		}
+		catch (const std::exception &ex)
+		{
+			std::fprintf(stderr, "[Logger] Periodic flush of %s failed: %s\n", mFileName.c_str(), ex.what());
+		}
+	}
+}
@@ -0,0 +1,321 @@
+/*
+==============================================================================
+	Module			BinaryLogReader
+	Description		Reads binary log files and renders their records as text
+==============================================================================
+*/
+
+#include "BinaryLogReader.h"
+
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include "BinaryLog.h"
+#include "LoggerImpl.h"
+
+
+using namespace logging::binary;
+
+
+namespace
+{
+
+// Integers are widened: std::format renders a value the same way regardless of its integer width
+using ArgValue = std::variant<bool, char, int64_t, uint64_t, float, double, std::string_view, const void *>;
+
+
+// Sequential reader over the encoded arguments of one record
+class ArgCursor
+{
+public:
+	explicit ArgCursor(std::string_view bytes) : mBytes(bytes) {}
+
+	template <typename T>
+	T read()
+	{
+		T value;
+		take(&value, sizeof(T));
+		return value;
+	}
+
+	std::string_view readString()
+	{
+		auto length = read<uint32_t>();
+		if (length > mBytes.size())
+			throw std::runtime_error("Truncated string argument in binary log record");
+
+		auto text = mBytes.substr(0, length);
+		mBytes.remove_prefix(length);
+		return text;
+	}
+
+private:
+	void take(void *dest, size_t size)
+	{
+		if (size > mBytes.size())
+			throw std::runtime_error("Truncated arguments in binary log record");
+
+		std::memcpy(dest, mBytes.data(), size);
+		mBytes.remove_prefix(size);
+	}
+
+	std::string_view mBytes;
+};
+
+
+std::vector<ArgValue> decodeArgs(std::string_view signature, std::string_view encodedArgs)
+{
+	std::vector<ArgValue> args;
+	ArgCursor			  cursor(encodedArgs);
+
+	for (char tag : signature)
+	{
+		switch (static_cast<ArgType>(tag))
+		{
+		case ArgType::Bool: args.emplace_back(cursor.read<bool>()); break;
+		case ArgType::Char: args.emplace_back(cursor.read<char>()); break;
+		case ArgType::Int8: args.emplace_back(static_cast<int64_t>(cursor.read<int8_t>())); break;
+		case ArgType::Int16: args.emplace_back(static_cast<int64_t>(cursor.read<int16_t>())); break;
+		case ArgType::Int32: args.emplace_back(static_cast<int64_t>(cursor.read<int32_t>())); break;
+		case ArgType::Int64: args.emplace_back(cursor.read<int64_t>()); break;
+		case ArgType::UInt8: args.emplace_back(static_cast<uint64_t>(cursor.read<uint8_t>())); break;
+		case ArgType::UInt16: args.emplace_back(static_cast<uint64_t>(cursor.read<uint16_t>())); break;
+		case ArgType::UInt32: args.emplace_back(static_cast<uint64_t>(cursor.read<uint32_t>())); break;
+		case ArgType::UInt64: args.emplace_back(cursor.read<uint64_t>()); break;
+		case ArgType::Float: args.emplace_back(cursor.read<float>()); break;
+		case ArgType::Double: args.emplace_back(cursor.read<double>()); break;
+		case ArgType::String: args.emplace_back(cursor.readString()); break;
+		case ArgType::Pointer: args.emplace_back(reinterpret_cast<const void *>(static_cast<uintptr_t>(cursor.read<uint64_t>()))); break;
+		default: throw std::runtime_error("Unknown argument type in binary log call site");
+		}
+	}
+
+	return args;
+}
+
+
+const ArgValue &argAt(const std::vector<ArgValue> &args, size_t index)
+{
+	if (index >= args.size())
+		throw std::format_error("Argument index out of range");
+	return args[index];
+}
+
+
+// Value of a dynamic width or precision argument
+long long integerArg(const ArgValue &value)
+{
+	return std::visit(
+		[](const auto &v) -> long long
+		{
+			using T = std::decay_t<decltype(v)>;
+			if constexpr (std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t>)
+				return static_cast<long long>(v);
+			else
+				throw std::format_error("Width or precision argument is not an integer");
+		},
+		value);
+}
+
+
+size_t parseIndex(std::string_view id, size_t &nextIndex)
+{
+	if (id.empty())
+		return nextIndex++;
+
+	size_t index = 0;
+	for (char c : id)
+	{
+		if (c < '0' || c > '9')
+			throw std::format_error("Named arguments are not supported");
+		index = index * 10 + static_cast<size_t>(c - '0');
+	}
+	return index;
+}
+
+
+// Formats one replacement field "{id:spec}"; `field` is the text between the braces
+void formatField(std::string &dest, std::string_view field, const std::vector<ArgValue> &args, size_t &nextIndex)
+{
+	auto			 colon = field.find(':');
+	std::string_view spec  = colon == std::string_view::npos ? std::string_view() : field.substr(colon + 1);
+	const ArgValue	&value = argAt(args, parseIndex(field.substr(0, colon), nextIndex));
+
+	// Resolve nested "{}" widths and precisions to their values
+	std::string		 fmtStr = "{:";
+	for (size_t i = 0; i < spec.size(); ++i)
+	{
+		if (spec[i] != '{')
+		{
+			fmtStr.push_back(spec[i]);
+			continue;
+		}
+
+		auto close = spec.find('}', i);
+		if (close == std::string_view::npos)
+			throw std::format_error("Unterminated nested replacement field");
+
+		fmtStr += std::to_string(integerArg(argAt(args, parseIndex(spec.substr(i + 1, close - i - 1), nextIndex))));
+		i = close;
+	}
+	fmtStr.push_back('}');
+
+	std::visit([&](const auto &v) { dest += std::vformat(fmtStr, std::make_format_args(v)); }, value);
+}
+
+
+template <typename T>
+T readValue(std::istream &input)
+{
+	T value{};
+	if (!input.read(reinterpret_cast<char *>(&value), sizeof(T)))
+		throw std::runtime_error("Unexpected end of binary log");
+	return value;
+}
+
+
+void readString(std::istream &input, std::string &dest)
+{
+	dest.resize(readValue<uint32_t>(input));
+	if (!input.read(dest.data(), static_cast<std::streamsize>(dest.size())))
+		throw std::runtime_error("Unexpected end of binary log");
+}
+
+} // namespace
+
+
+BinaryLogReader::BinaryLogReader(std::istream &input) : mInput(input)
+{
+	char	 magic[sizeof(FileMagic)];
+	uint32_t version	   = 0;
+	uint32_t byteOrderMark = 0;
+
+	mInput.read(magic, sizeof(magic));
+	mInput.read(reinterpret_cast<char *>(&version), sizeof(version));
+	mInput.read(reinterpret_cast<char *>(&byteOrderMark), sizeof(byteOrderMark));
+
+	if (!mInput || std::memcmp(magic, FileMagic, sizeof(magic)) != 0)
+		throw std::runtime_error("Not a binary log file");
+	if (version != FileVersion)
+		throw std::runtime_error("Unsupported binary log version: " + std::to_string(version));
+	if (byteOrderMark != ByteOrderMark)
+		throw std::runtime_error("Binary log was written with a different byte order");
+}
+
+
+void BinaryLogReader::readCallSite()
+{
+	auto			id = readValue<uint32_t>(mInput);
+	BinaryCallSite	site;
+
+	site.level		= static_cast<LogLevel>(readValue<uint8_t>(mInput));
+	site.line		= readValue<int32_t>(mInput);
+	readString(mInput, site.file);
+	readString(mInput, site.function);
+	readString(mInput, site.format);
+	readString(mInput, site.signature);
+
+	mCallSites[id] = std::move(site);
+}
+
+
+bool BinaryLogReader::next(BinaryRecord &record)
+{
+	while (true)
+	{
+		int tag = mInput.get();
+		if (tag == std::char_traits<char>::eof())
+			return false;
+
+		if (tag == CallSiteTag)
+		{
+			readCallSite();
+			continue;
+		}
+
+		if (tag != RecordTag)
+			throw std::runtime_error("Corrupt binary log: unknown entry tag");
+
+		auto id = readValue<uint32_t>(mInput);
+		auto it = mCallSites.find(id);
+		if (it == mCallSites.end())
+			throw std::runtime_error("Corrupt binary log: record references unknown call site " + std::to_string(id));
+
+		record.site		= &it->second;
+		record.timeNs	= readValue<int64_t>(mInput);
+		record.threadId = readValue<uint64_t>(mInput);
+		readString(mInput, mArgs);
+
+		if (record.site->signature == Preformatted)
+			record.message = ArgCursor(mArgs).readString();
+		else
+			record.message = formatArguments(record.site->format, record.site->signature, mArgs);
+
+		return true;
+	}
+}
+
+
+void BinaryLogReader::render(const BinaryRecord &record, std::string &dest)
+{
+	auto					 time = spdlog::log_clock::time_point(std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(record.timeNs)));
+	spdlog::source_loc		 loc{record.site->file.c_str(), record.site->line, record.site->function.c_str()};
+	spdlog::details::log_msg msg(time, loc, "", logging::toSpdLogLevel(record.site->level), spdlog::string_view_t(record.message.data(), record.message.size()));
+	msg.thread_id = static_cast<size_t>(record.threadId);
+
+	spdlog::memory_buf_t buffer;
+	mFormatter.format(msg, buffer);
+	dest.append(buffer.data(), buffer.size());
+}
+
+
+std::string BinaryLogReader::formatArguments(std::string_view format, std::string_view signature, std::string_view encodedArgs)
+{
+	auto		args	  = decodeArgs(signature, encodedArgs);
+	size_t		nextIndex = 0;
+	std::string result;
+	result.reserve(format.size() + encodedArgs.size());
+
+	for (size_t i = 0; i < format.size(); ++i)
+	{
+		char c = format[i];
+
+		if (c == '{' && i + 1 < format.size() && format[i + 1] == '{')
+		{
+			result.push_back('{');
+			++i;
+		}
+		else if (c == '}' && i + 1 < format.size() && format[i + 1] == '}')
+		{
+			result.push_back('}');
+			++i;
+		}
+		else if (c == '{')
+		{
+			// Find the closing brace, skipping nested width/precision fields
+			size_t end	 = i + 1;
+			int	   depth = 1;
+			for (; end < format.size(); ++end)
+			{
+				if (format[end] == '{')
+					++depth;
+				else if (format[end] == '}' && --depth == 0)
+					break;
+			}
+			if (end >= format.size())
+				throw std::format_error("Unterminated replacement field");
+
+			formatField(result, format.substr(i + 1, end - i - 1), args, nextIndex);
+			i = end;
+		}
+		else
+		{
+			result.push_back(c);
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,99 @@
+/*
+==============================================================================
+	Module			BinaryLogWriter
+	Description		Appends call sites and raw argument records to a binary log file
+==============================================================================
+*/
+
+#include "BinaryLogWriter.h"
+
+#include <stdexcept>
+
+#include "BinaryLog.h"
+
+
+using namespace logging::binary;
+
+
+BinaryLogWriter::BinaryLogWriter(const std::string &fileName)
+{
+	if (fileName.empty())
+		throw std::invalid_argument("File name cannot be empty");
+
+	mFile = std::fopen(fileName.c_str(), "wb");
+	if (!mFile)
+		throw std::runtime_error("Could not open binary log file: " + fileName);
+
+	mScratch.append(FileMagic, sizeof(FileMagic));
+	appendRaw(mScratch, FileVersion);
+	appendRaw(mScratch, ByteOrderMark);
+	std::fwrite(mScratch.data(), 1, mScratch.size(), mFile);
+}
+
+
+BinaryLogWriter::~BinaryLogWriter()
+{
+	close();
+}
+
+
+void BinaryLogWriter::write(const logging::CallSite &site, std::string_view signature, std::string_view encodedArgs, int64_t timeNs, uint64_t threadId)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (!mFile)
+		return;
+
+	uint32_t					id = callSiteId(site, signature);
+
+	mScratch.clear();
+	mScratch.push_back(RecordTag);
+	appendRaw(mScratch, id);
+	appendRaw(mScratch, timeNs);
+	appendRaw(mScratch, threadId);
+	appendString(mScratch, encodedArgs);
+	std::fwrite(mScratch.data(), 1, mScratch.size(), mFile);
+
+	if (site.level >= LogLevel::Error)
+		std::fflush(mFile);
+}
+
+
+void BinaryLogWriter::flush()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mFile)
+		std::fflush(mFile);
+}
+
+
+void BinaryLogWriter::close()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (!mFile)
+		return;
+
+	std::fclose(mFile);
+	mFile = nullptr;
+	mCallSites.clear();
+}
+
+
+uint32_t BinaryLogWriter::callSiteId(const logging::CallSite &site, std::string_view signature)
+{
+	auto [it, inserted] = mCallSites.try_emplace(&site, static_cast<uint32_t>(mCallSites.size()));
+	if (!inserted)
+		return it->second;
+
+	mScratch.clear();
+	mScratch.push_back(CallSiteTag);
+	appendRaw(mScratch, it->second);
+	appendRaw(mScratch, static_cast<uint8_t>(site.level));
+	appendRaw(mScratch, static_cast<int32_t>(site.line));
+	appendString(mScratch, site.file ? site.file : "");
+	appendString(mScratch, site.function ? site.function : "");
+	appendString(mScratch, site.format);
+	appendString(mScratch, signature);
+	std::fwrite(mScratch.data(), 1, mScratch.size(), mFile);
+
+	return it->second;
+}
@@ -0,0 +1,99 @@
+/*
+==============================================================================
+	Module			CategoryRegistry
+	Description		Named log categories with their own level
+==============================================================================
+*/
+
+#include "CategoryRegistry.h"
+
+#include <algorithm>
+
+
+CategoryRegistry::CategoryRegistry(LogLevel minimumLevel) : mMinimumLevel(minimumLevel)
+{
+}
+
+
+std::atomic<LogLevel> &CategoryRegistry::threshold(std::string_view category)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return getOrCreate(category).threshold;
+}
+
+
+void CategoryRegistry::setLevel(std::string_view category, LogLevel level)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto					   &entry = getOrCreate(category);
+	entry.level						  = level;
+	publish(entry);
+}
+
+
+void CategoryRegistry::setDefaultLevel(LogLevel level)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mDefaultLevel = level;
+	publishAll();
+}
+
+
+void CategoryRegistry::configure(const std::map<std::string, LogLevel, std::less<>> &levels, LogLevel defaultLevel)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (auto &[name, category] : mCategories)
+	{
+		category->level.reset();
+	}
+
+	for (auto &[name, level] : levels)
+	{
+		getOrCreate(name).level = level;
+	}
+
+	mDefaultLevel = defaultLevel;
+	publishAll();
+}
+
+
+void CategoryRegistry::setMinimumLevel(LogLevel level)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if (level == mMinimumLevel)
+		return;
+
+	mMinimumLevel = level;
+	publishAll();
+}
+
+
+CategoryRegistry::Category &CategoryRegistry::getOrCreate(std::string_view category)
+{
+	auto it = mCategories.find(category);
+	if (it != mCategories.end())
+		return *it->second;
+
+	auto &entry = *mCategories.emplace(std::string(category), std::make_unique<Category>()).first->second;
+	publish(entry);
+	return entry;
+}
+
+
+void CategoryRegistry::publish(Category &category) const
+{
+	auto level = std::max(category.level.value_or(mDefaultLevel), mMinimumLevel);
+	category.threshold.store(level, std::memory_order_relaxed);
+}
+
+
+void CategoryRegistry::publishAll() const
+{
+	for (auto &[name, category] : mCategories)
+	{
+		publish(*category);
+	}
+}
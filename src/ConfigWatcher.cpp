@@ -0,0 +1,168 @@
+/*
+==============================================================================
+	Module			ConfigWatcher
+	Description		Background thread reporting changes to a configuration file
+==============================================================================
+*/
+
+#include "ConfigWatcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+ConfigWatcher::ConfigWatcher(std::filesystem::path path, std::function<void()> onChange, std::chrono::milliseconds settleTime)
+	: mPath(std::filesystem::absolute(path)), mOnChange(std::move(onChange)), mSettleTime(settleTime)
+{
+	if (!mOnChange)
+		throw std::invalid_argument("Config change callback cannot be empty");
+
+#ifdef __linux__
+	mInotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	mWakeFd	   = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	// Editors replace the file instead of writing it in place, so watch the directory for the name
+	if (mInotifyFd >= 0 && ::inotify_add_watch(mInotifyFd, mPath.parent_path().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+	{
+		::close(mInotifyFd);
+		mInotifyFd = -1;
+	}
+#endif
+
+	mThread = std::thread(&ConfigWatcher::run, this);
+}
+
+
+ConfigWatcher::~ConfigWatcher()
+{
+	{
+		std::lock_guard<std::mutex> lock(mStopMutex);
+		mStop = true;
+	}
+	mStopWake.notify_all();
+
+#ifdef __linux__
+	if (mWakeFd >= 0)
+	{
+		uint64_t one = 1;
+		[[maybe_unused]] auto written = ::write(mWakeFd, &one, sizeof(one));
+	}
+#endif
+
+	mThread.join();
+
+#ifdef __linux__
+	if (mInotifyFd >= 0)
+		::close(mInotifyFd);
+	if (mWakeFd >= 0)
+		::close(mWakeFd);
+#endif
+}
+
+
+void ConfigWatcher::run()
+{
+#ifdef __linux__
+	if (runInotify())
+		return;
+#endif
+
+	runPolling();
+}
+
+
+void ConfigWatcher::notify()
+{
+	try
+	{
+		mOnChange();
+	}
+	catch (const std::exception &ex)
+	{
+		std::fprintf(stderr, "[Logger] Handling a change of %s failed: %s\n", mPath.string().c_str(), ex.what());
+	}
+}
+
+
+#ifdef __linux__
+bool ConfigWatcher::runInotify()
+{
+	if (mInotifyFd < 0 || mWakeFd < 0)
+		return false; // Fall back to polling
+
+	const auto fileName = mPath.filename();
+	bool	   pending	= false;
+
+	while (true)
+	{
+		pollfd fds[2] = {{mInotifyFd, POLLIN, 0}, {mWakeFd, POLLIN, 0}};
+
+		// Block until something happens; once a change is pending, wait only until the writes settle
+		int	   ready  = ::poll(fds, 2, pending ? static_cast<int>(mSettleTime.count()) : -1);
+
+		if (ready < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			std::fprintf(stderr, "[Logger] Watching %s failed, falling back to polling\n", mPath.string().c_str());
+			runPolling();
+			return true;
+		}
+
+		if (fds[1].revents & POLLIN)
+			return true; // Shutdown
+
+		if (ready == 0)
+		{
+			pending = false;
+			notify();
+			continue;
+		}
+
+		alignas(inotify_event) char buffer[4096];
+		ssize_t						length;
+
+		while ((length = ::read(mInotifyFd, buffer, sizeof(buffer))) > 0)
+		{
+			for (char *next = buffer; next < buffer + length;)
+			{
+				auto *event = reinterpret_cast<inotify_event *>(next);
+				if (event->len > 0 && fileName == event->name)
+					pending = true;
+				next += sizeof(inotify_event) + event->len;
+			}
+		}
+	}
+}
+#endif
+
+
+void ConfigWatcher::runPolling()
+{
+	std::error_code error;
+	auto			lastWrite = std::filesystem::last_write_time(mPath, error);
+
+	std::unique_lock<std::mutex> lock(mStopMutex);
+
+	while (!mStopWake.wait_for(lock, std::max(mSettleTime, std::chrono::milliseconds(250)), [this] { return mStop; }))
+	{
+		auto currentWrite = std::filesystem::last_write_time(mPath, error);
+		if (error || currentWrite == lastWrite)
+			continue;
+
+		lastWrite = currentWrite;
+
+		lock.unlock();
+		notify();
+		lock.lock();
+	}
+}
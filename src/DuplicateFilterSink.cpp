@@ -0,0 +1,91 @@
+/*
+==============================================================================
+	Module			DuplicateFilterSink
+	Description		Sink wrapper suppressing repeated identical messages
+==============================================================================
+*/
+
+#include "DuplicateFilterSink.h"
+
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+
+#include "KeyValue.h"
+
+
+namespace
+{
+
+constexpr uint64_t FnvOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t FnvPrime		  = 1099511628211ULL;
+
+
+uint64_t		   hashBytes(uint64_t hash, const void *data, size_t size)
+{
+	auto bytes = static_cast<const unsigned char *>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= FnvPrime;
+	}
+	return hash;
+}
+
+} // namespace
+
+
+DuplicateFilterSink::DuplicateFilterSink(std::chrono::microseconds maxSkipDuration) : mMaxSkipDuration(maxSkipDuration) {}
+
+
+uint64_t DuplicateFilterSink::hashMessage(const spdlog::details::log_msg &msg)
+{
+	// Source file and function are static literals, so their addresses identify them
+	uint64_t hash = FnvOffsetBasis;
+	hash		  = hashBytes(hash, &msg.source.filename, sizeof(msg.source.filename));
+	hash		  = hashBytes(hash, &msg.source.line, sizeof(msg.source.line));
+	hash		  = hashBytes(hash, &msg.source.funcname, sizeof(msg.source.funcname));
+	hash		  = hashBytes(hash, msg.payload.data(), msg.payload.size());
+
+	// Structured messages only repeat if their fields do too
+	auto fields	  = logging::kv::currentFields();
+	hash		  = hashBytes(hash, fields.data(), fields.size());
+	return hash;
+}
+
+
+void DuplicateFilterSink::sink_it_(const spdlog::details::log_msg &msg)
+{
+	uint64_t hash = hashMessage(msg);
+
+	if (mHasLastMessage && hash == mLastMessageHash && msg.time - mLastMessageTime <= mMaxSkipDuration)
+	{
+		++mSkipCount;
+		return;
+	}
+
+	if (mSkipCount > 0)
+	{
+		constexpr std::string_view prefix = "Skipped ";
+		constexpr std::string_view suffix = " duplicate messages";
+
+		char					   buffer[64];
+		char					  *end	  = std::copy(prefix.begin(), prefix.end(), buffer);
+		end								  = std::to_chars(end, buffer + sizeof(buffer), mSkipCount).ptr;
+		end								  = std::copy(suffix.begin(), suffix.end(), end);
+
+		spdlog::details::log_msg skipped(msg.time, msg.source, msg.logger_name, msg.level, spdlog::string_view_t(buffer, static_cast<size_t>(end - buffer)));
+		skipped.thread_id = msg.thread_id;
+
+		// The notice is not part of the structured message that follows it
+		logging::kv::ScopedFields noFields(std::string_view{});
+		dist_sink<std::mutex>::sink_it_(skipped);
+	}
+
+	dist_sink<std::mutex>::sink_it_(msg);
+
+	mLastMessageHash = hash;
+	mLastMessageTime = msg.time;
+	mHasLastMessage	 = true;
+	mSkipCount		 = 0;
+}
@@ -7,41 +7,474 @@
 
 #include "Formatter.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
 #include <ctime>
 #include <format>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
 
+#include "KeyValue.h"
+#include "LoggerStats.h"
+#include "LoggerWrapper.h"
+#include "SharedRendering.h"
 
-Formatter::Formatter() {}
+
+namespace
+{
+
+// Column widths of the log line: "{:<25.25} {:>8} {:<8.8} {:<20.20} {:<45.45} {}"
+constexpr size_t			TimeWidth	  = 25;
+constexpr size_t			ThreadIdWidth = 8;
+constexpr size_t			LevelWidth	  = 8;
+constexpr size_t			FileNameWidth = 20;
+constexpr size_t			FunctionWidth = 45;
+
+constexpr std::string_view	Spaces		  = "                                                  "; // Longer than any column
+
+
+void appendSpaces(spdlog::memory_buf_t &dest, size_t count)
+{
+	while (count > 0)
+	{
+		size_t chunk = std::min(count, Spaces.size());
+		dest.append(Spaces.data(), Spaces.data() + chunk);
+		count -= chunk;
+	}
+}
+
+
+bool isAscii(std::string_view text)
+{
+	return std::all_of(text.begin(), text.end(), [](char c) { return static_cast<unsigned char>(c) < 0x80; });
+}
+
+
+// Pads and cuts by display width, like append_column does for non-ASCII text
+void appendPaddedByDisplayWidth(spdlog::memory_buf_t &dest, std::string_view text, char align, size_t width, bool truncate)
+{
+	auto out = std::back_inserter(dest);
+	if (truncate)
+		std::vformat_to(out, std::string("{:") + align + "{}.{}}", std::make_format_args(text, width, width));
+	else
+		std::vformat_to(out, std::string("{:") + align + "{}}", std::make_format_args(text, width));
+}
+
+
+// Zero-padded decimal of exactly `digits` digits
+std::string_view writeDigits(char *buffer, uint64_t value, size_t digits)
+{
+	for (size_t i = digits; i > 0; --i)
+	{
+		buffer[i - 1] = static_cast<char>('0' + value % 10);
+		value /= 10;
+	}
+	return std::string_view(buffer, digits);
+}
+
+
+// Longest text strftime writes for a flag spdlog also passes to strftime; 0 for other flags
+size_t secondsFlagLength(char flag)
+{
+	switch (flag)
+	{
+	case 'Y': return 5; // Room for a year past 9999
+	case 'C':
+	case 'y':
+	case 'm':
+	case 'd':
+	case 'H':
+	case 'I':
+	case 'M':
+	case 'S':
+	case 'p': return 2;
+	case 'a':
+	case 'b': return 8; // Abbreviated names can be longer than three characters in some locales
+	case 'R': return 5;
+	case 'z': return 5;
+	case 'D':
+	case 'T': return 8;
+	case 'r': return 14;
+	case 'A':
+	case 'B': return 16;
+	case 'c': return 40;
+	default: return 0;
+	}
+}
+
+
+// Appends one decoded field value (see kv::readValue) the way std::format writes it
+template <typename T>
+void appendFieldValue(spdlog::memory_buf_t &dest, T value)
+{
+	char buffer[32];
+
+	if constexpr (std::is_same_v<T, bool>)
+	{
+		std::string_view text = value ? "true" : "false";
+		dest.append(text.data(), text.data() + text.size());
+	}
+	else if constexpr (std::is_same_v<T, char>)
+		dest.push_back(value);
+	else if constexpr (std::is_same_v<T, std::string_view>)
+		logging::kv::appendTextString(dest, value);
+	else if constexpr (std::is_same_v<T, logging::kv::PointerValue>)
+	{
+		buffer[0]	= '0';
+		buffer[1]	= 'x';
+		auto result = std::to_chars(buffer + 2, buffer + sizeof(buffer), value.address, 16);
+		dest.append(buffer, result.ptr);
+	}
+	else
+	{
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		dest.append(buffer, result.ptr);
+	}
+}
+
+} // namespace
+
+
+Formatter::Formatter() : Formatter(logging::DefaultPattern) {}
+
+
+Formatter::Formatter(std::string_view pattern) : mLayout(SharedRendering::layoutId(pattern))
+{
+	compile(pattern);
+}
+
+
+void Formatter::compile(std::string_view pattern)
+{
+	// The default layout has a hand-written implementation below
+	mDefaultLayout = pattern == logging::DefaultPattern;
+	if (mDefaultLayout)
+		return;
+
+	auto invalid = [&](const std::string &reason) { return std::invalid_argument(reason + " in log pattern \"" + std::string(pattern) + "\""); };
+
+	auto addLiteral = [this](std::string_view text)
+	{
+		if (!mProgram.empty() && mProgram.back().field == Field::Literal && mProgram.back().offset + mProgram.back().length == mLiterals.size())
+			mProgram.back().length += static_cast<uint32_t>(text.size());
+		else
+			mProgram.push_back({Field::Literal, Align::None, false, 0, static_cast<uint32_t>(mLiterals.size()), static_cast<uint32_t>(text.size())});
+		mLiterals.append(text);
+	};
+
+	for (size_t pos = 0; pos < pattern.size();)
+	{
+		if (pattern[pos] != '%')
+		{
+			size_t next = std::min(pattern.find('%', pos), pattern.size());
+			addLiteral(pattern.substr(pos, next - pos));
+			pos = next;
+			continue;
+		}
+
+		// %[-|=][width][!]flag
+		Op op;
+		++pos;
+		if (pos < pattern.size() && (pattern[pos] == '-' || pattern[pos] == '='))
+			op.align = pattern[pos++] == '-' ? Align::Left : Align::Center;
+
+		size_t width	= 0;
+		bool   hasWidth = false;
+		for (; pos < pattern.size() && pattern[pos] >= '0' && pattern[pos] <= '9'; ++pos)
+		{
+			width	 = width * 10 + static_cast<size_t>(pattern[pos] - '0');
+			hasWidth = true;
+			if (width > UINT16_MAX)
+				throw invalid("Padding too wide");
+		}
+
+		// A '!' right after the width cuts; otherwise it is the function flag
+		if (hasWidth && pos + 1 < pattern.size() && pattern[pos] == '!')
+		{
+			op.truncate = true;
+			++pos;
+		}
+
+		if (pos >= pattern.size())
+			throw invalid("Unfinished flag");
+		if (op.align != Align::None && !hasWidth)
+			throw invalid("Alignment without a width");
+		if (hasWidth && op.align == Align::None)
+			op.align = Align::Right;
+		op.width  = static_cast<uint16_t>(width);
+
+		char flag = pattern[pos++];
+		if (size_t maxLength = secondsFlagLength(flag))
+		{
+			op.field  = Field::SecondsText;
+			op.offset = static_cast<uint32_t>(mSecondsTexts.size());
+			mSecondsTexts.push_back({std::string{'%', flag}, maxLength});
+			mProgram.push_back(op);
+			continue;
+		}
+
+		switch (flag)
+		{
+		case '%': addLiteral("%"); continue;
+		case 'e': op.field = Field::Milliseconds; break;
+		case 'f': op.field = Field::Microseconds; break;
+		case 'F': op.field = Field::Nanoseconds; break;
+		case 'l': op.field = Field::Level; break;
+		case 'L': op.field = Field::ShortLevel; break;
+		case 't': op.field = Field::Thread; break;
+		case 'n': op.field = Field::LoggerName; break;
+		case 's': op.field = Field::Basename; break;
+		case 'g': op.field = Field::Path; break;
+		case '#': op.field = Field::Line; break;
+		case '!': op.field = Field::Function; break;
+		case 'v': op.field = Field::Payload; break;
+		case '^': op.field = Field::ColorStart; break;
+		case '$': op.field = Field::ColorEnd; break;
+		default: throw invalid(std::string("Unknown flag %") + flag);
+		}
+		mProgram.push_back(op);
+	}
+
+	/*
+	 *	Merge runs like "%Y-%m-%d %H:%M:%S" into one strftime format. They only change once per second, so the
+	 *	whole run is rendered on a new second and copied as one piece otherwise.
+	 */
+	auto unpaddedSeconds = [](const Op &op) { return op.field == Field::SecondsText && op.align == Align::None; };
+
+	std::vector<Op> merged;
+	for (const auto &op : mProgram)
+	{
+		if (unpaddedSeconds(op) && !merged.empty())
+		{
+			auto &run = mSecondsTexts[op.offset];
+
+			// Directly after a run, or after a literal that follows one
+			Op	 *previous = &merged.back();
+			std::string_view between;
+			if (previous->field == Field::Literal && merged.size() >= 2 && unpaddedSeconds(merged[merged.size() - 2]))
+			{
+				between	 = std::string_view(mLiterals).substr(previous->offset, previous->length);
+				previous = &merged[merged.size() - 2];
+			}
+
+			auto fits = [&](const SecondsText &target) { return target.maxLength + between.size() + run.maxLength < sizeof(target.text); };
+			if (unpaddedSeconds(*previous) && fits(mSecondsTexts[previous->offset]))
+			{
+				auto &target = mSecondsTexts[previous->offset];
+				for (char c : between)
+				{
+					target.format += c;
+					if (c == '%')
+						target.format += '%';
+				}
+				target.format += run.format;
+				target.maxLength += between.size() + run.maxLength;
+
+				if (!between.empty())
+					merged.pop_back();
+				continue;
+			}
+		}
+		merged.push_back(op);
+	}
+	mProgram = std::move(merged);
+}
 
 
 void Formatter::format(const spdlog::details::log_msg &msg, spdlog::memory_buf_t &dest)
 {
-	auto  timeString  = format_time(msg.time);
-	auto &levelString = spdlog::level::to_string_view(msg.level);
-	auto  threadID	  = msg.thread_id;
-	auto  fileName	  = get_basename_no_ext(msg.source.filename);
+	LoggerStats::Format stats(dest);
+
+	// Another sink with this layout may already have rendered the message
+	if (SharedRendering::copyTo(msg, mLayout, dest))
+		return;
+
+	// The color range is this layout's own, not one left behind by another sink's formatter
+	msg.color_range_start = 0;
+	msg.color_range_end	  = 0;
+
+	size_t begin		  = dest.size();
+	render(msg, dest);
+	SharedRendering::keep(msg, mLayout, dest, begin);
+}
+
 
-	auto		funcName = (msg.source.funcname ? msg.source.funcname : "");
+void Formatter::render(const spdlog::details::log_msg &msg, spdlog::memory_buf_t &dest)
+{
+	if (!mDefaultLayout)
+	{
+		runProgram(msg, dest);
+		return;
+	}
+
+	char   timeBuffer[32];
+	size_t timeLength = format_time(msg.time, timeBuffer, sizeof(timeBuffer));
+	append_column(dest, std::string_view(timeBuffer, timeLength), TimeWidth);
+	dest.push_back(' ');
 
-	std::string userMessage(msg.payload.begin(), msg.payload.end());
+	// Thread ID is right-aligned and never truncated
+	char threadBuffer[24];
+	auto threadResult = std::to_chars(threadBuffer, threadBuffer + sizeof(threadBuffer), msg.thread_id);
+	auto threadLength = static_cast<size_t>(threadResult.ptr - threadBuffer);
+	if (threadLength < ThreadIdWidth)
+		appendSpaces(dest, ThreadIdWidth - threadLength);
+	dest.append(threadBuffer, threadResult.ptr);
+	dest.push_back(' ');
+
+	// spdlog::level::to_string_view() returns spdlog's own (fmt-based) string_view type - convert to std::string_view
+	auto &levelString = spdlog::level::to_string_view(msg.level);
+	append_column(dest, std::string_view(levelString.data(), levelString.size()), LevelWidth);
+	dest.push_back(' ');
 
-	// spdlog::level::to_string_view() returns spdlog's own (fmt-based) string_view type, which
-	// std::format has no formatter for - convert to std::string_view before passing it along.
-	std::string_view levelView(levelString.data(), levelString.size());
+	append_column(dest, cached_basename(msg.source.filename), FileNameWidth);
+	dest.push_back(' ');
 
-	auto		formatted_line = std::format("{:<25.25} {:>8} {:<8.8} {:<20.20} {:<45.45} {}", timeString, threadID, levelView, fileName, funcName, userMessage);
+	append_column(dest, msg.source.funcname ? msg.source.funcname : "", FunctionWidth);
+	dest.push_back(' ');
 
-	std::format_to(std::back_inserter(dest), "{}\n", formatted_line);
+	dest.append(msg.payload.begin(), msg.payload.end());
+	appendFields(dest, logging::kv::currentFields());
+	dest.push_back('\n');
 }
 
 
 std::unique_ptr<spdlog::formatter> Formatter::clone() const
 {
-	return std::make_unique<Formatter>();
+	return std::make_unique<Formatter>(*this);
+}
+
+
+void Formatter::appendFields(spdlog::memory_buf_t &dest, std::string_view fields)
+{
+	while (!fields.empty())
+	{
+		std::string_view		 key;
+		logging::binary::ArgType type{};
+
+		if (!logging::kv::readKey(fields, key, type))
+			return;
+
+		dest.push_back(' ');
+		dest.append(key.data(), key.data() + key.size());
+		dest.push_back('=');
+
+		if (!logging::kv::readValue(fields, type, [&dest](auto value) { appendFieldValue(dest, value); }))
+			return;
+	}
+}
+
+
+void Formatter::runProgram(const spdlog::details::log_msg &msg, spdlog::memory_buf_t &dest)
+{
+	if (!mSecondsTexts.empty())
+		updateSecond(static_cast<std::time_t>(std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch()).count()));
+
+	char buffer[24];
+	for (const auto &op : mProgram)
+	{
+		switch (op.field)
+		{
+		case Field::Literal: dest.append(mLiterals.data() + op.offset, mLiterals.data() + op.offset + op.length); break;
+		case Field::ColorStart: msg.color_range_start = dest.size(); break;
+		case Field::ColorEnd: msg.color_range_end = dest.size(); break;
+		case Field::Payload:
+		{
+			auto fields = logging::kv::currentFields();
+			if (fields.empty() || op.align == Align::None)
+			{
+				dest.append(msg.payload.begin(), msg.payload.end());
+				appendFields(dest, fields);
+				break;
+			}
+
+			// Padding applies to the message and its fields together
+			spdlog::memory_buf_t text;
+			text.append(msg.payload.begin(), msg.payload.end());
+			appendFields(text, fields);
+			append_padded(dest, std::string_view(text.data(), text.size()), op);
+			break;
+		}
+		default:
+		{
+			auto text = fieldText(op, msg, buffer, sizeof(buffer));
+			if (op.align == Align::None)
+				dest.append(text.data(), text.data() + text.size());
+			else
+				append_padded(dest, text, op);
+		}
+		}
+	}
+
+	dest.push_back('\n');
+}
+
+
+std::string_view Formatter::fieldText(const Op &op, const spdlog::details::log_msg &msg, char *buffer, size_t size)
+{
+	using namespace std::chrono;
+
+	auto sinceSecond = [&msg] { return msg.time.time_since_epoch() - duration_cast<seconds>(msg.time.time_since_epoch()); };
+
+	switch (op.field)
+	{
+	case Field::SecondsText:
+	{
+		const auto &seconds = mSecondsTexts[op.offset];
+		return std::string_view(seconds.text, seconds.length);
+	}
+	case Field::Milliseconds: return writeDigits(buffer, static_cast<uint64_t>(duration_cast<milliseconds>(sinceSecond()).count()), 3);
+	case Field::Microseconds: return writeDigits(buffer, static_cast<uint64_t>(duration_cast<microseconds>(sinceSecond()).count()), 6);
+	case Field::Nanoseconds: return writeDigits(buffer, static_cast<uint64_t>(duration_cast<nanoseconds>(sinceSecond()).count()), 9);
+	case Field::Level:
+	{
+		auto &level = spdlog::level::to_string_view(msg.level);
+		return std::string_view(level.data(), level.size());
+	}
+	case Field::ShortLevel: return spdlog::level::to_short_c_str(msg.level);
+	case Field::Thread:
+	{
+		auto result = std::to_chars(buffer, buffer + size, msg.thread_id);
+		return std::string_view(buffer, static_cast<size_t>(result.ptr - buffer));
+	}
+	case Field::LoggerName: return std::string_view(msg.logger_name.data(), msg.logger_name.size());
+	case Field::Basename: return cached_basename(msg.source.filename);
+	case Field::Path: return msg.source.filename ? msg.source.filename : "";
+	case Field::Line:
+	{
+		auto result = std::to_chars(buffer, buffer + size, msg.source.line);
+		return std::string_view(buffer, static_cast<size_t>(result.ptr - buffer));
+	}
+	case Field::Function: return msg.source.funcname ? msg.source.funcname : "";
+	default: return {};
+	}
+}
+
+
+void Formatter::updateSecond(std::time_t t)
+{
+	// Same rule as format_time: UTC offset changes happen on a second boundary
+	if (mCacheValid && t == mCachedSecond)
+		return;
+
+	std::tm tm_local;
+
+#if defined(_WIN32)
+	localtime_s(&tm_local, &t);
+#else
+	localtime_r(&t, &tm_local);
+#endif
+
+	for (auto &seconds : mSecondsTexts)
+		seconds.length = std::strftime(seconds.text, sizeof(seconds.text), seconds.format.c_str(), &tm_local);
+
+	mCachedSecond = t;
+	mCacheValid	  = true;
 }
 
 
-std::string Formatter::format_time(const spdlog::log_clock::time_point &tp)
+size_t Formatter::format_time(const spdlog::log_clock::time_point &tp, char *buffer, size_t size)
 {
 	using namespace std::chrono;
 
@@ -50,23 +483,41 @@ std::string Formatter::format_time(const spdlog::log_clock::time_point &tp)
 	auto		ms		 = duration_cast<milliseconds>(duration) - duration_cast<milliseconds>(secs);
 
 	std::time_t t		 = static_cast<std::time_t>(secs.count());
-	std::tm		tm_local;
+
+	// UTC offset changes (DST) happen on a second boundary, so rebuilding on a new second also picks them up
+	if (!mCacheValid || t != mCachedSecond)
+	{
+		std::tm tm_local;
 
 #if defined(_WIN32)
-	localtime_s(&tm_local, &t);
+		localtime_s(&tm_local, &t);
 #else
-	localtime_r(&t, &tm_local);
+		localtime_r(&t, &tm_local);
 #endif
 
-	char dateTimeBuf[64];
-	std::strftime(dateTimeBuf, sizeof(dateTimeBuf), "%Y-%m-%d %H:%M:%S", &tm_local);
+		mCachedPrefixLength = std::strftime(mCachedPrefix, sizeof(mCachedPrefix), "%Y-%m-%d %H:%M:%S", &tm_local);
+		mCachedSecond		= t;
+		mCacheValid			= true;
+	}
+
+	size_t length = std::min(mCachedPrefixLength, size);
+	std::copy_n(mCachedPrefix, length, buffer);
 
 	// Append milliseconds, e.g. "2024-12-23 13:13:55.123"
-	return std::format("{}.{:03}", dateTimeBuf, ms.count());
+	if (length + 4 <= size)
+	{
+		auto millis		 = static_cast<int>(ms.count());
+		buffer[length++] = '.';
+		buffer[length++] = static_cast<char>('0' + millis / 100);
+		buffer[length++] = static_cast<char>('0' + millis / 10 % 10);
+		buffer[length++] = static_cast<char>('0' + millis % 10);
+	}
+
+	return length;
 }
 
 
-std::string Formatter::get_basename_no_ext(const char *fullpath)
+std::string_view Formatter::get_basename_no_ext(const char *fullpath)
 {
 	if (!fullpath || !*fullpath)
 		return "Unknown File";
@@ -80,5 +531,54 @@ std::string Formatter::get_basename_no_ext(const char *fullpath)
 	if (dotPos != std::string_view::npos)
 		sv.remove_suffix(sv.size() - dotPos);
 
-	return std::string(sv);
+	return sv;
+}
+
+
+std::string_view Formatter::cached_basename(const char *fullpath)
+{
+	// __FILE__ literals have static storage, so their address identifies the file and the view stays valid
+	auto  slot	= (reinterpret_cast<std::uintptr_t>(fullpath) >> 4) % mBasenames.size();
+	auto &entry = mBasenames[slot];
+
+	if (entry.path != fullpath || !fullpath)
+	{
+		entry.path	   = fullpath;
+		entry.basename = get_basename_no_ext(fullpath);
+	}
+
+	return entry.basename;
+}
+
+
+void Formatter::append_column(spdlog::memory_buf_t &dest, std::string_view text, size_t width)
+{
+	if (!isAscii(text))
+	{
+		// std::format pads and truncates by display width, not bytes - let it handle non-ASCII text
+		std::format_to(std::back_inserter(dest), "{:<{}.{}}", text, width, width);
+		return;
+	}
+
+	size_t length = std::min(text.size(), width);
+	dest.append(text.data(), text.data() + length);
+	appendSpaces(dest, width - length);
+}
+
+
+void Formatter::append_padded(spdlog::memory_buf_t &dest, std::string_view text, const Op &op)
+{
+	if (!isAscii(text))
+	{
+		appendPaddedByDisplayWidth(dest, text, op.align == Align::Left ? '<' : op.align == Align::Center ? '^' : '>', op.width, op.truncate);
+		return;
+	}
+
+	size_t length  = op.truncate ? std::min<size_t>(text.size(), op.width) : text.size();
+	size_t padding = op.width > length ? op.width - length : 0;
+	size_t before  = op.align == Align::Right ? padding : op.align == Align::Center ? padding / 2 : 0;
+
+	appendSpaces(dest, before);
+	dest.append(text.data(), text.data() + length);
+	appendSpaces(dest, padding - before);
 }
@@ -0,0 +1,218 @@
+/*
+==============================================================================
+	Module			JsonFormatter
+	Description		Formats log messages as JSON Lines
+==============================================================================
+*/
+
+#include "JsonFormatter.h"
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include <spdlog/details/os.h>
+
+#include "KeyValue.h"
+#include "LoggerStats.h"
+
+
+namespace
+{
+
+using logging::binary::ArgType;
+
+
+void append(spdlog::memory_buf_t &dest, std::string_view text)
+{
+	dest.append(text.data(), text.data() + text.size());
+}
+
+
+template <typename T>
+void appendNumber(spdlog::memory_buf_t &dest, T value)
+{
+	if constexpr (std::is_floating_point_v<T>)
+	{
+		// JSON has no representation for these
+		if (!std::isfinite(value))
+		{
+			append(dest, "null");
+			return;
+		}
+	}
+
+	char buffer[32];
+	auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	dest.append(buffer, result.ptr);
+}
+
+
+std::string_view levelName(spdlog::level::level_enum level)
+{
+	// Same names as the JSON configuration
+	switch (level)
+	{
+	case spdlog::level::trace: return "trace";
+	case spdlog::level::debug: return "debug";
+	case spdlog::level::info: return "info";
+	case spdlog::level::warn: return "warn";
+	case spdlog::level::err: return "error";
+	case spdlog::level::critical: return "critical";
+	default: return "off";
+	}
+}
+
+
+// Appends one decoded field value (see kv::readValue)
+template <typename T>
+void appendValue(spdlog::memory_buf_t &dest, T value)
+{
+	if constexpr (std::is_same_v<T, bool>)
+		append(dest, value ? "true" : "false");
+	else if constexpr (std::is_same_v<T, char>)
+		JsonFormatter::appendString(dest, std::string_view(&value, 1));
+	else if constexpr (std::is_same_v<T, std::string_view>)
+		JsonFormatter::appendString(dest, value);
+	else if constexpr (std::is_same_v<T, logging::kv::PointerValue>)
+	{
+		// Same text as std::format's pointer output
+		char buffer[24] = "0x";
+		auto result		= std::to_chars(buffer + 2, buffer + sizeof(buffer), value.address, 16);
+		JsonFormatter::appendString(dest, std::string_view(buffer, result.ptr));
+	}
+	else
+		appendNumber(dest, value);
+}
+
+} // namespace
+
+
+void JsonFormatter::format(const spdlog::details::log_msg &msg, spdlog::memory_buf_t &dest)
+{
+	LoggerStats::Format stats(dest);
+
+	append(dest, "{\"time\":\"");
+	appendTime(dest, msg.time);
+	append(dest, "\",\"level\":\"");
+	append(dest, levelName(msg.level));
+	append(dest, "\",\"thread\":");
+	appendNumber(dest, msg.thread_id);
+
+	if (!msg.source.empty())
+	{
+		append(dest, ",\"file\":");
+		appendString(dest, msg.source.filename);
+		append(dest, ",\"line\":");
+		appendNumber(dest, msg.source.line);
+		append(dest, ",\"function\":");
+		appendString(dest, msg.source.funcname ? msg.source.funcname : "");
+	}
+
+	append(dest, ",\"message\":");
+	appendString(dest, std::string_view(msg.payload.data(), msg.payload.size()));
+
+	appendFields(dest, logging::kv::currentFields());
+
+	append(dest, "}\n");
+}
+
+
+std::unique_ptr<spdlog::formatter> JsonFormatter::clone() const
+{
+	return std::make_unique<JsonFormatter>();
+}
+
+
+void JsonFormatter::appendString(spdlog::memory_buf_t &dest, std::string_view text)
+{
+	static constexpr char Hex[] = "0123456789abcdef";
+
+	dest.push_back('"');
+
+	// Copy runs of characters that need no escaping in one go
+	const char *runStart = text.data();
+	const char *end		 = text.data() + text.size();
+
+	for (const char *c = runStart; c != end; ++c)
+	{
+		auto byte = static_cast<unsigned char>(*c);
+		if (byte >= 0x20 && byte != '"' && byte != '\\')
+			continue;
+
+		dest.append(runStart, c);
+		runStart = c + 1;
+
+		switch (byte)
+		{
+		case '"': append(dest, "\\\""); break;
+		case '\\': append(dest, "\\\\"); break;
+		case '\n': append(dest, "\\n"); break;
+		case '\r': append(dest, "\\r"); break;
+		case '\t': append(dest, "\\t"); break;
+		case '\b': append(dest, "\\b"); break;
+		case '\f': append(dest, "\\f"); break;
+		default:
+		{
+			char escaped[] = {'\\', 'u', '0', '0', Hex[byte >> 4], Hex[byte & 0xF]};
+			dest.append(escaped, escaped + sizeof(escaped));
+		}
+		}
+	}
+
+	dest.append(runStart, end);
+	dest.push_back('"');
+}
+
+
+void JsonFormatter::appendFields(spdlog::memory_buf_t &dest, std::string_view fields)
+{
+	while (!fields.empty())
+	{
+		std::string_view key;
+		ArgType			 type{};
+
+		if (!logging::kv::readKey(fields, key, type))
+			return;
+
+		dest.push_back(',');
+		appendString(dest, key);
+		dest.push_back(':');
+
+		if (!logging::kv::readValue(fields, type, [&dest](auto value) { appendValue(dest, value); }))
+		{
+			// Truncated or unknown value: keep the line valid JSON and stop
+			append(dest, "null");
+			return;
+		}
+	}
+}
+
+
+void JsonFormatter::appendTime(spdlog::memory_buf_t &dest, spdlog::log_clock::time_point time)
+{
+	using namespace std::chrono;
+
+	auto sinceEpoch = time.time_since_epoch();
+	auto seconds	= duration_cast<std::chrono::seconds>(sinceEpoch);
+	auto second		= static_cast<std::time_t>(seconds.count());
+
+	if (!mCacheValid || second != mCachedSecond)
+	{
+		std::tm tm = spdlog::details::os::gmtime(second);
+		std::strftime(mCachedPrefix, sizeof(mCachedPrefix), "%Y-%m-%dT%H:%M:%S", &tm);
+		mCachedSecond = second;
+		mCacheValid	  = true;
+	}
+
+	append(dest, mCachedPrefix);
+
+	// Microseconds, zero-padded to six digits
+	auto micros		  = static_cast<unsigned>(duration_cast<microseconds>(sinceEpoch - seconds).count());
+	char fraction[]	  = {'.', '0', '0', '0', '0', '0', '0', 'Z'};
+	for (int i = 6; i > 0 && micros > 0; --i, micros /= 10)
+		fraction[i] = static_cast<char>('0' + micros % 10);
+	dest.append(fraction, fraction + sizeof(fraction));
+}
@@ -9,9 +9,10 @@
 #include "Helper.h"
 
 #include <nlohmann/json.hpp>
+#include <cstdio>
 #include <fstream>
+#include <map>
 #include <mutex>
-#include <vector>
 
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -19,9 +20,24 @@
 #include <spdlog/sinks/msvc_sink.h>
 #include <spdlog/formatter.h>
 #include <spdlog/details/log_msg.h>
-
+#include <spdlog/details/os.h>
+
+#include "AsyncWriter.h"
+#include "BatchedFileSink.h"
+#include "StagingWriter.h"
+#include "BinaryLogWriter.h"
+#include "CategoryRegistry.h"
+#include "ConfigWatcher.h"
+#include "DuplicateFilterSink.h"
+#include "MmapFileSink.h"
+#include "RingBufferSink.h"
+#include "SinkList.h"
 #include "Formatter.h"
+#include "JsonFormatter.h"
+#include "KeyValue.h"
 #include "LoggerConfig.h"
+#include "LoggerRegistry.h"
+#include "LoggerStats.h"
 #include "LoggerJSONConfigNames.h" // Defined names for JSON settings via CMake
 
 
@@ -43,6 +59,21 @@ spdlog::level::level_enum toSpdLogLevel(LogLevel level)
 }
 
 
+LogLevel fromSpdLogLevel(spdlog::level::level_enum level)
+{
+	switch (level)
+	{
+	case spdlog::level::trace: return LogLevel::Trace;
+	case spdlog::level::debug: return LogLevel::Debug;
+	case spdlog::level::info: return LogLevel::Info;
+	case spdlog::level::warn: return LogLevel::Warn;
+	case spdlog::level::err: return LogLevel::Error;
+	case spdlog::level::critical: return LogLevel::Critical;
+	default: return LogLevel::Off;
+	}
+}
+
+
 LogLevel toLogLevel(const std::string &level)
 {
 	if (level == "trace")
@@ -57,20 +88,98 @@ LogLevel toLogLevel(const std::string &level)
 		return LogLevel::Error;
 	if (level == "critical")
 		return LogLevel::Critical;
+	if (level == "off")
+		return LogLevel::Off;
 	throw std::invalid_argument("Invalid log level: " + level);
 }
 
 
+OverflowPolicy toOverflowPolicy(const std::string &policy)
+{
+	if (policy == "block")
+		return OverflowPolicy::Block;
+	if (policy == "drop_newest")
+		return OverflowPolicy::DropNewest;
+	if (policy == "drop_oldest")
+		return OverflowPolicy::DropOldest;
+	throw std::invalid_argument("Invalid overflow policy: " + policy);
+}
+
+
+Codec toCodec(const std::string &codec)
+{
+	if (codec == "none")
+		return Codec::None;
+	if (codec == "lz4")
+		return Codec::LZ4;
+	throw std::invalid_argument("Invalid compression codec: " + codec);
+}
+
+
+AsyncMode toAsyncMode(const std::string &mode)
+{
+	if (mode == "shared")
+		return AsyncMode::SharedQueue;
+	if (mode == "per_thread")
+		return AsyncMode::PerThread;
+	throw std::invalid_argument("Invalid async mode: " + mode);
+}
+
+
 // private data structure that holds our spdlog objects
 class LoggerImpl::ImplData
 {
 public:
 	std::shared_ptr<spdlog::logger> logger;
-	std::vector<spdlog::sink_ptr>	sinks;
-	std::mutex						mtx; // For thread-safe sink registration
+	std::shared_ptr<SinkList>		sinks; // The logger's only sink; outputs are added to and removed from it
+	std::mutex						mtx;   // Serializes configuration changes, never taken while logging
+	CategoryRegistry				categories{minimumLevel.load()};
+	LoggerRegistry					loggers; // Named loggers, each with its own sink list
+
+	// Set once asynchronous mode is enabled. Declared last so the writer drains before the sinks go away.
+	std::unique_ptr<AsyncWriter>	asyncWriter;
+	std::atomic<AsyncWriter *>		async{nullptr};
+	std::unique_ptr<StagingWriter>	stagingWriter;
+	std::atomic<StagingWriter *>	staging{nullptr};
+
+	// Set while a binary file output is registered
+	std::unique_ptr<BinaryLogWriter> binaryWriter;
+	std::atomic<BinaryLogWriter *>	 binary{nullptr};
+	OutputHandle					 binaryHandle = OutputHandle::Invalid;
+
+	// Removed binary writers, closed but kept allocated: a logging thread may still hold the pointer
+	std::vector<std::unique_ptr<BinaryLogWriter>> closedBinaryWriters;
+
+	// Ring of the most recently added ring buffer output, written out by dumpRing()
+	std::shared_ptr<RingBufferSink>	 ringBuffer;
+
+	// Outputs created from the watched config file, keyed by their settings without the level
+	struct WatchedOutput
+	{
+		OutputHandle handle;
+		LogLevel	 level;
+		bool		 binary = false; // Only one can exist, so it is removed before its replacement is added
+	};
+	std::map<std::string, WatchedOutput> watchedOutputs;
+	bool								 watchedCategories = false; // Whether the watched file configures categories
+	bool								 watchedLoggers	   = false; // Whether the watched file configures logger levels
+	std::mutex							 configMtx; // Serializes reloads, taken before mtx
+
+	// Declared last so no reload runs while the rest is torn down
+	std::unique_ptr<ConfigWatcher>		 configWatcher;
 };
 
 
+// Lowers a published level threshold; thresholds only ever go down as outputs are added
+void lowerLevel(std::atomic<LogLevel> &threshold, LogLevel level)
+{
+	if (level < threshold.load(std::memory_order_relaxed))
+	{
+		threshold.store(level, std::memory_order_relaxed);
+	}
+}
+
+
 LoggerImpl &LoggerImpl::GetInstance()
 {
 	static LoggerImpl sInstance;
@@ -80,75 +189,370 @@ LoggerImpl &LoggerImpl::GetInstance()
 
 LoggerImpl::LoggerImpl() : data(std::make_unique<ImplData>())
 {
-	data->logger = std::make_shared<spdlog::logger>("Logger", data->sinks.begin(), data->sinks.end());
+	data->sinks	 = std::make_shared<SinkList>();
+	data->logger = std::make_shared<spdlog::logger>("Logger", data->sinks);
 	spdlog::register_logger(data->logger);
 }
 
 
-void LoggerImpl::addConsoleOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &pattern)
+// Wraps the sink in a DuplicateFilterSink if repeated messages should be suppressed
+spdlog::sink_ptr withDuplicateFilter(const spdlog::sink_ptr &sink, LogLevel level, std::chrono::microseconds maxSkipDuration)
 {
-	auto sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-	sink->set_pattern(pattern);
-	sink->set_level(toSpdLogLevel(level));
-	sink->set_formatter(std::make_unique<Formatter>());
+	if (maxSkipDuration.count() <= 0)
+		return sink;
+
+	auto filter = std::make_shared<DuplicateFilterSink>(maxSkipDuration);
+	filter->add_sink(sink);
+	filter->set_level(toSpdLogLevel(level));
+	return filter;
+}
+
 
+OutputHandle LoggerImpl::registerSink(const spdlog::sink_ptr &sink, LogLevel level, const Logger &logger, std::string name)
+{
+	std::lock_guard<std::mutex> lock(data->mtx);
+
+	if (logger.mLogger)
 	{
-		std::lock_guard<std::mutex> lock(data->mtx);
-		data->sinks.push_back(sink);
-		data->logger->sinks() = data->sinks;
+		auto handle = static_cast<OutputHandle>(logger.mLogger->sinks->add(sink, std::move(name)));
+		data->loggers.publish(*logger.mLogger);
+		return handle;
+	}
 
-		auto spdLevel		  = toSpdLogLevel(level);
-		if (data->logger->level() > spdLevel)
-		{
-			data->logger->set_level(spdLevel);
-		}
+	auto handle = static_cast<OutputHandle>(data->sinks->add(sink, std::move(name)));
+
+	auto						spdLevel = toSpdLogLevel(level);
+	if (data->logger->level() > spdLevel)
+	{
+		data->logger->set_level(spdLevel);
 	}
+
+	// Publish the logger's effective level so the macros can filter before formatting
+	lowerLevel(minimumTextLevel, level);
+	lowerLevel(minimumLevel, level);
+	data->categories.setMinimumLevel(minimumLevel.load(std::memory_order_relaxed));
+	return handle;
 }
 
 
-void LoggerImpl::addFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles, bool rotateOnSession)
+bool LoggerImpl::removeOutput(OutputHandle handle)
 {
-	if (fileName.empty())
-		throw std::invalid_argument("File name cannot be empty");
+	std::lock_guard<std::mutex> lock(data->mtx);
 
-	auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(fileName, maxFileSize, maxFiles, rotateOnSession);
-	sink->set_level(toSpdLogLevel(level));
-	sink->set_formatter(std::make_unique<Formatter>());
+	if (handle != OutputHandle::Invalid && handle == data->binaryHandle)
+	{
+		data->binary.store(nullptr, std::memory_order_release);
+		data->binaryWriter->close();
+		data->closedBinaryWriters.push_back(std::move(data->binaryWriter));
+		data->binaryHandle = OutputHandle::Invalid;
+
+		minimumBinaryLevel.store(LogLevel::Off, std::memory_order_relaxed);
+		updateLevels();
+		return true;
+	}
 
+	// The removed sink may have been the only one at its level
+	if (data->sinks->remove(static_cast<uint64_t>(handle)))
 	{
-		std::lock_guard<std::mutex> lock(data->mtx);
-		data->sinks.push_back(sink);
-		data->logger->sinks() = data->sinks;
+		updateLevels();
+		return true;
+	}
+
+	auto *owner = data->loggers.ownerOf(static_cast<uint64_t>(handle));
+	if (!owner || !owner->sinks->remove(static_cast<uint64_t>(handle)))
+		return false;
+
+	data->loggers.publish(*owner);
+	return true;
+}
+
+
+bool LoggerImpl::setOutputLevel(OutputHandle handle, LogLevel level)
+{
+	std::lock_guard<std::mutex> lock(data->mtx);
+
+	// The binary output is the only one at minimumBinaryLevel
+	if (handle != OutputHandle::Invalid && handle == data->binaryHandle)
+	{
+		minimumBinaryLevel.store(level, std::memory_order_relaxed);
+		updateLevels();
+		return true;
+	}
+
+	// Handles are unique across loggers, so the output is either the default logger's or a named logger's
+	auto						sink  = data->sinks->find(static_cast<uint64_t>(handle));
+	NamedLogger				   *owner = sink ? nullptr : data->loggers.ownerOf(static_cast<uint64_t>(handle));
+	if (owner)
+		sink = owner->sinks->find(static_cast<uint64_t>(handle));
+	if (!sink)
+		return false;
 
-		auto spdLevel		  = toSpdLogLevel(level);
-		if (data->logger->level() > spdLevel)
+	sink->set_level(toSpdLogLevel(level));
+
+	// The duplicate filter hands messages on to the wrapped sink, which checks its own level again
+	if (auto filter = std::dynamic_pointer_cast<DuplicateFilterSink>(sink))
+	{
+		for (auto &wrapped : filter->sinks())
 		{
-			data->logger->set_level(spdLevel);
+			wrapped->set_level(toSpdLogLevel(level));
 		}
 	}
+
+	if (owner)
+		data->loggers.publish(*owner);
+	else
+		updateLevels();
+	return true;
 }
 
 
-void LoggerImpl::addMSVCOutput(LogLevel level, bool checkForDebuggerPresent, std::chrono::microseconds maxSkipDuration)
+void LoggerImpl::updateLevels()
+{
+	// Unlike registerSink, this may also raise the thresholds to what the remaining outputs accept
+	auto textLevel = fromSpdLogLevel(data->sinks->lowestLevel());
+	data->logger->set_level(toSpdLogLevel(textLevel));
+	minimumTextLevel.store(textLevel, std::memory_order_relaxed);
+	minimumLevel.store(std::min(textLevel, minimumBinaryLevel.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+	data->categories.setMinimumLevel(minimumLevel.load(std::memory_order_relaxed));
+}
+
+
+std::atomic<LogLevel> &LoggerImpl::categoryThreshold(std::string_view category)
+{
+	return data->categories.threshold(category);
+}
+
+
+void LoggerImpl::setCategoryLevel(std::string_view category, LogLevel level)
+{
+	data->categories.setLevel(category, level);
+}
+
+
+void LoggerImpl::setDefaultCategoryLevel(LogLevel level)
+{
+	data->categories.setDefaultLevel(level);
+	defaultCategoryLevel.store(level, std::memory_order_relaxed);
+}
+
+
+Logger LoggerImpl::getLogger(std::string_view name)
+{
+	auto &logger = data->loggers.get(name);
+	return Logger(&logger, &logger.threshold);
+}
+
+
+void LoggerImpl::setLoggerLevel(const Logger &logger, LogLevel level)
+{
+	if (!logger.mLogger)
+		throw std::logic_error("The default logger has no level of its own, set the level of its outputs instead");
+
+	data->loggers.setLevel(*logger.mLogger, level);
+}
+
+
+OutputHandle LoggerImpl::addConsoleOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &pattern, const Logger &logger)
+{
+	auto sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+	sink->set_level(toSpdLogLevel(level));
+	sink->set_formatter(std::make_unique<Formatter>(pattern));
+
+	return registerSink(withDuplicateFilter(sink, level, maxSkipDuration), level, logger, "console");
+}
+
+
+OutputHandle LoggerImpl::addFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles, bool rotateOnSession,
+										   LogLevel flushLevel, std::chrono::milliseconds flushInterval, size_t writeBatchBytes, Codec compressOnRotate,
+										   std::chrono::seconds rotateInterval, const std::string &pattern, const Logger &logger)
+{
+	if (fileName.empty())
+		throw std::invalid_argument("File name cannot be empty");
+
+	auto sink = std::make_shared<BatchedFileSink>(fileName, maxFileSize, maxFiles, rotateOnSession, toSpdLogLevel(flushLevel), flushInterval, writeBatchBytes,
+												  compressOnRotate, rotateInterval);
+	sink->set_level(toSpdLogLevel(level));
+	sink->set_formatter(std::make_unique<Formatter>(pattern));
+
+	return registerSink(withDuplicateFilter(sink, level, maxSkipDuration), level, logger, "file " + fileName);
+}
+
+
+OutputHandle LoggerImpl::addMSVCOutput(LogLevel level, bool checkForDebuggerPresent, std::chrono::microseconds maxSkipDuration, const Logger &logger)
 {
 #ifdef _WIN32
 	auto sink = std::make_shared<spdlog::sinks::msvc_sink_mt>(checkForDebuggerPresent);
 	sink->set_level(toSpdLogLevel(level));
 	sink->set_formatter(std::make_unique<Formatter>());
 
+	return registerSink(withDuplicateFilter(sink, level, maxSkipDuration), level, logger, "msvc");
+#else
+	return OutputHandle::Invalid;
+#endif
+}
+
+
+OutputHandle LoggerImpl::addMmapFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles,
+										   const std::string &pattern, const Logger &logger)
+{
+#ifdef _WIN32
+	auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(fileName, maxFileSize, maxFiles, true);
+#else
+	auto sink = std::make_shared<MmapFileSink>(fileName, maxFileSize, maxFiles);
+#endif
+	sink->set_level(toSpdLogLevel(level));
+	sink->set_formatter(std::make_unique<Formatter>(pattern));
+
+	return registerSink(withDuplicateFilter(sink, level, maxSkipDuration), level, logger, "mmap file " + fileName);
+}
+
+
+OutputHandle LoggerImpl::addJsonFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles,
+										   const Logger &logger)
+{
+	if (fileName.empty())
+		throw std::invalid_argument("File name cannot be empty");
+
+	auto sink = std::make_shared<BatchedFileSink>(fileName, maxFileSize, maxFiles, false, spdlog::level::err, std::chrono::milliseconds(0), 4_KB);
+	sink->set_level(toSpdLogLevel(level));
+	sink->set_formatter(std::make_unique<JsonFormatter>());
+
+	return registerSink(withDuplicateFilter(sink, level, maxSkipDuration), level, logger, "json file " + fileName);
+}
+
+
+OutputHandle LoggerImpl::addRingBufferOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, size_t capacity, const std::string &crashDumpFile, const Logger &logger)
+{
+	auto sink = std::make_shared<RingBufferSink>(capacity);
+	sink->set_level(toSpdLogLevel(level));
+
+	if (!crashDumpFile.empty())
+		RingBufferSink::armCrashDump(sink, crashDumpFile);
+
 	{
 		std::lock_guard<std::mutex> lock(data->mtx);
-		data->sinks.push_back(sink);
-		data->logger->sinks() = data->sinks;
+		data->ringBuffer = sink;
+	}
 
-		auto spdLevel		  = toSpdLogLevel(level);
-		if (data->logger->level() > spdLevel)
-		{
-			data->logger->set_level(spdLevel);
-		}
+	return registerSink(withDuplicateFilter(sink, level, maxSkipDuration), level, logger, "ring buffer");
+}
+
+
+size_t LoggerImpl::dumpRing(const std::string &fileName)
+{
+	std::shared_ptr<RingBufferSink> ring;
+	{
+		std::lock_guard<std::mutex> lock(data->mtx);
+		ring = data->ringBuffer;
 	}
 
-#endif
+	if (!ring)
+		throw std::logic_error("No ring buffer output is registered");
+
+	return ring->dump(fileName);
+}
+
+
+void LoggerImpl::enableAsync(size_t queueSize, OverflowPolicy overflowPolicy, AsyncMode mode, bool deferFormatting)
+{
+	if (queueSize == 0)
+		throw std::invalid_argument("Async queue size cannot be zero");
+
+	std::lock_guard<std::mutex> lock(data->mtx);
+
+	if (data->asyncWriter || data->stagingWriter)
+		return; // Already running, keep the existing queue
+
+	if (mode == AsyncMode::PerThread)
+	{
+		data->stagingWriter = std::make_unique<StagingWriter>(data->logger, queueSize, overflowPolicy);
+		data->staging.store(data->stagingWriter.get(), std::memory_order_release);
+	}
+	else
+	{
+		data->asyncWriter = std::make_unique<AsyncWriter>(data->logger, queueSize, overflowPolicy);
+		data->async.store(data->asyncWriter.get(), std::memory_order_release);
+	}
+
+	// Published after the writer, so a captured message always finds one
+	if (deferFormatting)
+		deferredFormatting.store(true, std::memory_order_release);
+}
+
+
+size_t LoggerImpl::droppedMessages() const
+{
+	if (auto *writer = data->async.load(std::memory_order_acquire))
+		return static_cast<size_t>(writer->droppedMessages());
+
+	if (auto *writer = data->staging.load(std::memory_order_acquire))
+		return static_cast<size_t>(writer->droppedMessages());
+
+	return 0;
+}
+
+
+Stats LoggerImpl::stats()
+{
+	Stats stats;
+	LoggerStats::collect(stats);
+
+	if (auto *writer = data->async.load(std::memory_order_acquire))
+	{
+		stats.async		 = true;
+		stats.queueDepth = writer->queueDepth();
+		stats.dropped	 = writer->droppedMessages();
+	}
+	else if (auto *writer = data->staging.load(std::memory_order_acquire))
+	{
+		stats.async		 = true;
+		stats.queueDepth = writer->queueDepth();
+		stats.dropped	 = writer->droppedMessages();
+	}
+
+	for (const auto &entry : *data->sinks->snapshot())
+	{
+		LoggerStats::addOutput(stats, *entry.stats, static_cast<OutputHandle>(entry.handle), entry.name, "");
+	}
+
+	data->loggers.forEach(
+		[&stats](const std::string &name, NamedLogger &logger)
+		{
+			for (const auto &entry : *logger.sinks->snapshot())
+			{
+				LoggerStats::addOutput(stats, *entry.stats, static_cast<OutputHandle>(entry.handle), entry.name, name);
+			}
+		});
+	return stats;
+}
+
+
+OutputHandle LoggerImpl::addBinaryFileOutput(LogLevel level, const std::string &fileName)
+{
+	std::lock_guard<std::mutex> lock(data->mtx);
+
+	if (data->binaryWriter)
+		throw std::logic_error("A binary file output is already registered");
+
+	data->binaryWriter = std::make_unique<BinaryLogWriter>(fileName);
+	data->binary.store(data->binaryWriter.get(), std::memory_order_release);
+	data->binaryHandle = static_cast<OutputHandle>(SinkList::newHandle());
+
+	lowerLevel(minimumBinaryLevel, level);
+	lowerLevel(minimumLevel, level);
+	data->categories.setMinimumLevel(minimumLevel.load(std::memory_order_relaxed));
+	return data->binaryHandle;
+}
+
+
+void LoggerImpl::writeBinary(const CallSite &site, std::string_view signature, std::string_view encodedArgs)
+{
+	auto *writer = data->binary.load(std::memory_order_acquire);
+	if (!writer)
+		return;
+
+	auto timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(spdlog::log_clock::now().time_since_epoch()).count();
+	writer->write(site, signature, encodedArgs, timeNs, spdlog::details::os::thread_id());
 }
 
 
@@ -173,62 +577,413 @@ unsigned long long getFileSize(const json &j, const std::string &key, unsigned l
 }
 
 
+// Reads the async section; has no effect once asynchronous mode is running
+void LoggerImpl::applyAsyncConfig(const json &config)
+{
+	if (!config.contains(LOGGER_CONFIG_ASYNC))
+		return;
+
+	auto		&asyncConfig	 = config[LOGGER_CONFIG_ASYNC];
+	size_t		 queueSize		 = asyncConfig.value(LOGGER_CONFIG_QUEUE_SIZE, 8192);
+	std::string	 overflowPolicy	 = asyncConfig.value(LOGGER_CONFIG_OVERFLOW_POLICY, "block");
+	std::string	 mode			 = asyncConfig.value(LOGGER_CONFIG_ASYNC_MODE, "shared");
+	bool		 deferFormatting = asyncConfig.value(LOGGER_CONFIG_DEFER_FORMATTING, false);
+	enableAsync(queueSize, toOverflowPolicy(overflowPolicy), toAsyncMode(mode), deferFormatting);
+}
+
+
+bool hasCategoryConfig(const json &config)
+{
+	return config.contains(LOGGER_CONFIG_CATEGORIES) || config.contains(LOGGER_CONFIG_DEFAULT_CATEGORY_LEVEL);
+}
+
+
+// Replaces all category levels with those of the config; categories it does not list use the default level
+void LoggerImpl::applyCategoryConfig(const json &config)
+{
+	std::map<std::string, LogLevel, std::less<>> levels;
+
+	if (config.contains(LOGGER_CONFIG_CATEGORIES))
+	{
+		for (auto &[category, level] : config[LOGGER_CONFIG_CATEGORIES].items())
+		{
+			levels[category] = toLogLevel(level.get<std::string>());
+		}
+	}
+
+	auto defaultLevel = toLogLevel(config.value(LOGGER_CONFIG_DEFAULT_CATEGORY_LEVEL, "trace"));
+	data->categories.configure(levels, defaultLevel);
+	defaultCategoryLevel.store(defaultLevel, std::memory_order_relaxed);
+}
+
+
+// Replaces all named logger levels with those of the config; loggers it does not list go back to trace
+void LoggerImpl::applyLoggerConfig(const json &config)
+{
+	std::map<std::string, LogLevel, std::less<>> levels;
+
+	if (config.contains(LOGGER_CONFIG_LOGGERS))
+	{
+		for (auto &[name, level] : config[LOGGER_CONFIG_LOGGERS].items())
+		{
+			levels[name] = toLogLevel(level.get<std::string>());
+		}
+	}
+
+	data->loggers.configure(levels);
+}
+
+
+// Level of a sink entry: "info" if missing, except for the ring buffer, which is there to keep the verbose levels
+LogLevel configuredLevel(const json &sinkConfig)
+{
+	bool isRingBuffer = sinkConfig.value(LOGGER_CONFIG_SINK_TYPE, "console") == "ring_buffer";
+	return toLogLevel(sinkConfig.value(LOGGER_CONFIG_LEVEL, isRingBuffer ? "trace" : "info"));
+}
+
+
+OutputHandle LoggerImpl::addOutput(const json &sinkConfig)
+{
+	// Use default type "console" if missing.
+	std::string type  = sinkConfig.value(LOGGER_CONFIG_SINK_TYPE, "console");
+	LogLevel	level = configuredLevel(sinkConfig);
+
+	// Outputs without a logger name belong to the default logger
+	Logger		logger;
+	if (sinkConfig.contains(LOGGER_CONFIG_LOGGER))
+		logger = getLogger(sinkConfig[LOGGER_CONFIG_LOGGER].get<std::string>());
+
+	if (type == "console")
+	{
+		auto		maxSkipDuration = std::chrono::microseconds(sinkConfig.value(LOGGER_CONFIG_MAX_SKIP_DURATION, 0));
+		std::string pattern			= sinkConfig.value(LOGGER_CONFIG_PATTERN, DefaultPattern);
+
+		return addConsoleOutput(level, maxSkipDuration, pattern, logger);
+	}
+	else if (type == "file")
+	{
+		auto		maxSkipDuration = std::chrono::microseconds(sinkConfig.value(LOGGER_CONFIG_MAX_SKIP_DURATION, 0));
+		std::string fileName		= sinkConfig.value(LOGGER_CONFIG_FILE_NAME, "default.log");
+		size_t		maxFileSize		= getFileSize(sinkConfig, LOGGER_CONFIG_MAX_FILE_SIZE, 10_MB);
+		size_t		maxFiles		= sinkConfig.value(LOGGER_CONFIG_MAX_FILES, 3);
+		bool		rotateOnSession = sinkConfig.value(LOGGER_CONFIG_ROTATE_ON_SESSION, false);
+		LogLevel	flushLevel		= toLogLevel(sinkConfig.value(LOGGER_CONFIG_FLUSH_LEVEL, "error"));
+		auto		flushInterval	= std::chrono::milliseconds(sinkConfig.value(LOGGER_CONFIG_FLUSH_INTERVAL, 0));
+		size_t		writeBatchBytes = getFileSize(sinkConfig, LOGGER_CONFIG_WRITE_BATCH_BYTES, 4_KB);
+		Codec		compression		= toCodec(sinkConfig.value(LOGGER_CONFIG_COMPRESS_ON_ROTATE, "none"));
+		auto		rotateInterval	= std::chrono::seconds(sinkConfig.value(LOGGER_CONFIG_ROTATE_INTERVAL, 0));
+		std::string pattern			= sinkConfig.value(LOGGER_CONFIG_PATTERN, DefaultPattern);
+		return addFileOutput(level, maxSkipDuration, fileName, maxFileSize, maxFiles, rotateOnSession, flushLevel, flushInterval, writeBatchBytes, compression, rotateInterval,
+							 pattern, logger);
+	}
+	else if (type == "msvc")
+	{
+		bool checkForDebugger = sinkConfig.value(LOGGER_CONFIG_CHECK_FOR_DEBUGGER, false);
+		auto maxSkipDuration  = std::chrono::microseconds(sinkConfig.value(LOGGER_CONFIG_MAX_SKIP_DURATION, 0));
+		return addMSVCOutput(level, checkForDebugger, maxSkipDuration, logger);
+	}
+	else if (type == "mmap_file")
+	{
+		auto		maxSkipDuration = std::chrono::microseconds(sinkConfig.value(LOGGER_CONFIG_MAX_SKIP_DURATION, 0));
+		std::string fileName		= sinkConfig.value(LOGGER_CONFIG_FILE_NAME, "default.log");
+		size_t		maxFileSize		= getFileSize(sinkConfig, LOGGER_CONFIG_MAX_FILE_SIZE, 10_MB);
+		size_t		maxFiles		= sinkConfig.value(LOGGER_CONFIG_MAX_FILES, 3);
+		std::string pattern			= sinkConfig.value(LOGGER_CONFIG_PATTERN, DefaultPattern);
+		return addMmapFileOutput(level, maxSkipDuration, fileName, maxFileSize, maxFiles, pattern, logger);
+	}
+	else if (type == "json_file")
+	{
+		auto		maxSkipDuration = std::chrono::microseconds(sinkConfig.value(LOGGER_CONFIG_MAX_SKIP_DURATION, 0));
+		std::string fileName		= sinkConfig.value(LOGGER_CONFIG_FILE_NAME, "default.jsonl");
+		size_t		maxFileSize		= getFileSize(sinkConfig, LOGGER_CONFIG_MAX_FILE_SIZE, 10_MB);
+		size_t		maxFiles		= sinkConfig.value(LOGGER_CONFIG_MAX_FILES, 3);
+		return addJsonFileOutput(level, maxSkipDuration, fileName, maxFileSize, maxFiles, logger);
+	}
+	else if (type == "ring_buffer")
+	{
+		auto		maxSkipDuration = std::chrono::microseconds(sinkConfig.value(LOGGER_CONFIG_MAX_SKIP_DURATION, 0));
+		size_t		capacity		= sinkConfig.value(LOGGER_CONFIG_CAPACITY, 4096);
+		std::string crashDumpFile	= sinkConfig.value(LOGGER_CONFIG_CRASH_DUMP_FILE, "");
+		return addRingBufferOutput(level, maxSkipDuration, capacity, crashDumpFile, logger);
+	}
+	else if (type == "binary_file")
+	{
+		std::string fileName = sinkConfig.value(LOGGER_CONFIG_FILE_NAME, "default.bin");
+		return addBinaryFileOutput(level, fileName);
+	}
+
+	return OutputHandle::Invalid;
+}
+
+
 void LoggerImpl::initializeLogger(const std::string &configFilePath)
 {
 	LoggerConfig config(configFilePath);
 	auto		 jsonConfig = config.getConfig();
 
+	applyAsyncConfig(jsonConfig);
+
+	if (hasCategoryConfig(jsonConfig))
+		applyCategoryConfig(jsonConfig);
+
+	if (jsonConfig.contains(LOGGER_CONFIG_LOGGERS))
+		applyLoggerConfig(jsonConfig);
+
 	if (!jsonConfig.contains(LOGGER_CONFIG_SINK))
 	{
-		addConsoleOutput(LogLevel::Info, std::chrono::microseconds(0), "[%Y-%m-%d %H:%M:%S.%e] [%l] %v"); // Adding basic Console output for logger by default
+		addConsoleOutput(LogLevel::Info, std::chrono::microseconds(0), DefaultPattern, Logger()); // Adding basic Console output for logger by default
 		return;
 	}
 
 
 	for (auto &sinkConfig : jsonConfig[LOGGER_CONFIG_SINK])
 	{
-		// Use default type "console" and level "info" if missing.
-		std::string type	 = sinkConfig.value(LOGGER_CONFIG_SINK_TYPE, "console");
-		std::string levelStr = sinkConfig.value(LOGGER_CONFIG_LEVEL, "info");
-		LogLevel	level	 = toLogLevel(levelStr);
+		addOutput(sinkConfig);
+	}
+}
+
+
+struct OutputConfig
+{
+	json	 settings;
+	LogLevel level;
+	bool	 binary;
+};
+
+
+// Sink entries of a config file by identity: their settings without the level, so that a level change
+// is applied to the running output instead of replacing it. Without a sink list the default console output is used.
+std::map<std::string, OutputConfig> outputsByIdentity(const json &config)
+{
+	auto								sinks = config.contains(LOGGER_CONFIG_SINK) ? config[LOGGER_CONFIG_SINK] : json::array({json::object()});
+	std::map<std::string, OutputConfig> outputs;
+
+	for (auto &sinkConfig : sinks)
+	{
+		json identity = sinkConfig;
+		identity.erase(LOGGER_CONFIG_LEVEL);
+
+		// Identical entries are separate outputs
+		auto key = identity.dump();
+		while (outputs.contains(key))
+			key += "+";
+
+		bool binary = sinkConfig.value(LOGGER_CONFIG_SINK_TYPE, "console") == "binary_file";
+		outputs.emplace(key, OutputConfig{sinkConfig, configuredLevel(sinkConfig), binary});
+	}
+	return outputs;
+}
 
-		if (type == "console")
+
+void LoggerImpl::watchConfig(const std::string &configFilePath)
+{
+	std::lock_guard<std::mutex> lock(data->configMtx);
+
+	if (data->configWatcher)
+		throw std::logic_error("A configuration file is already watched");
+
+	LoggerConfig config(configFilePath);
+	auto		 jsonConfig = config.getConfig();
+	auto		 outputs	= outputsByIdentity(jsonConfig);
+
+	applyAsyncConfig(jsonConfig);
+
+	data->watchedCategories = hasCategoryConfig(jsonConfig);
+	if (data->watchedCategories)
+		applyCategoryConfig(jsonConfig);
+
+	data->watchedLoggers = jsonConfig.contains(LOGGER_CONFIG_LOGGERS);
+	if (data->watchedLoggers)
+		applyLoggerConfig(jsonConfig);
+
+	for (auto &[key, output] : outputs)
+	{
+		data->watchedOutputs[key] = {addOutput(output.settings), output.level, output.binary};
+	}
+
+	data->configWatcher = std::make_unique<ConfigWatcher>(configFilePath, [this, configFilePath] { reloadConfig(configFilePath); });
+}
+
+
+void LoggerImpl::reloadConfig(const std::string &configFilePath)
+{
+	json								jsonConfig;
+	std::map<std::string, OutputConfig> outputs;
+	try
+	{
+		jsonConfig = LoggerConfig(configFilePath).getConfig();
+		outputs	   = outputsByIdentity(jsonConfig);
+	}
+	catch (const std::exception &ex)
+	{
+		std::fprintf(stderr, "[Logger] Keeping the current configuration, %s is invalid: %s\n", configFilePath.c_str(), ex.what());
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(data->configMtx);
+	auto					   &watched = data->watchedOutputs;
+
+	// Category levels that were removed from the file fall back to the default level
+	try
+	{
+		if (data->watchedCategories || hasCategoryConfig(jsonConfig))
+			applyCategoryConfig(jsonConfig);
+		data->watchedCategories = hasCategoryConfig(jsonConfig);
+	}
+	catch (const std::exception &ex)
+	{
+		std::fprintf(stderr, "[Logger] Keeping the current category levels, %s is invalid: %s\n", configFilePath.c_str(), ex.what());
+	}
+
+	// Same for the levels of named loggers
+	try
+	{
+		if (data->watchedLoggers || jsonConfig.contains(LOGGER_CONFIG_LOGGERS))
+			applyLoggerConfig(jsonConfig);
+		data->watchedLoggers = jsonConfig.contains(LOGGER_CONFIG_LOGGERS);
+	}
+	catch (const std::exception &ex)
+	{
+		std::fprintf(stderr, "[Logger] Keeping the current logger levels, %s is invalid: %s\n", configFilePath.c_str(), ex.what());
+	}
+
+	// Only one binary output can exist: one that left the file makes room before its replacement is added
+	for (auto it = watched.begin(); it != watched.end();)
+	{
+		if (!it->second.binary || outputs.contains(it->first))
 		{
-			auto		maxSkipDuration = std::chrono::milliseconds(sinkConfig.value(LOGGER_CONFIG_MAX_SKIP_DURATION, 0));
-			std::string pattern			= sinkConfig.value(LOGGER_CONFIG_PATTERN, "[%Y-%m-%d %H:%M:%S.%e] [%l] %v");
+			++it;
+			continue;
+		}
+
+		removeOutput(it->second.handle);
+		it = watched.erase(it);
+	}
 
-			addConsoleOutput(level, maxSkipDuration, pattern);
+	// New outputs go in before old ones are removed, so no message falls into the gap
+	for (auto &[key, output] : outputs)
+	{
+		auto existing = watched.find(key);
+		if (existing == watched.end())
+		{
+			try
+			{
+				watched[key] = {addOutput(output.settings), output.level, output.binary};
+			}
+			catch (const std::exception &ex)
+			{
+				std::fprintf(stderr, "[Logger] Could not add output from %s: %s\n", configFilePath.c_str(), ex.what());
+			}
 		}
-		else if (type == "file")
+		else if (existing->second.level != output.level)
 		{
-			auto		maxSkipDuration = std::chrono::microseconds(sinkConfig.value(LOGGER_CONFIG_MAX_SKIP_DURATION, 0));
-			std::string fileName		= sinkConfig.value(LOGGER_CONFIG_FILE_NAME, "default.log");
-			size_t		maxFileSize		= getFileSize(sinkConfig, LOGGER_CONFIG_MAX_FILE_SIZE, 10_MB);
-			size_t		maxFiles		= sinkConfig.value(LOGGER_CONFIG_MAX_FILES, 3);
-			bool		rotateOnSession = sinkConfig.value(LOGGER_CONFIG_ROTATE_ON_SESSION, false);
-			addFileOutput(level, maxSkipDuration, fileName, maxFileSize, maxFiles, rotateOnSession);
+			setOutputLevel(existing->second.handle, output.level);
+			existing->second.level = output.level;
 		}
-		else if (type == "msvc")
+	}
+
+	for (auto it = watched.begin(); it != watched.end();)
+	{
+		if (outputs.contains(it->first))
 		{
-			bool checkForDebugger = sinkConfig.value(LOGGER_CONFIG_CHECK_FOR_DEBUGGER, false);
-			auto maxSkipDuration  = std::chrono::microseconds(sinkConfig.value(LOGGER_CONFIG_MAX_SKIP_DURATION, 0));
-			addMSVCOutput(level, checkForDebugger, maxSkipDuration);
+			++it;
+			continue;
 		}
+
+		removeOutput(it->second.handle);
+		it = watched.erase(it);
 	}
 }
 
+void LoggerImpl::log(LogLevel level, const char *file, int line, const char *function, std::string_view msg)
+{
+	logStructured(level, file, line, function, msg, {});
+}
+
 
-void LoggerImpl::log(LogLevel level, const std::string &file, int line, const std::string &function, const std::string &msg)
+void LoggerImpl::logStructured(LogLevel level, const char *file, int line, const char *function, std::string_view msg, std::string_view fields)
 {
 	if (!data->logger)
 	{
 		// If no logger is available, initialize a default console logger
-		addConsoleOutput(LogLevel::Info, std::chrono::microseconds(0), "[%Y-%m-%d %H:%M:%S.%e] [%l] %v");
+		addConsoleOutput(LogLevel::Info, std::chrono::microseconds(0), DefaultPattern, Logger());
 	}
 	
-	spdlog::source_loc loc{file.c_str(), line, function.c_str()}; // Create spdlog::source_loc object from provided data
-	auto			   spdLevel = toSpdLogLevel(level);			  // Convert LogLevel to spdlog Level
-	data->logger->log(loc, spdLevel, msg);						  // pass the source_loc along with msg and level
+	auto spdLevel = toSpdLogLevel(level); // Convert LogLevel to spdlog Level
+	LoggerStats::countMessage(level);
+
+	if (!data->logger->should_log(spdLevel))
+	{
+		LoggerStats::countFiltered();
+		return;
+	}
+
+	if (auto *writer = data->async.load(std::memory_order_acquire))
+	{
+		// Capture time and thread here, the writer thread would otherwise stamp its own
+		writer->enqueue({spdlog::log_clock::now(), spdlog::details::os::thread_id(), spdLevel, line, file, function, std::string(msg), std::string(fields), nullptr, {}});
+		return;
+	}
+
+	if (auto *writer = data->staging.load(std::memory_order_acquire))
+	{
+		writer->enqueue(spdlog::log_clock::now(), spdlog::details::os::thread_id(), spdLevel, line, file, function, msg, fields);
+		return;
+	}
+
+	kv::ScopedFields   scopedFields(fields);
+	spdlog::source_loc loc{file, line, function};									// Create spdlog::source_loc object from provided data
+	data->logger->log(loc, spdLevel, spdlog::string_view_t(msg.data(), msg.size())); // pass the source_loc along with msg and level
+}
+
+
+void LoggerImpl::logCaptured(const CallSite &site, deferred::FormatFn format, std::string_view captured)
+{
+	auto *async	  = data->async.load(std::memory_order_acquire);
+	auto *staging = data->staging.load(std::memory_order_acquire);
+
+	if (!async && !staging)
+	{
+		// No writer thread to defer to
+		std::string text;
+		format(text, site.format, captured);
+		logStructured(site.level, site.file, site.line, site.function, text, {});
+		return;
+	}
+
+	auto spdLevel = toSpdLogLevel(site.level);
+	LoggerStats::countMessage(site.level);
+
+	if (!data->logger->should_log(spdLevel))
+	{
+		LoggerStats::countFiltered();
+		return;
+	}
+
+	if (async)
+		async->enqueue({spdlog::log_clock::now(), spdlog::details::os::thread_id(), spdLevel, site.line, site.file, site.function, std::string(captured), {}, format, site.format});
+	else
+		staging->enqueue(spdlog::log_clock::now(), spdlog::details::os::thread_id(), spdLevel, site.line, site.file, site.function, captured, {}, format, site.format);
+}
+
+
+void LoggerImpl::logTo(const Logger &logger, LogLevel level, const char *file, int line, const char *function, std::string_view msg)
+{
+	if (!logger.mLogger)
+	{
+		log(level, file, line, function, msg);
+		return;
+	}
+
+	// Named loggers write on the calling thread, straight into their own sink list
+	LoggerStats::countMessage(level);
+	if (!logger.isEnabled(level))
+	{
+		LoggerStats::countFiltered();
+		return;
+	}
+
+	logger.mLogger->logger->log(spdlog::source_loc{file, line, function}, toSpdLogLevel(level), spdlog::string_view_t(msg.data(), msg.size()));
 }
 
 
@@ -0,0 +1,102 @@
+/*
+==============================================================================
+	Module			LoggerRegistry
+	Description		Named loggers with their own outputs and level
+==============================================================================
+*/
+
+#include "LoggerRegistry.h"
+#include "LoggerImpl.h"
+
+#include <algorithm>
+
+
+NamedLogger::NamedLogger(const std::string &name) : sinks(std::make_shared<SinkList>()), logger(std::make_shared<spdlog::logger>(name, sinks))
+{
+	// The handle filters by threshold, the sinks by their own level
+	logger->set_level(spdlog::level::trace);
+}
+
+
+NamedLogger &LoggerRegistry::get(std::string_view name)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto						it = mLoggers.find(name);
+	if (it != mLoggers.end())
+		return *it->second;
+
+	auto &logger = *mLoggers.emplace(std::string(name), std::make_unique<NamedLogger>(std::string(name))).first->second;
+	publishLocked(logger);
+	return logger;
+}
+
+
+void LoggerRegistry::setLevel(NamedLogger &logger, LogLevel level)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	logger.level = level;
+	publishLocked(logger);
+}
+
+
+void LoggerRegistry::configure(const std::map<std::string, LogLevel, std::less<>> &levels)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (auto &[name, logger] : mLoggers)
+	{
+		logger->level = LogLevel::Trace;
+	}
+
+	for (auto &[name, level] : levels)
+	{
+		auto it = mLoggers.find(name);
+		if (it == mLoggers.end())
+			it = mLoggers.emplace(name, std::make_unique<NamedLogger>(name)).first;
+		it->second->level = level;
+	}
+
+	for (auto &[name, logger] : mLoggers)
+	{
+		publishLocked(*logger);
+	}
+}
+
+
+void LoggerRegistry::publish(NamedLogger &logger)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	publishLocked(logger);
+}
+
+
+NamedLogger *LoggerRegistry::ownerOf(uint64_t handle)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (auto &[name, logger] : mLoggers)
+	{
+		if (logger->sinks->find(handle))
+			return logger.get();
+	}
+	return nullptr;
+}
+
+
+void LoggerRegistry::forEach(const std::function<void(const std::string &, NamedLogger &)> &visit)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (auto &[name, logger] : mLoggers)
+	{
+		visit(name, *logger);
+	}
+}
+
+
+void LoggerRegistry::publishLocked(NamedLogger &logger)
+{
+	auto outputLevel = logging::fromSpdLogLevel(logger.sinks->lowestLevel());
+	logger.threshold.store(std::max(logger.level, outputLevel), std::memory_order_relaxed);
+}
@@ -0,0 +1,409 @@
+/*
+==============================================================================
+	Module			LoggerStats
+	Description		Counters and latency histograms of the logging pipeline itself
+==============================================================================
+*/
+
+#include "LoggerStats.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+
+namespace
+{
+
+constexpr size_t LevelCount = 6; // Trace to Critical
+
+
+// Counters of one thread. Only the owning thread writes them, stats() reads them from anywhere.
+struct alignas(64) ThreadCounters
+{
+	std::array<std::atomic<uint64_t>, LevelCount> messages{};
+	std::atomic<uint64_t>						   filtered{0};
+	LatencyHistogram							   formatLatency;
+	uint64_t									   writes = 0; // Picks the sampled writes, owning thread only
+};
+
+
+// Adds one to a counter that only the calling thread writes
+void bump(std::atomic<uint64_t> &counter) noexcept
+{
+	counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+
+class ThreadBlocks
+{
+public:
+	// Block for a new thread, reusing one whose thread exited
+	ThreadCounters *acquire()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if (!mFree.empty())
+		{
+			auto *counters = mFree.back();
+			mFree.pop_back();
+			return counters;
+		}
+
+		mBlocks.push_back(std::make_unique<ThreadCounters>());
+		return mBlocks.back().get();
+	}
+
+	void release(ThreadCounters *counters)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mFree.push_back(counters);
+	}
+
+	template <typename Visit>
+	void forEach(Visit &&visit)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		for (const auto &counters : mBlocks)
+		{
+			visit(*counters);
+		}
+	}
+
+private:
+	std::mutex									 mMutex;
+	std::vector<std::unique_ptr<ThreadCounters>> mBlocks;
+	std::vector<ThreadCounters *>				 mFree;
+};
+
+
+ThreadBlocks &threadBlocks()
+{
+	// Never destroyed: threads may still exit and hand back their block during static destruction
+	static auto *blocks = new ThreadBlocks();
+	return *blocks;
+}
+
+
+// Hands the thread's block back when the thread exits
+struct ThreadSlot
+{
+	ThreadCounters *counters = threadBlocks().acquire();
+
+	~ThreadSlot() { threadBlocks().release(counters); }
+};
+
+
+ThreadCounters &localCounters()
+{
+	thread_local ThreadSlot slot;
+	return *slot.counters;
+}
+
+
+thread_local LoggerStats::Write *sCurrentWrite = nullptr;
+
+std::atomic<uint64_t>			 sRotations{0};
+
+
+uint64_t						 nowNs() noexcept
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
+constexpr const char *levelNames[LevelCount] = {"trace", "debug", "info", "warn", "error", "critical"};
+
+
+void				  appendLatency(std::string &text, const logging::LatencyStats &latency)
+{
+	std::format_to(std::back_inserter(text), "samples={} p50={} p90={} p99={} p99.9={} max={}", latency.samples, latency.p50, latency.p90, latency.p99, latency.p999,
+				   latency.max);
+}
+
+
+nlohmann::json latencyJson(const logging::LatencyStats &latency)
+{
+	return {{"samples", latency.samples}, {"p50", latency.p50}, {"p90", latency.p90}, {"p99", latency.p99}, {"p999", latency.p999}, {"max", latency.max}};
+}
+
+} // namespace
+
+
+void LatencyHistogram::record(uint64_t ns) noexcept
+{
+	mCounts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+
+	uint64_t max = mMax.load(std::memory_order_relaxed);
+	while (ns > max && !mMax.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+	{
+	}
+}
+
+
+void LatencyHistogram::recordOwned(uint64_t ns) noexcept
+{
+	bump(mCounts[bucketOf(ns)]);
+
+	if (ns > mMax.load(std::memory_order_relaxed))
+		mMax.store(ns, std::memory_order_relaxed);
+}
+
+
+void LatencyHistogram::addTo(Counts &counts, uint64_t &max) const noexcept
+{
+	for (size_t i = 0; i < Buckets; ++i)
+	{
+		counts[i] += mCounts[i].load(std::memory_order_relaxed);
+	}
+	max = std::max(max, mMax.load(std::memory_order_relaxed));
+}
+
+
+size_t LatencyHistogram::bucketOf(uint64_t ns) noexcept
+{
+	if (ns < SubBuckets)
+		return static_cast<size_t>(ns);
+
+	// The three bits below the highest set bit pick the sub-bucket
+	size_t exponent = static_cast<size_t>(std::bit_width(ns)) - 1;
+	if (exponent > 39)
+		return Buckets - 1;
+
+	size_t sub = static_cast<size_t>(ns >> (exponent - 3)) & (SubBuckets - 1);
+	return SubBuckets + (exponent - 3) * SubBuckets + sub;
+}
+
+
+uint64_t LatencyHistogram::upperBoundOf(size_t bucket) noexcept
+{
+	if (bucket < SubBuckets)
+		return bucket;
+
+	size_t exponent = (bucket - SubBuckets) / SubBuckets + 3;
+	size_t sub		= (bucket - SubBuckets) % SubBuckets;
+	return ((SubBuckets + sub + 1) << (exponent - 3)) - 1;
+}
+
+
+logging::LatencyStats LatencyHistogram::summarize(const Counts &counts, uint64_t max) noexcept
+{
+	logging::LatencyStats stats;
+	for (uint64_t count : counts)
+	{
+		stats.samples += count;
+	}
+
+	if (stats.samples == 0)
+		return stats;
+
+	// Smallest bucket bound that at least `perMille` of the samples do not exceed
+	auto percentile = [&](uint64_t perMille)
+	{
+		uint64_t rank = std::max<uint64_t>(1, (stats.samples * perMille + 999) / 1000);
+		uint64_t seen = 0;
+
+		for (size_t i = 0; i < Buckets; ++i)
+		{
+			seen += counts[i];
+			if (seen >= rank)
+				return std::min(upperBoundOf(i), max);
+		}
+		return max;
+	};
+
+	stats.p50  = percentile(500);
+	stats.p90  = percentile(900);
+	stats.p99  = percentile(990);
+	stats.p999 = percentile(999);
+	stats.max  = max;
+	return stats;
+}
+
+
+LoggerStats::Write::Write(Output &output) noexcept : mOutput(output), mOuter(sCurrentWrite)
+{
+	if (localCounters().writes++ % LatencySampleInterval == 0)
+		mStartNs = nowNs();
+
+	sCurrentWrite = this;
+}
+
+
+LoggerStats::Write::~Write()
+{
+	sCurrentWrite = mOuter;
+
+	mOutput.writes.fetch_add(1, std::memory_order_relaxed);
+	if (mBytes > 0)
+		mOutput.bytes.fetch_add(mBytes, std::memory_order_relaxed);
+
+	if (mStartNs > 0)
+	{
+		uint64_t elapsed = nowNs() - mStartNs;
+		mOutput.writeLatency.record(elapsed > mFormatNs ? elapsed - mFormatNs : 0);
+	}
+}
+
+
+LoggerStats::Format::Format(const spdlog::memory_buf_t &dest) noexcept : mDest(dest), mBegin(dest.size())
+{
+	if (sCurrentWrite && sCurrentWrite->mStartNs > 0)
+		mStartNs = nowNs();
+}
+
+
+LoggerStats::Format::~Format()
+{
+	auto *write = sCurrentWrite;
+	if (!write)
+		return;
+
+	write->mBytes += mDest.size() - mBegin;
+
+	if (mStartNs > 0)
+	{
+		uint64_t elapsed = nowNs() - mStartNs;
+		write->mFormatNs += elapsed;
+		localCounters().formatLatency.recordOwned(elapsed);
+	}
+}
+
+
+void LoggerStats::countMessage(LogLevel level) noexcept
+{
+	auto index = static_cast<size_t>(level);
+	if (index < LevelCount)
+		bump(localCounters().messages[index]);
+}
+
+
+void LoggerStats::countFiltered() noexcept
+{
+	bump(localCounters().filtered);
+}
+
+
+void LoggerStats::countRotation() noexcept
+{
+	sRotations.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void LoggerStats::countBytes(size_t bytes) noexcept
+{
+	if (sCurrentWrite)
+		sCurrentWrite->mBytes += bytes;
+}
+
+
+void LoggerStats::collect(logging::Stats &stats)
+{
+	LatencyHistogram::Counts formatCounts{};
+	uint64_t				 formatMax = 0;
+
+	threadBlocks().forEach(
+		[&](const ThreadCounters &counters)
+		{
+			for (size_t i = 0; i < LevelCount; ++i)
+			{
+				stats.messages[i] += counters.messages[i].load(std::memory_order_relaxed);
+			}
+			stats.filtered += counters.filtered.load(std::memory_order_relaxed);
+			counters.formatLatency.addTo(formatCounts, formatMax);
+		});
+
+	stats.formatLatency = LatencyHistogram::summarize(formatCounts, formatMax);
+	stats.rotations		= sRotations.load(std::memory_order_relaxed);
+}
+
+
+void LoggerStats::addOutput(logging::Stats &stats, const Output &output, OutputHandle handle, const std::string &name, const std::string &logger)
+{
+	LatencyHistogram::Counts counts{};
+	uint64_t				 max = 0;
+	output.writeLatency.addTo(counts, max);
+
+	auto &entry		   = stats.outputs.emplace_back();
+	entry.handle	   = handle;
+	entry.name		   = name;
+	entry.logger	   = logger;
+	entry.writes	   = output.writes.load(std::memory_order_relaxed);
+	entry.bytes		   = output.bytes.load(std::memory_order_relaxed);
+	entry.writeLatency = LatencyHistogram::summarize(counts, max);
+}
+
+
+namespace logging
+{
+
+std::string Stats::toText() const
+{
+	std::string text = "messages:";
+	for (size_t i = 0; i < LevelCount; ++i)
+	{
+		std::format_to(std::back_inserter(text), " {}={}", levelNames[i], messages[i]);
+	}
+
+	std::format_to(std::back_inserter(text), "\nfiltered: {}\n", filtered);
+
+	if (async)
+		std::format_to(std::back_inserter(text), "async: queue_depth={} dropped={}\n", queueDepth, dropped);
+	else
+		text += "async: off\n";
+
+	std::format_to(std::back_inserter(text), "rotations: {}\nformat_ns: ", rotations);
+	appendLatency(text, formatLatency);
+
+	for (const auto &output : outputs)
+	{
+		std::format_to(std::back_inserter(text), "\noutput {} \"{}\"", static_cast<uint64_t>(output.handle), output.name);
+		if (!output.logger.empty())
+			std::format_to(std::back_inserter(text), " (logger {})", output.logger);
+
+		std::format_to(std::back_inserter(text), ": writes={} bytes={} write_ns: ", output.writes, output.bytes);
+		appendLatency(text, output.writeLatency);
+	}
+
+	text += '\n';
+	return text;
+}
+
+
+std::string Stats::toJson() const
+{
+	nlohmann::json levels = nlohmann::json::object();
+	for (size_t i = 0; i < LevelCount; ++i)
+	{
+		levels[levelNames[i]] = messages[i];
+	}
+
+	nlohmann::json outputList = nlohmann::json::array();
+	for (const auto &output : outputs)
+	{
+		outputList.push_back({{"handle", static_cast<uint64_t>(output.handle)},
+							  {"name", output.name},
+							  {"logger", output.logger},
+							  {"writes", output.writes},
+							  {"bytes", output.bytes},
+							  {"write_ns", latencyJson(output.writeLatency)}});
+	}
+
+	nlohmann::json json = {{"messages", levels},
+						   {"filtered", filtered},
+						   {"async", {{"enabled", async}, {"queue_depth", queueDepth}, {"dropped", dropped}}},
+						   {"rotations", rotations},
+						   {"format_ns", latencyJson(formatLatency)},
+						   {"outputs", outputList}};
+	return json.dump();
+}
+
+} // namespace logging
@@ -8,27 +8,140 @@
 #include "LoggerWrapper.h"
 #include "LoggerImpl.h"
 
+#include <array>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_set>
+
 
 using namespace filesize;
 
+
+namespace
+{
+
+struct NameHash
+{
+	using is_transparent = void;
+	size_t operator()(std::string_view name) const noexcept { return std::hash<std::string_view>{}(name); }
+};
+
+
+// Stable copy of a file or function name. Records and the Formatter's basename cache keep names by pointer,
+// so every distinct name is stored once and kept for the life of the process.
+const char *internName(std::string_view name)
+{
+	static std::shared_mutex mutex;
+	static auto				*names = new std::unordered_set<std::string, NameHash, std::equal_to<>>(); // Leaked: records may still point into it at exit
+
+	// Per-thread direct-mapped cache in front of the shared set, so a repeated name takes no lock
+	constexpr size_t									 CacheSize = 16;
+	thread_local std::array<std::string_view, CacheSize> cache{};
+
+	auto &entry = cache[NameHash{}(name) % CacheSize];
+	if (entry.data() && entry == name)
+		return entry.data();
+
+	const std::string *stored = nullptr;
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+		auto								found = names->find(name);
+		if (found != names->end())
+			stored = &*found;
+	}
+
+	if (!stored)
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex);
+		stored = &*names->emplace(name).first;
+	}
+
+	entry = *stored;
+	return stored->c_str();
+}
+
+} // namespace
+
+
 namespace logging
 {
 
-void addConsoleOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &pattern)
+Logger get(std::string_view name)
+{
+	return LoggerImpl::GetInstance().getLogger(name);
+}
+
+
+void Logger::setLevel(LogLevel level) const
+{
+	LoggerImpl::GetInstance().setLoggerLevel(*this, level);
+}
+
+
+void Logger::log(LogLevel level, const char *file, int line, const char *function, std::string_view msg) const
+{
+	LoggerImpl::GetInstance().logTo(*this, level, file, line, function, msg);
+}
+
+
+OutputHandle addConsoleOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &pattern, const Logger &logger)
+{
+	return LoggerImpl::GetInstance().addConsoleOutput(level, maxSkipDuration, pattern, logger);
+}
+
+
+OutputHandle addFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles, bool rotateOnSession,
+						   LogLevel flushLevel, std::chrono::milliseconds flushInterval, size_t writeBatchBytes, Codec compressOnRotate, std::chrono::seconds rotateInterval,
+						   const std::string &pattern, const Logger &logger)
+{
+	return LoggerImpl::GetInstance().addFileOutput(level, maxSkipDuration, fileName, maxFileSize, maxFiles, rotateOnSession, flushLevel, flushInterval, writeBatchBytes, compressOnRotate,
+												   rotateInterval, pattern, logger);
+}
+
+
+OutputHandle addMSVCOutput(LogLevel level, bool checkForDebuggerPresent, std::chrono::microseconds maxSkipDuration, const Logger &logger)
 {
-	LoggerImpl::GetInstance().addConsoleOutput(level, maxSkipDuration, pattern);
+	return LoggerImpl::GetInstance().addMSVCOutput(level, checkForDebuggerPresent, maxSkipDuration, logger);
 }
 
 
-void addFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles, bool rotateOnSession)
+OutputHandle addMmapFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles,
+							   const std::string &pattern, const Logger &logger)
 {
-	LoggerImpl::GetInstance().addFileOutput(level, maxSkipDuration, fileName, maxFileSize, maxFiles, rotateOnSession);
+	return LoggerImpl::GetInstance().addMmapFileOutput(level, maxSkipDuration, fileName, maxFileSize, maxFiles, pattern, logger);
 }
 
 
-void addMSVCOutput(LogLevel level, bool checkForDebuggerPresent, std::chrono::microseconds maxSkipDuration)
+OutputHandle addJsonFileOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, const std::string &fileName, size_t maxFileSize, size_t maxFiles,
+							   const Logger &logger)
 {
-	LoggerImpl::GetInstance().addMSVCOutput(level, checkForDebuggerPresent, maxSkipDuration);
+	return LoggerImpl::GetInstance().addJsonFileOutput(level, maxSkipDuration, fileName, maxFileSize, maxFiles, logger);
+}
+
+
+OutputHandle addRingBufferOutput(LogLevel level, std::chrono::microseconds maxSkipDuration, size_t capacity, const std::string &crashDumpFile, const Logger &logger)
+{
+	return LoggerImpl::GetInstance().addRingBufferOutput(level, maxSkipDuration, capacity, crashDumpFile, logger);
+}
+
+
+size_t dumpRing(const std::string &fileName)
+{
+	return LoggerImpl::GetInstance().dumpRing(fileName);
+}
+
+
+bool removeOutput(OutputHandle handle)
+{
+	return LoggerImpl::GetInstance().removeOutput(handle);
+}
+
+
+bool setOutputLevel(OutputHandle handle, LogLevel level)
+{
+	return LoggerImpl::GetInstance().setOutputLevel(handle, level);
 }
 
 
@@ -38,15 +151,99 @@ void initializeLogger(const std::string &configFilePath)
 }
 
 
-void log(LogLevel level, const std::string &file, int line, const std::string &function, const std::string &msg)
+void watchConfig(const std::string &configFilePath)
+{
+	LoggerImpl::GetInstance().watchConfig(configFilePath);
+}
+
+
+void setCategoryLevel(std::string_view category, LogLevel level)
+{
+	LoggerImpl::GetInstance().setCategoryLevel(category, level);
+}
+
+
+void setDefaultCategoryLevel(LogLevel level)
+{
+	LoggerImpl::GetInstance().setDefaultCategoryLevel(level);
+}
+
+
+std::atomic<LogLevel> &categoryThreshold(std::string_view category)
+{
+	return LoggerImpl::GetInstance().categoryThreshold(category);
+}
+
+
+void enableAsync(size_t queueSize, OverflowPolicy overflowPolicy, AsyncMode mode, bool deferFormatting)
+{
+	LoggerImpl::GetInstance().enableAsync(queueSize, overflowPolicy, mode, deferFormatting);
+}
+
+
+size_t droppedMessages()
+{
+	return LoggerImpl::GetInstance().droppedMessages();
+}
+
+
+Stats stats()
+{
+	return LoggerImpl::GetInstance().stats();
+}
+
+
+OutputHandle addBinaryFileOutput(LogLevel level, const std::string &fileName)
+{
+	return LoggerImpl::GetInstance().addBinaryFileOutput(level, fileName);
+}
+
+
+void writeBinary(const CallSite &site, std::string_view signature, std::string_view encodedArgs)
+{
+	LoggerImpl::GetInstance().writeBinary(site, signature, encodedArgs);
+}
+
+
+void log(LogLevel level, const char *file, int line, const char *function, std::string_view msg)
 {
 	LoggerImpl::GetInstance().log(level, file, line, function, msg);
 }
 
 
+void log(LogLevel level, std::string_view file, int line, std::string_view function, std::string_view msg)
+{
+	if (!isEnabled(level))
+		return;
+
+	log(level, internName(file), line, internName(function), msg);
+}
+
+
+void logStructured(LogLevel level, const char *file, int line, const char *function, std::string_view message, std::string_view fields)
+{
+	LoggerImpl::GetInstance().logStructured(level, file, line, function, message, fields);
+}
+
+
+void logCaptured(const CallSite &site, deferred::FormatFn format, std::string_view captured)
+{
+	LoggerImpl::GetInstance().logCaptured(site, format, captured);
+}
+
+
 
 // Options:
 
+// Console Options:
+
+ConsoleOptions &ConsoleOptions::setPattern(const std::string &pattern)
+{
+	this->pattern = pattern;
+	return *this;
+}
+
+
 // File Options:
 
 FileOptions &FileOptions::setFilename(const std::string &filename)
@@ -73,6 +270,105 @@ FileOptions &FileOptions::setRotateOnSession(bool rotateOnSession)
 	return *this;
 }
 
+FileOptions &FileOptions::setFlushLevel(LogLevel flushLevel)
+{
+	this->flushLevel = flushLevel;
+	return *this;
+}
+
+FileOptions &FileOptions::setFlushInterval(std::chrono::milliseconds flushInterval)
+{
+	this->flushInterval = flushInterval;
+	return *this;
+}
+
+FileOptions &FileOptions::setWriteBatchBytes(size_t writeBatchBytes)
+{
+	this->writeBatchBytes = writeBatchBytes;
+	return *this;
+}
+
+FileOptions &FileOptions::setCompressOnRotate(Codec codec)
+{
+	this->compressOnRotate = codec;
+	return *this;
+}
+
+FileOptions &FileOptions::setRotateInterval(std::chrono::seconds rotateInterval)
+{
+	this->rotateInterval = rotateInterval;
+	return *this;
+}
+
+FileOptions &FileOptions::setPattern(const std::string &pattern)
+{
+	this->pattern = pattern;
+	return *this;
+}
+
+
+// Mmap File Options:
+
+MmapFileOptions &MmapFileOptions::setFilename(const std::string &filename)
+{
+	this->filename = filename;
+	return *this;
+}
+
+MmapFileOptions &MmapFileOptions::setMaxFileSize(size_t maxFileSize)
+{
+	this->maxFileSize = maxFileSize;
+	return *this;
+}
+
+MmapFileOptions &MmapFileOptions::setMaxFiles(size_t maxFiles)
+{
+	this->maxFiles = maxFiles;
+	return *this;
+}
+
+MmapFileOptions &MmapFileOptions::setPattern(const std::string &pattern)
+{
+	this->pattern = pattern;
+	return *this;
+}
+
+
+// Json File Options:
+
+JsonFileOptions &JsonFileOptions::setFilename(const std::string &filename)
+{
+	this->filename = filename;
+	return *this;
+}
+
+JsonFileOptions &JsonFileOptions::setMaxFileSize(size_t maxFileSize)
+{
+	this->maxFileSize = maxFileSize;
+	return *this;
+}
+
+JsonFileOptions &JsonFileOptions::setMaxFiles(size_t maxFiles)
+{
+	this->maxFiles = maxFiles;
+	return *this;
+}
+
+
+// Ring Buffer Options:
+
+RingBufferOptions &RingBufferOptions::setCapacity(size_t capacity)
+{
+	this->capacity = capacity;
+	return *this;
+}
+
+RingBufferOptions &RingBufferOptions::setCrashDumpFile(const std::string &crashDumpFile)
+{
+	this->crashDumpFile = crashDumpFile;
+	return *this;
+}
+
 
 // MSVC Options:
 
@@ -83,6 +379,48 @@ MSVCOptions &MSVCOptions::checkForPresentDebugger(bool check)
 }
 
 
+// Async Options:
+
+AsyncOptions &AsyncOptions::setQueueSize(size_t queueSize)
+{
+	this->queueSize = queueSize;
+	return *this;
+}
+
+AsyncOptions &AsyncOptions::setOverflowPolicy(OverflowPolicy overflowPolicy)
+{
+	this->overflowPolicy = overflowPolicy;
+	return *this;
+}
+
+AsyncOptions &AsyncOptions::setMode(AsyncMode mode)
+{
+	this->mode = mode;
+	return *this;
+}
+
+AsyncOptions &AsyncOptions::setDeferFormatting(bool deferFormatting)
+{
+	this->deferFormatting = deferFormatting;
+	return *this;
+}
+
+
+// Binary File Options:
+
+BinaryFileOptions &BinaryFileOptions::setFilename(const std::string &filename)
+{
+	this->filename = filename;
+	return *this;
+}
+
+BinaryFileOptions &BinaryFileOptions::setLevel(LogLevel level)
+{
+	this->level = level;
+	return *this;
+}
+
+
 // Console Options:
 
 ConsoleOptions addConsoleOutput()
@@ -100,4 +438,30 @@ MSVCOptions addMSVCOutput()
 	return {};
 }
 
+MmapFileOptions addMmapFileOutput()
+{
+	return {};
+}
+
+JsonFileOptions addJsonFileOutput()
+{
+	return {};
+}
+
+
+RingBufferOptions addRingBufferOutput()
+{
+	return {};
+}
+
+AsyncOptions enableAsync()
+{
+	return {};
+}
+
+BinaryFileOptions addBinaryFileOutput()
+{
+	return {};
+}
+
 } // namespace logging
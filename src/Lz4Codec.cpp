@@ -0,0 +1,475 @@
+/*
+==============================================================================
+	Module			Lz4Codec
+	Description		Built-in LZ4 frame compression for rotated log files
+==============================================================================
+*/
+
+#include "Lz4Codec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+
+namespace
+{
+
+constexpr uint32_t FrameMagic		  = 0x184D2204;
+constexpr uint32_t SkippableMagicMask = 0xFFFFFFF0;
+constexpr uint32_t SkippableMagic	  = 0x184D2A50;
+constexpr uint32_t UncompressedBit	  = 0x80000000;
+
+constexpr size_t   BlockSize		  = 4 * 1024 * 1024;
+constexpr uint8_t  FrameFlags		  = 0x60; // Version 01, independent blocks, no checksums, no content size
+constexpr uint8_t  BlockDescriptor	  = 0x70; // 4 MB blocks
+
+constexpr size_t   MinMatch			  = 4;
+constexpr size_t   LastLiterals		  = 5;	// The last bytes of a block are always literals
+constexpr size_t   MatchSearchLimit	  = 12; // The last match starts at least this far before the end
+constexpr size_t   MaxOffset		  = 65'535;
+constexpr int	   HashBits			  = 16;
+
+
+uint32_t readLE32(const uint8_t *data)
+{
+	return static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 | static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+}
+
+
+void appendLE32(std::string &out, uint32_t value)
+{
+	for (int i = 0; i < 4; ++i)
+		out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+
+uint32_t rotateLeft(uint32_t value, int bits)
+{
+	return (value << bits) | (value >> (32 - bits));
+}
+
+
+// xxHash32, used by the frame header checksum
+uint32_t xxh32(const uint8_t *data, size_t length, uint32_t seed)
+{
+	constexpr uint32_t Prime1 = 2654435761U;
+	constexpr uint32_t Prime2 = 2246822519U;
+	constexpr uint32_t Prime3 = 3266489917U;
+	constexpr uint32_t Prime4 = 668265263U;
+	constexpr uint32_t Prime5 = 374761393U;
+
+	const uint8_t	  *end	  = data + length;
+	uint32_t		   hash;
+
+	if (length >= 16)
+	{
+		uint32_t lanes[4] = {seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1};
+		for (; data + 16 <= end; data += 16)
+		{
+			for (int i = 0; i < 4; ++i)
+				lanes[i] = rotateLeft(lanes[i] + readLE32(data + 4 * i) * Prime2, 13) * Prime1;
+		}
+		hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+	}
+	else
+	{
+		hash = seed + Prime5;
+	}
+
+	hash += static_cast<uint32_t>(length);
+
+	for (; data + 4 <= end; data += 4)
+		hash = rotateLeft(hash + readLE32(data) * Prime3, 17) * Prime4;
+	for (; data < end; ++data)
+		hash = rotateLeft(hash + *data * Prime5, 11) * Prime1;
+
+	hash ^= hash >> 15;
+	hash *= Prime2;
+	hash ^= hash >> 13;
+	hash *= Prime3;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+
+uint8_t headerChecksum(const uint8_t *descriptor, size_t length)
+{
+	return static_cast<uint8_t>(xxh32(descriptor, length, 0) >> 8);
+}
+
+
+uint8_t *writeLengthBytes(uint8_t *out, size_t length)
+{
+	for (; length >= 255; length -= 255)
+		*out++ = 255;
+	*out++ = static_cast<uint8_t>(length);
+	return out;
+}
+
+
+uint8_t *writeSequence(uint8_t *out, const uint8_t *literals, size_t literalLength, size_t offset, size_t matchLength)
+{
+	uint8_t *token = out++;
+	*token		   = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+	if (literalLength >= 15)
+		out = writeLengthBytes(out, literalLength - 15);
+
+	std::memcpy(out, literals, literalLength);
+	out += literalLength;
+
+	if (matchLength == 0)
+		return out; // Last sequence: literals only
+
+	*out++ = static_cast<uint8_t>(offset);
+	*out++ = static_cast<uint8_t>(offset >> 8);
+
+	*token |= static_cast<uint8_t>(std::min<size_t>(matchLength - MinMatch, 15));
+	if (matchLength - MinMatch >= 15)
+		out = writeLengthBytes(out, matchLength - MinMatch - 15);
+	return out;
+}
+
+
+size_t compressBound(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+
+// Greedy single-probe matcher. `table` holds the last position of each hashed 4-byte sequence.
+size_t compressBlock(const uint8_t *source, size_t size, uint8_t *destination, std::vector<int32_t> &table)
+{
+	std::fill(table.begin(), table.end(), -1);
+
+	uint8_t *out	= destination;
+	size_t	 anchor = 0;
+	size_t	 pos	= 0;
+
+	while (pos + MatchSearchLimit <= size)
+	{
+		uint32_t sequence  = readLE32(source + pos);
+		uint32_t hash	   = (sequence * 2654435761U) >> (32 - HashBits);
+		int32_t	 candidate = table[hash];
+		table[hash]		   = static_cast<int32_t>(pos);
+
+		if (candidate < 0 || pos - static_cast<size_t>(candidate) > MaxOffset || readLE32(source + candidate) != sequence)
+		{
+			++pos;
+			continue;
+		}
+
+		size_t match  = static_cast<size_t>(candidate);
+		size_t length = MinMatch;
+		while (pos + length < size - LastLiterals && source[match + length] == source[pos + length])
+			++length;
+
+		out	   = writeSequence(out, source + anchor, pos - anchor, pos - match, length);
+		pos	  += length;
+		anchor = pos;
+	}
+
+	out = writeSequence(out, source + anchor, size - anchor, 0, 0);
+	return static_cast<size_t>(out - destination);
+}
+
+
+size_t readLengthBytes(const uint8_t *&in, const uint8_t *end)
+{
+	size_t	length = 0;
+	uint8_t byte;
+	do
+	{
+		if (in >= end)
+			throw std::runtime_error("Truncated LZ4 block");
+		byte = *in++;
+		length += byte;
+	} while (byte == 255);
+	return length;
+}
+
+
+// Appends the decoded block to `out`. Matches may reach back to `windowStart`.
+void decompressBlock(const uint8_t *in, size_t size, std::string &out, size_t windowStart, size_t maxBlockSize)
+{
+	const uint8_t *end		  = in + size;
+	size_t		   blockStart = out.size();
+
+	while (in < end)
+	{
+		uint8_t token		  = *in++;
+
+		size_t	literalLength = token >> 4;
+		if (literalLength == 15)
+			literalLength += readLengthBytes(in, end);
+		if (static_cast<size_t>(end - in) < literalLength)
+			throw std::runtime_error("Truncated LZ4 block");
+
+		out.append(reinterpret_cast<const char *>(in), literalLength);
+		in += literalLength;
+
+		if (in == end)
+			break; // Last sequence has no match
+
+		if (end - in < 2)
+			throw std::runtime_error("Truncated LZ4 block");
+		size_t offset = static_cast<size_t>(in[0]) | static_cast<size_t>(in[1]) << 8;
+		in += 2;
+
+		size_t matchLength = token & 15;
+		if (matchLength == 15)
+			matchLength += readLengthBytes(in, end);
+		matchLength += MinMatch;
+
+		if (offset == 0 || offset > out.size() - windowStart)
+			throw std::runtime_error("Invalid LZ4 match offset");
+		if (out.size() - blockStart + matchLength > maxBlockSize)
+			throw std::runtime_error("LZ4 block exceeds its maximum size");
+
+		// Byte by byte: the match may overlap the bytes it produces
+		size_t from = out.size() - offset;
+		for (size_t i = 0; i < matchLength; ++i)
+			out.push_back(out[from + i]);
+	}
+
+	if (out.size() - blockStart > maxBlockSize)
+		throw std::runtime_error("LZ4 block exceeds its maximum size");
+}
+
+
+std::string frameHeader()
+{
+	std::string header;
+	appendLE32(header, FrameMagic);
+
+	uint8_t descriptor[2] = {FrameFlags, BlockDescriptor};
+	header.push_back(static_cast<char>(descriptor[0]));
+	header.push_back(static_cast<char>(descriptor[1]));
+	header.push_back(static_cast<char>(headerChecksum(descriptor, sizeof(descriptor))));
+	return header;
+}
+
+
+// Compresses one block of the frame into `out` and returns the bytes to append
+class BlockEncoder
+{
+public:
+	BlockEncoder() : mTable(size_t{1} << HashBits), mBuffer(compressBound(BlockSize)) {}
+
+	std::string_view encode(const char *data, size_t size, uint32_t &blockHeader)
+	{
+		size_t compressed = compressBlock(reinterpret_cast<const uint8_t *>(data), size, mBuffer.data(), mTable);
+		if (compressed >= size)
+		{
+			blockHeader = static_cast<uint32_t>(size) | UncompressedBit;
+			return {data, size};
+		}
+
+		blockHeader = static_cast<uint32_t>(compressed);
+		return {reinterpret_cast<const char *>(mBuffer.data()), compressed};
+	}
+
+private:
+	std::vector<int32_t> mTable;
+	std::vector<uint8_t> mBuffer;
+};
+
+
+struct FileCloser
+{
+	void operator()(std::FILE *file) const { std::fclose(file); }
+};
+
+using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+
+FilePtr openFile(const std::string &fileName, const char *mode)
+{
+	FilePtr file(std::fopen(fileName.c_str(), mode));
+	if (!file)
+		throw std::runtime_error("Could not open " + fileName);
+	return file;
+}
+
+
+void writeAll(std::FILE *file, std::string_view data, const std::string &fileName)
+{
+	if (std::fwrite(data.data(), 1, data.size(), file) != data.size())
+		throw std::runtime_error("Could not write to " + fileName);
+}
+
+
+std::string readAll(const std::string &fileName)
+{
+	auto		file = openFile(fileName, "rb");
+	std::string content;
+	char		buffer[64 * 1024];
+	for (size_t read; (read = std::fread(buffer, 1, sizeof(buffer), file.get())) > 0;)
+		content.append(buffer, read);
+
+	if (std::ferror(file.get()))
+		throw std::runtime_error("Could not read " + fileName);
+	return content;
+}
+
+} // namespace
+
+
+namespace lz4
+{
+
+std::string compress(std::string_view data)
+{
+	std::string	 frame = frameHeader();
+	BlockEncoder encoder;
+
+	for (size_t offset = 0; offset < data.size(); offset += BlockSize)
+	{
+		uint32_t blockHeader;
+		auto	 block = encoder.encode(data.data() + offset, std::min(BlockSize, data.size() - offset), blockHeader);
+		appendLE32(frame, blockHeader);
+		frame.append(block);
+	}
+
+	appendLE32(frame, 0); // End mark
+	return frame;
+}
+
+
+std::string decompress(std::string_view frame)
+{
+	auto		   *in	= reinterpret_cast<const uint8_t *>(frame.data());
+	const uint8_t *end = in + frame.size();
+	std::string	   out;
+
+	auto		   require = [&](size_t bytes)
+	{
+		if (static_cast<size_t>(end - in) < bytes)
+			throw std::runtime_error("Truncated LZ4 frame");
+	};
+
+	while (in < end)
+	{
+		require(4);
+		uint32_t magic = readLE32(in);
+		in += 4;
+
+		if ((magic & SkippableMagicMask) == SkippableMagic)
+		{
+			require(4);
+			size_t skip = readLE32(in);
+			in += 4;
+			require(skip);
+			in += skip;
+			continue;
+		}
+		if (magic != FrameMagic)
+			throw std::runtime_error("Not an LZ4 frame");
+
+		require(3);
+		const uint8_t *descriptor	  = in;
+		uint8_t		   flags		  = in[0];
+		uint8_t		   blockInfo	  = in[1];
+		bool		   independent	  = (flags & 0x20) != 0;
+		bool		   blockChecksum  = (flags & 0x10) != 0;
+		bool		   contentSize	  = (flags & 0x08) != 0;
+		bool		   contentChecksum = (flags & 0x04) != 0;
+		bool		   dictionary	  = (flags & 0x01) != 0;
+
+		if ((flags >> 6) != 1)
+			throw std::runtime_error("Unsupported LZ4 frame version");
+		if (dictionary)
+			throw std::runtime_error("LZ4 frames with a dictionary are not supported");
+
+		size_t blockSizeId = (blockInfo >> 4) & 7;
+		if (blockSizeId < 4)
+			throw std::runtime_error("Invalid LZ4 block size");
+		size_t maxBlockSize = size_t{1} << (8 + 2 * blockSizeId);
+
+		size_t descriptorSize = 2 + (contentSize ? 8 : 0);
+		require(descriptorSize + 1);
+		if (headerChecksum(descriptor, descriptorSize) != descriptor[descriptorSize])
+			throw std::runtime_error("LZ4 frame header checksum mismatch");
+		in += descriptorSize + 1;
+
+		size_t frameStart = out.size();
+		for (;;)
+		{
+			require(4);
+			uint32_t blockHeader = readLE32(in);
+			in += 4;
+			if (blockHeader == 0)
+				break;
+
+			size_t size = blockHeader & ~UncompressedBit;
+			if (size > maxBlockSize)
+				throw std::runtime_error("LZ4 block exceeds its maximum size");
+			require(size + (blockChecksum ? 4 : 0));
+
+			if ((blockHeader & UncompressedBit) != 0)
+				out.append(reinterpret_cast<const char *>(in), size);
+			else
+				decompressBlock(in, size, out, independent ? out.size() : frameStart, maxBlockSize);
+
+			in += size + (blockChecksum ? 4 : 0);
+		}
+
+		if (contentChecksum)
+		{
+			require(4);
+			in += 4;
+		}
+	}
+
+	return out;
+}
+
+
+void compressFile(const std::string &source, const std::string &target)
+{
+	auto		 input	= openFile(source, "rb");
+	auto		 output = openFile(target, "wb");
+	BlockEncoder encoder;
+	std::string	 blockHeaderBytes;
+
+	writeAll(output.get(), frameHeader(), target);
+
+	std::vector<char> block(BlockSize);
+	for (size_t read; (read = std::fread(block.data(), 1, block.size(), input.get())) > 0;)
+	{
+		uint32_t blockHeader;
+		auto	 encoded = encoder.encode(block.data(), read, blockHeader);
+
+		blockHeaderBytes.clear();
+		appendLE32(blockHeaderBytes, blockHeader);
+		writeAll(output.get(), blockHeaderBytes, target);
+		writeAll(output.get(), encoded, target);
+	}
+
+	if (std::ferror(input.get()))
+		throw std::runtime_error("Could not read " + source);
+
+	blockHeaderBytes.clear();
+	appendLE32(blockHeaderBytes, 0);
+	writeAll(output.get(), blockHeaderBytes, target);
+
+	if (std::fflush(output.get()) != 0)
+		throw std::runtime_error("Could not write to " + target);
+}
+
+
+void decompressFile(const std::string &source, const std::string &target)
+{
+	auto content = decompress(readAll(source));
+	auto output	 = openFile(target, "wb");
+	writeAll(output.get(), content, target);
+
+	if (std::fflush(output.get()) != 0)
+		throw std::runtime_error("Could not write to " + target);
+}
+
+} // namespace lz4
@@ -0,0 +1,343 @@
+/*
+==============================================================================
+	Module			MmapFileSink
+	Description		File sink writing into memory-mapped, preallocated segments
+==============================================================================
+*/
+
+#include "MmapFileSink.h"
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <spdlog/pattern_formatter.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include "LoggerStats.h"
+
+
+namespace
+{
+
+std::runtime_error fileError(const std::string &action, const std::string &fileName, int error)
+{
+	return std::runtime_error(action + " " + fileName + ": " + std::strerror(error));
+}
+
+} // namespace
+
+
+/*
+ *	@brief		Each thread keeps a reference to this next to its copy. The copies themselves belong to the sink:
+ *				a thread hands its copy back when it exits, and the sink frees all of them when it is destroyed.
+ */
+struct MmapFileSink::Formatters
+{
+	std::mutex										mutex;
+	std::unique_ptr<spdlog::formatter>				formatter;
+	std::vector<std::unique_ptr<spdlog::formatter>> copies;
+	std::atomic<uint64_t>							version{0};
+	std::atomic<bool>								released{false}; // The sink is gone and has freed the copies
+
+	// Fresh copy of the formatter for a thread, replacing the thread's previous one
+	spdlog::formatter *makeCopy(spdlog::formatter *previous)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		drop(previous);
+		copies.push_back(formatter->clone());
+		return copies.back().get();
+	}
+
+	void release(spdlog::formatter *copy)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		drop(copy);
+	}
+
+private:
+	void drop(spdlog::formatter *copy)
+	{
+		std::erase_if(copies, [copy](const std::unique_ptr<spdlog::formatter> &c) { return c.get() == copy; });
+	}
+};
+
+
+MmapFileSink::MmapFileSink(std::string fileName, size_t maxFileSize, size_t maxFiles)
+	: mFileName(std::move(fileName)), mSegmentSize(maxFileSize), mMaxFiles(maxFiles), mFormatters(std::make_shared<Formatters>())
+{
+	mFormatters->formatter = std::make_unique<spdlog::pattern_formatter>();
+
+	if (mFileName.empty())
+		throw std::invalid_argument("File name cannot be empty");
+	if (mSegmentSize == 0)
+		throw std::invalid_argument("Memory-mapped file size cannot be zero");
+
+	// Never map over an earlier log: its tail may be zero-filled from a crash, keep it as a rotated file
+	std::error_code error;
+	if (std::filesystem::file_size(mFileName, error) > 0 && !error)
+		rotateFiles();
+
+	mCurrent.store(openSegment(mSegmentSize));
+}
+
+
+MmapFileSink::~MmapFileSink()
+{
+	if (Segment *segment = mCurrent.load())
+		closeSegment(*segment, std::min(segment->offset.load(), segment->size));
+
+	std::lock_guard<std::mutex> lock(mFormatters->mutex);
+	mFormatters->copies.clear();
+	mFormatters->formatter.reset();
+	mFormatters->released.store(true);
+}
+
+
+void MmapFileSink::log(const spdlog::details::log_msg &msg)
+{
+	thread_local spdlog::memory_buf_t buffer;
+	buffer.clear();
+	threadFormatter().format(msg, buffer);
+	append(buffer.data(), buffer.size());
+}
+
+
+void MmapFileSink::set_pattern(const std::string &pattern)
+{
+	set_formatter(std::make_unique<spdlog::pattern_formatter>(pattern));
+}
+
+
+void MmapFileSink::set_formatter(std::unique_ptr<spdlog::formatter> sinkFormatter)
+{
+	std::lock_guard<std::mutex> lock(mFormatters->mutex);
+	mFormatters->formatter = std::move(sinkFormatter);
+	mFormatters->version.fetch_add(1, std::memory_order_release);
+}
+
+
+spdlog::formatter &MmapFileSink::threadFormatter()
+{
+	struct Entry
+	{
+		std::shared_ptr<Formatters> formatters;
+		uint64_t					version	  = 0;
+		spdlog::formatter		   *formatter = nullptr; // One of formatters->copies
+	};
+
+	// Hands the thread's copies back when the thread exits
+	struct Cache
+	{
+		std::vector<Entry> entries;
+
+		~Cache()
+		{
+			for (auto &entry : entries)
+				entry.formatters->release(entry.formatter);
+		}
+	};
+	thread_local Cache cache;
+
+	auto			   version = mFormatters->version.load(std::memory_order_acquire);
+	auto			   entry   = std::find_if(cache.entries.begin(), cache.entries.end(), [this](const Entry &e) { return e.formatters == mFormatters; });
+
+	if (entry != cache.entries.end() && entry->version == version)
+		return *entry->formatter;
+
+	if (entry == cache.entries.end())
+	{
+		// Forget sinks that were destroyed since this thread last made a copy
+		std::erase_if(cache.entries, [](const Entry &e) { return e.formatters->released.load(); });
+		cache.entries.push_back({mFormatters});
+		entry = std::prev(cache.entries.end());
+	}
+
+	entry->version	 = version;
+	entry->formatter = mFormatters->makeCopy(entry->formatter);
+	return *entry->formatter;
+}
+
+
+void MmapFileSink::append(const char *data, size_t length)
+{
+	while (true)
+	{
+		// Announce the copy before rechecking the segment, so rollOver() either sees us or we see the new segment
+		Segment *segment = mCurrent.load();
+		segment->users.fetch_add(1);
+		if (mCurrent.load() != segment)
+		{
+			segment->users.fetch_sub(1);
+			continue;
+		}
+
+		// Read while counted as a user: once released, the segment may be closed and reused
+		const size_t size  = segment->size;
+		size_t		 start = segment->offset.fetch_add(length, std::memory_order_relaxed);
+		if (start + length <= size)
+		{
+			std::memcpy(segment->base + start, data, length);
+			segment->users.fetch_sub(1, std::memory_order_release);
+			return;
+		}
+		segment->users.fetch_sub(1, std::memory_order_release);
+
+		if (start <= size)
+		{
+			// This reservation crossed the end: exactly one writer per segment gets here
+			rollOver(segment, start, length);
+			continue;
+		}
+
+		// Another writer crossed the end and is rolling over, or failed to and reset the offset
+		while (mCurrent.load(std::memory_order_acquire) == segment && segment->offset.load(std::memory_order_relaxed) > size)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+
+void MmapFileSink::rollOver(Segment *full, size_t usedLength, size_t minimumSize)
+{
+	Segment *next = nullptr;
+
+	try
+	{
+		std::lock_guard<std::mutex> lock(mSegmentsMutex);
+		rotateFiles();
+		next = openSegment(std::max(mSegmentSize, minimumSize));
+	}
+	catch (...)
+	{
+		// Let the next writer try again instead of leaving everyone waiting for a segment that never comes
+		full->offset.store(usedLength);
+		throw;
+	}
+
+	mCurrent.store(next);
+
+	// Writers that reserved a range before the crossing point may still be copying
+	while (full->users.load() != 0)
+	{
+		std::this_thread::yield();
+	}
+
+	closeSegment(*full, usedLength);
+
+	std::lock_guard<std::mutex> lock(mSegmentsMutex);
+	mClosed.push_back(full);
+}
+
+
+MmapFileSink::Segment *MmapFileSink::openSegment(size_t size)
+{
+	int fd = ::open(mFileName.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0)
+		throw fileError("Could not open log file", mFileName, errno);
+
+#ifdef __linux__
+	int result = ::posix_fallocate(fd, 0, static_cast<off_t>(size)); // Reserves the blocks, a full disk fails here and not on a write
+#else
+	int result = ::ftruncate(fd, static_cast<off_t>(size)) == 0 ? 0 : errno;
+#endif
+	if (result != 0)
+	{
+		::close(fd);
+		throw fileError("Could not preallocate log file", mFileName, result);
+	}
+
+	int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+	flags |= MAP_POPULATE; // Fault the pages in now rather than on the first write to each of them
+#endif
+
+	void *base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+	if (base == MAP_FAILED)
+	{
+		int error = errno;
+		::close(fd);
+		throw fileError("Could not map log file", mFileName, error);
+	}
+
+	// A closed segment is reused rather than freed: a writer that loaded it before the rollover may still
+	// announce itself on it, see that it is no longer current and move on. Its user count is left alone.
+	Segment *segment = nullptr;
+	if (!mClosed.empty())
+	{
+		segment = mClosed.back();
+		mClosed.pop_back();
+	}
+	else
+	{
+		mSegments.push_back(std::make_unique<Segment>());
+		segment = mSegments.back().get();
+	}
+
+	segment->base	= static_cast<char *>(base);
+	segment->size	= size;
+	segment->fd		= fd;
+	segment->closed = false;
+	segment->offset.store(0);
+	return segment;
+}
+
+
+void MmapFileSink::closeSegment(Segment &segment, size_t usedLength)
+{
+	if (segment.closed)
+		return;
+
+	::munmap(segment.base, segment.size);
+
+	// Drop the unused preallocated tail, readers should not see trailing zeros
+	if (::ftruncate(segment.fd, static_cast<off_t>(usedLength)) != 0)
+		std::fprintf(stderr, "[Logger] Could not trim log file %s: %s\n", mFileName.c_str(), std::strerror(errno));
+
+	::close(segment.fd);
+	segment.base   = nullptr;
+	segment.closed = true;
+}
+
+
+void MmapFileSink::rotateFiles()
+{
+	namespace fs = std::filesystem;
+	using spdlog::sinks::rotating_file_sink_mt;
+
+	std::error_code error;
+	LoggerStats::countRotation();
+
+	if (mMaxFiles == 0)
+	{
+		fs::remove(mFileName, error);
+		return;
+	}
+
+	// app.log -> app.1.log -> ... -> app.<maxFiles>.log, the oldest one is dropped
+	for (size_t i = mMaxFiles; i > 0; --i)
+	{
+		auto source = i == 1 ? mFileName : rotating_file_sink_mt::calc_filename(mFileName, i - 1);
+		auto target = rotating_file_sink_mt::calc_filename(mFileName, i);
+
+		if (!fs::exists(source, error))
+			continue;
+
+		fs::remove(target, error);
+		fs::rename(source, target, error);
+	}
+}
+
+#endif
@@ -0,0 +1,468 @@
+/*
+==============================================================================
+	Module			RingBufferSink
+	Description		In-memory flight recorder keeping the last records for a crash dump
+==============================================================================
+*/
+
+#include "RingBufferSink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <spdlog/details/log_msg.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Formatter.h"
+#include "KeyValue.h"
+#include "LoggerStats.h"
+
+
+namespace
+{
+
+#ifdef _WIN32
+int openForDump(const char *fileName)
+{
+	return _open(fileName, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+
+void closeDump(int fd)
+{
+	_close(fd);
+}
+
+bool writeAll(int fd, const char *data, size_t length)
+{
+	while (length > 0)
+	{
+		int written = _write(fd, data, static_cast<unsigned int>(length));
+		if (written <= 0)
+			return false;
+		data += written;
+		length -= static_cast<size_t>(written);
+	}
+	return true;
+}
+#else
+int openForDump(const char *fileName)
+{
+	return open(fileName, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+}
+
+void closeDump(int fd)
+{
+	close(fd);
+}
+
+bool writeAll(int fd, const char *data, size_t length)
+{
+	while (length > 0)
+	{
+		ssize_t written = write(fd, data, length);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return false;
+		data += written;
+		length -= static_cast<size_t>(written);
+	}
+	return true;
+}
+#endif
+
+
+size_t roundUpToPowerOfTwo(size_t value)
+{
+	size_t result = 2;
+	while (result < value)
+	{
+		result <<= 1;
+	}
+	return result;
+}
+
+
+// Fixed-size line buffer; appends past the end are cut. Only plain memory operations, safe in a signal handler.
+class LineBuilder
+{
+public:
+	LineBuilder(char *buffer, size_t size) : mBegin(buffer), mPos(buffer), mEnd(buffer + size) {}
+
+	void append(std::string_view text)
+	{
+		size_t length = std::min(text.size(), static_cast<size_t>(mEnd - mPos));
+		std::memcpy(mPos, text.data(), length);
+		mPos += length;
+	}
+
+	void append(char c)
+	{
+		if (mPos < mEnd)
+			*mPos++ = c;
+	}
+
+	void appendSpaces(size_t count)
+	{
+		while (count-- > 0)
+			append(' ');
+	}
+
+	// Left-aligned, cut or padded to `width`, like the columns of the text Formatter
+	void appendColumn(std::string_view text, size_t width)
+	{
+		text = text.substr(0, width);
+		append(text);
+		appendSpaces(width - text.size());
+	}
+
+	void appendNumber(uint64_t value, size_t minDigits = 1, size_t width = 0)
+	{
+		char   digits[20];
+		size_t count = 0;
+		do
+		{
+			digits[count++] = static_cast<char>('0' + value % 10);
+			value /= 10;
+		} while (value > 0 || count < minDigits);
+
+		if (width > count)
+			appendSpaces(width - count);
+		while (count > 0)
+			append(digits[--count]);
+	}
+
+	size_t size() const { return static_cast<size_t>(mPos - mBegin); }
+
+private:
+	char *mBegin;
+	char *mPos;
+	char *mEnd;
+};
+
+
+// Civil date from days since 1970-01-01 (proleptic Gregorian), without the time zone database
+void appendUtcTime(LineBuilder &line, int64_t nanoseconds)
+{
+	int64_t seconds = nanoseconds / 1'000'000'000;
+	int64_t micros	= (nanoseconds % 1'000'000'000) / 1'000;
+	if (micros < 0)
+	{
+		seconds -= 1;
+		micros += 1'000'000;
+	}
+
+	int64_t days		 = seconds / 86'400;
+	int64_t secondsOfDay = seconds % 86'400;
+	if (secondsOfDay < 0)
+	{
+		days -= 1;
+		secondsOfDay += 86'400;
+	}
+
+	days += 719'468;
+	int64_t	 era		= (days >= 0 ? days : days - 146'096) / 146'097;
+	uint64_t dayOfEra	= static_cast<uint64_t>(days - era * 146'097);
+	uint64_t yearOfEra	= (dayOfEra - dayOfEra / 1'460 + dayOfEra / 36'524 - dayOfEra / 146'096) / 365;
+	uint64_t dayOfYear	= dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+	uint64_t monthIndex = (5 * dayOfYear + 2) / 153;
+	uint64_t day		= dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+	uint64_t month		= monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+	int64_t	 year		= static_cast<int64_t>(yearOfEra) + era * 400 + (month <= 2 ? 1 : 0);
+
+	line.appendNumber(static_cast<uint64_t>(year), 4);
+	line.append('-');
+	line.appendNumber(month, 2);
+	line.append('-');
+	line.appendNumber(day, 2);
+	line.append(' ');
+	line.appendNumber(static_cast<uint64_t>(secondsOfDay / 3'600), 2);
+	line.append(':');
+	line.appendNumber(static_cast<uint64_t>(secondsOfDay / 60 % 60), 2);
+	line.append(':');
+	line.appendNumber(static_cast<uint64_t>(secondsOfDay % 60), 2);
+	line.append('.');
+	line.appendNumber(static_cast<uint64_t>(micros), 6);
+	line.append('Z');
+}
+
+
+std::string_view basenameOf(const char *path)
+{
+	if (!path || !*path)
+		return "Unknown File";
+
+	std::string_view name(path);
+	size_t			 lastSlash = name.find_last_of("/\\");
+	if (lastSlash != std::string_view::npos)
+		name.remove_prefix(lastSlash + 1);
+
+	size_t dot = name.rfind('.');
+	if (dot != std::string_view::npos)
+		name.remove_suffix(name.size() - dot);
+
+	return name;
+}
+
+
+/*
+ *	Crash dump target. Published through an atomic pointer so the handler never sees a half-written one;
+ *	replaced targets are kept alive (not freed) because a handler on another thread may still be using them.
+ */
+struct CrashTarget
+{
+	std::shared_ptr<RingBufferSink> ring;
+	std::string						fileName;
+};
+
+#ifdef _WIN32
+constexpr int							  CrashSignals[] = {SIGSEGV, SIGABRT, SIGFPE, SIGILL};
+#else
+constexpr int							  CrashSignals[] = {SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGBUS};
+#endif
+constexpr size_t						  CrashSignalCount = sizeof(CrashSignals) / sizeof(CrashSignals[0]);
+
+std::atomic<CrashTarget *>				  crashTarget{nullptr};
+std::mutex								  crashTargetMutex;
+std::vector<std::unique_ptr<CrashTarget>> crashTargets; // Owns every target ever armed
+
+#ifdef _WIN32
+using SignalHandler = void (*)(int);
+SignalHandler							  previousHandlers[CrashSignalCount];
+#else
+struct sigaction						  previousHandlers[CrashSignalCount];
+#endif
+
+
+void restorePreviousHandler(int signal)
+{
+	for (size_t i = 0; i < CrashSignalCount; ++i)
+	{
+		if (CrashSignals[i] != signal)
+			continue;
+#ifdef _WIN32
+		std::signal(signal, previousHandlers[i]);
+#else
+		sigaction(signal, &previousHandlers[i], nullptr);
+#endif
+	}
+}
+
+
+void onCrashSignal(int signal)
+{
+	static std::atomic_flag dumping = ATOMIC_FLAG_INIT;
+
+	// Only the first crashing thread dumps; others fall through to the previous handler
+	if (!dumping.test_and_set())
+	{
+		if (auto *target = crashTarget.load(std::memory_order_acquire))
+		{
+			int fd = openForDump(target->fileName.c_str());
+			if (fd >= 0)
+			{
+				target->ring->dump(fd);
+				closeDump(fd);
+			}
+		}
+	}
+
+	// Re-raised with the previous disposition, which is delivered once this handler returns
+	restorePreviousHandler(signal);
+	std::raise(signal);
+}
+
+
+void installCrashHandlers()
+{
+	for (size_t i = 0; i < CrashSignalCount; ++i)
+	{
+#ifdef _WIN32
+		previousHandlers[i] = std::signal(CrashSignals[i], onCrashSignal);
+#else
+		struct sigaction action = {};
+		action.sa_handler		= onCrashSignal;
+		sigemptyset(&action.sa_mask);
+		sigaction(CrashSignals[i], &action, &previousHandlers[i]);
+#endif
+	}
+}
+
+} // namespace
+
+
+RingBufferSink::RingBufferSink(size_t capacity)
+	: mCapacity(roundUpToPowerOfTwo(capacity)), mMask(mCapacity - 1), mSlots(std::make_unique<Slot[]>(mCapacity))
+{
+	if (capacity == 0)
+		throw std::invalid_argument("Ring buffer capacity cannot be zero");
+}
+
+
+void RingBufferSink::log(const spdlog::details::log_msg &msg)
+{
+	if (!should_log(msg.level))
+		return;
+
+	// Fields of LOG_*_KV calls are kept as the text outputs show them
+	std::string_view	 payload(msg.payload.data(), msg.payload.size());
+	spdlog::memory_buf_t withFields;
+	if (auto fields = logging::kv::currentFields(); !fields.empty())
+	{
+		withFields.append(msg.payload.begin(), msg.payload.end());
+		Formatter::appendFields(withFields, fields);
+		payload = std::string_view(withFields.data(), withFields.size());
+	}
+
+	uint64_t position = mNext.fetch_add(1, std::memory_order_relaxed);
+	Slot	&slot	  = mSlots[position & mMask];
+	uint64_t writing  = 2 * position + 1;
+
+	// Claim the slot unless a writer of a later lap already did; the older record is the one to lose
+	uint64_t current  = slot.sequence.load(std::memory_order_relaxed);
+	do
+	{
+		if ((current & 1) != 0 || current > writing)
+			return;
+	} while (!slot.sequence.compare_exchange_weak(current, writing, std::memory_order_relaxed));
+
+	// The odd sequence must be visible before any of the fields below
+	std::atomic_thread_fence(std::memory_order_release);
+
+	size_t length = std::min(payload.size(), MaxMessageLength);
+
+	slot.time.store(std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count(), std::memory_order_relaxed);
+	slot.threadId.store(msg.thread_id, std::memory_order_relaxed);
+	slot.file.store(msg.source.filename, std::memory_order_relaxed);
+	slot.function.store(msg.source.funcname, std::memory_order_relaxed);
+	slot.line.store(msg.source.line, std::memory_order_relaxed);
+	slot.length.store(static_cast<uint16_t>(length), std::memory_order_relaxed);
+	slot.level.store(static_cast<uint8_t>(msg.level), std::memory_order_relaxed);
+
+	const char *text = payload.data();
+	for (size_t offset = 0; offset < length; offset += sizeof(uint64_t))
+	{
+		uint64_t word = 0;
+		std::memcpy(&word, text + offset, std::min(sizeof(uint64_t), length - offset));
+		slot.text[offset / sizeof(uint64_t)].store(word, std::memory_order_relaxed);
+	}
+
+	slot.sequence.store(writing + 1, std::memory_order_release);
+	LoggerStats::countBytes(length);
+}
+
+
+bool RingBufferSink::readSlot(uint64_t position, Record &record) const noexcept
+{
+	const Slot &slot	 = mSlots[position & mMask];
+	uint64_t	complete = 2 * (position + 1);
+
+	if (slot.sequence.load(std::memory_order_acquire) != complete)
+		return false;
+
+	record.time		= slot.time.load(std::memory_order_relaxed);
+	record.threadId = slot.threadId.load(std::memory_order_relaxed);
+	record.file		= slot.file.load(std::memory_order_relaxed);
+	record.function = slot.function.load(std::memory_order_relaxed);
+	record.line		= slot.line.load(std::memory_order_relaxed);
+	record.length	= std::min<uint16_t>(slot.length.load(std::memory_order_relaxed), MaxMessageLength);
+	record.level	= slot.level.load(std::memory_order_relaxed);
+
+	for (size_t offset = 0; offset < record.length; offset += sizeof(uint64_t))
+	{
+		uint64_t word = slot.text[offset / sizeof(uint64_t)].load(std::memory_order_relaxed);
+		std::memcpy(record.text + offset, &word, std::min(sizeof(uint64_t), MaxMessageLength - offset));
+	}
+
+	// A writer that started meanwhile has bumped the sequence; its partial fields must not be used
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.sequence.load(std::memory_order_relaxed) == complete;
+}
+
+
+size_t RingBufferSink::dump(int fd) const noexcept
+{
+	uint64_t end   = mNext.load(std::memory_order_acquire);
+	uint64_t begin = end > mCapacity ? end - mCapacity : 0;
+
+	size_t	 written = 0;
+	Record	 record;
+	char	 buffer[512];
+
+	for (uint64_t position = begin; position < end; ++position)
+	{
+		if (!readSlot(position, record))
+			continue;
+
+		// Same columns as the text Formatter: time, thread, level, file, function, message
+		LineBuilder line(buffer, sizeof(buffer));
+		appendUtcTime(line, record.time);
+		line.append(' ');
+		line.appendNumber(record.threadId, 1, 8);
+		line.append(' ');
+		auto level = spdlog::level::to_string_view(static_cast<spdlog::level::level_enum>(std::min<uint8_t>(record.level, spdlog::level::off)));
+		line.appendColumn(std::string_view(level.data(), level.size()), 8);
+		line.append(' ');
+		line.appendColumn(basenameOf(record.file), 20);
+		line.append(' ');
+		line.appendColumn(record.function ? record.function : "", 45);
+		line.append(' ');
+		line.append(std::string_view(record.text, record.length));
+		line.append('\n');
+
+		if (!writeAll(fd, buffer, line.size()))
+			break;
+		++written;
+	}
+
+	return written;
+}
+
+
+size_t RingBufferSink::dump(const std::string &fileName) const
+{
+	if (fileName.empty())
+		throw std::invalid_argument("File name cannot be empty");
+
+	int fd = openForDump(fileName.c_str());
+	if (fd < 0)
+		throw std::runtime_error("Failed to open ring buffer dump file: " + fileName);
+
+	size_t written = dump(fd);
+	closeDump(fd);
+	return written;
+}
+
+
+void RingBufferSink::armCrashDump(const std::shared_ptr<RingBufferSink> &ring, const std::string &fileName)
+{
+	if (!ring || fileName.empty())
+		throw std::invalid_argument("A crash dump needs a ring and a file name");
+
+	static std::once_flag installed;
+	std::call_once(installed, installCrashHandlers);
+
+	std::lock_guard<std::mutex> lock(crashTargetMutex);
+	crashTargets.push_back(std::make_unique<CrashTarget>(CrashTarget{ring, fileName}));
+	crashTarget.store(crashTargets.back().get(), std::memory_order_release);
+}
+
+
+void RingBufferSink::disarmCrashDump()
+{
+	crashTarget.store(nullptr, std::memory_order_release);
+}
@@ -0,0 +1,175 @@
+/*
+==============================================================================
+	Module			RotationArchiver
+	Description		Compresses rotated log files on a background thread
+==============================================================================
+*/
+
+#include "RotationArchiver.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include "Lz4Codec.h"
+
+
+namespace
+{
+
+constexpr std::string_view StagingInfix = ".staged.";
+
+
+// Staging files of `fileName` in the order they were created
+std::vector<std::pair<size_t, std::string>> findStagedFiles(const std::string &fileName)
+{
+	namespace fs	   = std::filesystem;
+
+	auto		path   = fs::path(fileName);
+	auto		prefix = path.filename().string() + std::string(StagingInfix);
+	auto		directory = path.parent_path().empty() ? fs::path(".") : path.parent_path();
+
+	std::vector<std::pair<size_t, std::string>> staged;
+	std::error_code								error;
+	for (const auto &entry : fs::directory_iterator(directory, error))
+	{
+		auto name = entry.path().filename().string();
+		if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0)
+			continue;
+
+		auto index = name.substr(prefix.size());
+		if (!std::all_of(index.begin(), index.end(), [](char c) { return c >= '0' && c <= '9'; }))
+			continue;
+
+		staged.emplace_back(std::stoull(index), (path.parent_path() / name).string());
+	}
+
+	std::sort(staged.begin(), staged.end());
+	return staged;
+}
+
+} // namespace
+
+
+RotationArchiver::RotationArchiver(std::string fileName, size_t maxFiles) : mFileName(std::move(fileName)), mMaxFiles(maxFiles)
+{
+	if (mFileName.empty())
+		throw std::invalid_argument("File name cannot be empty");
+
+	for (auto &[index, stagedFile] : findStagedFiles(mFileName))
+	{
+		mQueue.push_back(std::move(stagedFile));
+		mNextStagingIndex = index + 1;
+	}
+
+	mWorker = std::thread(&RotationArchiver::run, this);
+}
+
+
+RotationArchiver::~RotationArchiver()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+	mWake.notify_one();
+	mWorker.join();
+}
+
+
+std::string RotationArchiver::stagingName()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mFileName + std::string(StagingInfix) + std::to_string(mNextStagingIndex++);
+}
+
+
+void RotationArchiver::archive(std::string stagedFile)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQueue.push_back(std::move(stagedFile));
+	}
+	mWake.notify_one();
+}
+
+
+void RotationArchiver::waitUntilIdle()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mIdle.wait(lock, [this] { return mQueue.empty(); });
+}
+
+
+std::string RotationArchiver::archiveName(const std::string &fileName, size_t index)
+{
+	return spdlog::sinks::rotating_file_sink_mt::calc_filename(fileName, index) + std::string(lz4::FileExtension);
+}
+
+
+void RotationArchiver::run()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	for (;;)
+	{
+		mWake.wait(lock, [this] { return mStop || !mQueue.empty(); });
+		if (mQueue.empty())
+			return; // Stopped with nothing left to archive
+
+		auto stagedFile = mQueue.front();
+		lock.unlock();
+
+		try
+		{
+			archiveOne(stagedFile);
+		}
+		catch (const std::exception &ex)
+		{
+			// The staged file stays on disk and is picked up again by the next archiver of this log
+			std::fprintf(stderr, "[Logger] Could not archive %s: %s\n", stagedFile.c_str(), ex.what());
+		}
+
+		lock.lock();
+		mQueue.pop_front();
+		if (mQueue.empty())
+			mIdle.notify_all();
+	}
+}
+
+
+void RotationArchiver::archiveOne(const std::string &stagedFile)
+{
+	namespace fs = std::filesystem;
+	std::error_code error;
+
+	if (mMaxFiles == 0)
+	{
+		fs::remove(stagedFile, error);
+		return;
+	}
+
+	// app.1.log.lz4 -> app.2.log.lz4 -> ... -> app.<maxFiles>.log.lz4, the oldest one is dropped
+	for (size_t i = mMaxFiles; i > 1; --i)
+	{
+		auto source = archiveName(mFileName, i - 1);
+		if (!fs::exists(source, error))
+			continue;
+
+		auto target = archiveName(mFileName, i);
+		fs::remove(target, error);
+		fs::rename(source, target, error);
+	}
+
+	// Compress next to the target first, so a crash never leaves a truncated archive under the final name
+	auto target	   = archiveName(mFileName, 1);
+	auto temporary = target + ".tmp";
+	lz4::compressFile(stagedFile, temporary);
+
+	fs::rename(temporary, target);
+	fs::remove(stagedFile, error);
+}
@@ -0,0 +1,120 @@
+/*
+==============================================================================
+	Module			SharedRendering
+	Description		Renders a message once for all sinks that share a layout
+==============================================================================
+*/
+
+#include "SharedRendering.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+
+namespace
+{
+
+// Distinct layouts shared per message; formatters of further layouts render on their own
+constexpr size_t MaxSharedLayouts = 4;
+
+
+struct Rendering
+{
+	uint32_t			 layout = 0;
+	spdlog::memory_buf_t bytes;
+	size_t				 colorStart = 0; // Offsets into bytes, both 0 if the layout has no color range
+	size_t				 colorEnd	= 0;
+};
+
+
+struct ScopeState
+{
+	const spdlog::details::log_msg *msg	  = nullptr;
+	size_t							used = 0;
+	Rendering						renderings[MaxSharedLayouts];
+};
+
+
+// Buffers stay with the thread, so their capacity is reused by the next message
+thread_local ScopeState sScope;
+
+
+Rendering			   *findRendering(const spdlog::details::log_msg &msg, uint32_t layout)
+{
+	if (sScope.msg != &msg)
+		return nullptr;
+
+	for (size_t i = 0; i < sScope.used; ++i)
+	{
+		if (sScope.renderings[i].layout == layout)
+			return &sScope.renderings[i];
+	}
+	return nullptr;
+}
+
+} // namespace
+
+
+SharedRendering::Scope::Scope(const spdlog::details::log_msg &msg)
+{
+	if (sScope.msg)
+		return;
+
+	sScope.msg	= &msg;
+	sScope.used = 0;
+	mActive		= true;
+}
+
+
+SharedRendering::Scope::~Scope()
+{
+	if (mActive)
+		sScope.msg = nullptr;
+}
+
+
+uint32_t SharedRendering::layoutId(std::string_view pattern)
+{
+	static std::mutex								 mutex;
+	static std::unordered_map<std::string, uint32_t> ids;
+
+	std::lock_guard<std::mutex>						 lock(mutex);
+	auto [it, inserted] = ids.try_emplace(std::string(pattern), static_cast<uint32_t>(ids.size() + 1));
+	return it->second;
+}
+
+
+bool SharedRendering::copyTo(const spdlog::details::log_msg &msg, uint32_t layout, spdlog::memory_buf_t &dest)
+{
+	auto *rendering = findRendering(msg, layout);
+	if (!rendering)
+		return false;
+
+	size_t begin = dest.size();
+	dest.append(rendering->bytes.data(), rendering->bytes.data() + rendering->bytes.size());
+
+	if (rendering->colorEnd > rendering->colorStart)
+	{
+		msg.color_range_start = begin + rendering->colorStart;
+		msg.color_range_end	  = begin + rendering->colorEnd;
+	}
+	return true;
+}
+
+
+void SharedRendering::keep(const spdlog::details::log_msg &msg, uint32_t layout, const spdlog::memory_buf_t &dest, size_t begin)
+{
+	if (sScope.msg != &msg || sScope.used == MaxSharedLayouts || findRendering(msg, layout))
+		return;
+
+	auto &rendering = sScope.renderings[sScope.used++];
+	rendering.layout = layout;
+	rendering.bytes.clear();
+	rendering.bytes.append(dest.data() + begin, dest.data() + dest.size());
+
+	// The formatter left the color range as positions in dest
+	bool hasColor		 = msg.color_range_end > msg.color_range_start;
+	rendering.colorStart = hasColor ? msg.color_range_start - begin : 0;
+	rendering.colorEnd	 = hasColor ? msg.color_range_end - begin : 0;
+}
@@ -0,0 +1,281 @@
+/*
+==============================================================================
+	Module			SinkList
+	Description		Copy-on-write set of sinks that can change while messages are logged
+==============================================================================
+*/
+
+#include "SinkList.h"
+#include "SharedRendering.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <optional>
+#include <thread>
+#include <utility>
+
+
+namespace
+{
+
+// Deeper than any real chain of sinks logging through other sink lists
+constexpr size_t MaxNesting = 4;
+
+
+// Snapshots one thread is reading, one slot per nesting level. Linked into a list that is only ever
+// appended to, so an updating thread can scan every reader without a lock.
+struct ReaderSlots
+{
+	std::array<std::atomic<const void *>, MaxNesting> reading{};
+	std::atomic<bool>								   inUse{true};
+	ReaderSlots									   *next = nullptr;
+};
+
+std::atomic<ReaderSlots *> allReaders{nullptr};
+
+
+ReaderSlots *acquireSlots()
+{
+	// Reuse the slots of a thread that has exited
+	for (auto *slots = allReaders.load(std::memory_order_acquire); slots; slots = slots->next)
+	{
+		bool inUse = false;
+		if (slots->inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire))
+			return slots;
+	}
+
+	auto *slots = new ReaderSlots(); // Never freed: updating threads may be scanning the list
+	slots->next = allReaders.load(std::memory_order_relaxed);
+	while (!allReaders.compare_exchange_weak(slots->next, slots, std::memory_order_release, std::memory_order_relaxed))
+	{
+	}
+	return slots;
+}
+
+
+struct ThreadReader
+{
+	ReaderSlots *slots = acquireSlots();
+	size_t		 depth = 0;
+
+	~ThreadReader() { slots->inUse.store(false, std::memory_order_release); }
+};
+
+ThreadReader &threadReader()
+{
+	thread_local ThreadReader reader;
+	return reader;
+}
+
+
+/*
+ *	@brief		Announces the published snapshot in the calling thread's next slot for the lifetime of the scope.
+ *				The snapshot is re-read after the announcement, so an updating thread either sees the slot or
+ *				the reader sees the new snapshot.
+ */
+template <typename Snapshot>
+class ReadScope
+{
+public:
+	ReadScope(ThreadReader &reader, const std::atomic<const Snapshot *> &published) : mReader(reader), mSlot(reader.slots->reading[reader.depth++])
+	{
+		mSnapshot = published.load(std::memory_order_acquire);
+		while (true)
+		{
+			mSlot.store(mSnapshot, std::memory_order_seq_cst);
+			auto *current = published.load(std::memory_order_seq_cst);
+			if (current == mSnapshot)
+				break;
+			mSnapshot = current;
+		}
+	}
+
+	~ReadScope()
+	{
+		mSlot.store(nullptr, std::memory_order_release);
+		--mReader.depth;
+	}
+
+	ReadScope(const ReadScope &)			= delete;
+	ReadScope &operator=(const ReadScope &) = delete;
+
+	const Snapshot &snapshot() const { return *mSnapshot; }
+
+private:
+	ThreadReader			  &mReader;
+	std::atomic<const void *> &mSlot;
+	const Snapshot			  *mSnapshot = nullptr;
+};
+
+
+// Waits until no other thread reads the snapshot; returns false if the calling thread itself still does
+bool waitForReaders(const void *snapshot)
+{
+	auto *own	   = threadReader().slots;
+	bool  released = true;
+
+	for (auto *slots = allReaders.load(std::memory_order_acquire); slots; slots = slots->next)
+	{
+		for (auto &slot : slots->reading)
+		{
+			if (slots == own)
+				released = released && slot.load(std::memory_order_relaxed) != snapshot;
+			else
+				while (slot.load(std::memory_order_seq_cst) == snapshot)
+					std::this_thread::yield();
+		}
+	}
+	return released;
+}
+
+} // namespace
+
+
+SinkList::SinkList() : mCurrent(std::make_shared<const Snapshot>()), mPublished(mCurrent.get())
+{
+}
+
+
+uint64_t SinkList::add(spdlog::sink_ptr sink, std::string name)
+{
+	uint64_t handle = newHandle();
+	Entry	 added{handle, std::move(sink), std::move(name), std::make_shared<LoggerStats::Output>()};
+
+	Retired	 released; // Destroyed after the lock is released, their sinks may take a while to flush
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto next = std::make_shared<Snapshot>(*mCurrent);
+	next->push_back(std::move(added));
+	released = publish(std::move(next));
+	return handle;
+}
+
+
+bool SinkList::remove(uint64_t handle)
+{
+	Retired released; // Destroyed after the lock is released, the removed sink flushes in its destructor
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto entry = std::find_if(mCurrent->begin(), mCurrent->end(), [handle](const Entry &e) { return e.handle == handle; });
+	if (entry == mCurrent->end())
+		return false;
+
+	auto next = std::make_shared<Snapshot>();
+	next->reserve(mCurrent->size() - 1);
+	std::copy_if(mCurrent->begin(), mCurrent->end(), std::back_inserter(*next), [handle](const Entry &e) { return e.handle != handle; });
+	released = publish(std::move(next));
+	return true;
+}
+
+
+SinkList::Retired SinkList::publish(std::shared_ptr<const Snapshot> next)
+{
+	mRetired.push_back(std::exchange(mCurrent, std::move(next)));
+	mPublished.store(mCurrent.get(), std::memory_order_seq_cst);
+
+	// A sink that adds or removes outputs while it logs still reads its snapshot; that one waits for the next update
+	Retired released;
+	for (auto &retired : mRetired)
+	{
+		if (waitForReaders(retired.get()))
+			released.push_back(std::move(retired));
+	}
+	std::erase(mRetired, nullptr);
+	return released;
+}
+
+
+std::shared_ptr<const SinkList::Snapshot> SinkList::snapshot() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mCurrent;
+}
+
+
+spdlog::sink_ptr SinkList::find(uint64_t handle) const
+{
+	for (const auto &entry : *snapshot())
+	{
+		if (entry.handle == handle)
+			return entry.sink;
+	}
+	return nullptr;
+}
+
+
+spdlog::level::level_enum SinkList::lowestLevel() const
+{
+	auto lowest = spdlog::level::off;
+
+	for (const auto &entry : *snapshot())
+	{
+		lowest = std::min(lowest, entry.sink->level());
+	}
+	return lowest;
+}
+
+
+void SinkList::log(const spdlog::details::log_msg &msg)
+{
+	auto &reader = threadReader();
+	if (reader.depth == MaxNesting)
+	{
+		// Out of slots: fall back to a counted copy
+		forward(*snapshot(), msg);
+		return;
+	}
+
+	ReadScope<Snapshot> reading(reader, mPublished);
+	forward(reading.snapshot(), msg);
+}
+
+
+void SinkList::forward(const Snapshot &sinks, const spdlog::details::log_msg &msg)
+{
+	// Sinks with the same layout format the message once between them
+	std::optional<SharedRendering::Scope> shared;
+	if (sinks.size() > 1)
+		shared.emplace(msg);
+
+	bool accepted = false;
+	for (const auto &entry : sinks)
+	{
+		if (!entry.sink->should_log(msg.level))
+			continue;
+
+		accepted = true;
+		LoggerStats::Write write(*entry.stats);
+
+		// One failing sink must not keep the message from the others
+		try
+		{
+			entry.sink->log(msg);
+		}
+		catch (const std::exception &ex)
+		{
+			std::fprintf(stderr, "[Logger] Sink write failed: %s\n", ex.what());
+		}
+	}
+
+	if (!accepted)
+		LoggerStats::countFiltered();
+}
+
+
+void SinkList::flush()
+{
+	auto sinks = snapshot();
+
+	for (const auto &entry : *sinks)
+	{
+		try
+		{
+			entry.sink->flush();
+		}
+		catch (const std::exception &ex)
+		{
+			std::fprintf(stderr, "[Logger] Sink flush failed: %s\n", ex.what());
+		}
+	}
+}
@@ -0,0 +1,229 @@
+/*
+==============================================================================
+	Module			StagingWriter
+	Description		Per-thread staging rings merged into the sinks by one writer thread
+==============================================================================
+*/
+
+#include "StagingWriter.h"
+
+#include <algorithm>
+#include <utility>
+
+
+namespace
+{
+
+std::atomic<uint64_t> nextWriterId{1};
+
+
+// Rings the current thread owns, one per writer it logged to. Closed when the thread exits.
+template <typename RingPtr>
+struct ThreadRings
+{
+	std::vector<std::pair<uint64_t, RingPtr>> entries;
+
+	~ThreadRings()
+	{
+		for (auto &[id, ring] : entries)
+		{
+			ring->closed.store(true, std::memory_order_release);
+		}
+	}
+};
+
+} // namespace
+
+
+StagingWriter::StagingWriter(std::shared_ptr<spdlog::logger> logger, size_t ringSize, OverflowPolicy overflowPolicy)
+	: mLogger(std::move(logger)), mRingSize(ringSize), mOverflowPolicy(overflowPolicy), mId(nextWriterId.fetch_add(1))
+{
+	mWorker = std::thread(&StagingWriter::run, this);
+}
+
+
+StagingWriter::~StagingWriter()
+{
+	mStop.store(true);
+	mSleeping.store(false);
+	mSleeping.notify_one();
+
+	if (mWorker.joinable())
+		mWorker.join();
+}
+
+
+StagingWriter::Ring &StagingWriter::localRing()
+{
+	thread_local ThreadRings<std::shared_ptr<Ring>> threadRings;
+
+	for (auto &[id, ring] : threadRings.entries)
+	{
+		if (id == mId)
+			return *ring;
+	}
+
+	// First message of this thread: create its ring and hand it to the writer thread
+	auto ring = std::make_shared<Ring>(mRingSize);
+	threadRings.entries.emplace_back(mId, ring);
+
+	{
+		std::lock_guard<std::mutex> lock(mRingsMutex);
+		mRings.push_back(ring);
+	}
+	mRingsVersion.fetch_add(1, std::memory_order_release);
+
+	return *ring;
+}
+
+
+void StagingWriter::enqueue(spdlog::log_clock::time_point time, size_t threadId, spdlog::level::level_enum level, int line, const char *file, const char *function, std::string_view payload,
+							std::string_view fields, logging::deferred::FormatFn format, std::string_view formatString)
+{
+	auto		&ring = localRing();
+	AsyncRecord *slot = ring.records.beginPush();
+
+	while (!slot)
+	{
+		if (mOverflowPolicy != OverflowPolicy::Block)
+		{
+			mDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		wakeWriter();
+		std::this_thread::yield();
+		slot = ring.records.beginPush();
+	}
+
+	// Filled in place: the slot's payload keeps its capacity, so steady-state logging does not allocate
+	slot->time	   = time;
+	slot->threadId = threadId;
+	slot->level	   = level;
+	slot->line	   = line;
+	slot->file	   = file;
+	slot->function = function;
+	slot->payload.assign(payload.data(), payload.size());
+	slot->fields.assign(fields.data(), fields.size());
+	slot->format	   = format;
+	slot->formatString = formatString;
+	ring.records.commitPush();
+
+	wakeWriter();
+}
+
+
+size_t StagingWriter::queueDepth()
+{
+	std::lock_guard<std::mutex> lock(mRingsMutex);
+
+	size_t depth = 0;
+	for (const auto &ring : mRings)
+	{
+		depth += ring->records.size();
+	}
+	return depth;
+}
+
+
+size_t StagingWriter::ringCount()
+{
+	std::lock_guard<std::mutex> lock(mRingsMutex);
+	return mRings.size();
+}
+
+
+void StagingWriter::wakeWriter()
+{
+	// Pairs with the fence in run(): either the writer sees the new record, or we see it sleeping
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (mSleeping.load(std::memory_order_relaxed))
+	{
+		mSleeping.store(false, std::memory_order_relaxed);
+		mSleeping.notify_one();
+	}
+}
+
+
+bool StagingWriter::writeEarliest(std::vector<std::shared_ptr<Ring>> &rings)
+{
+	Ring		*earliest = nullptr;
+	AsyncRecord *record	  = nullptr;
+
+	for (auto &ring : rings)
+	{
+		AsyncRecord *front = ring->records.front();
+		if (front && (!record || front->time < record->time))
+		{
+			earliest = ring.get();
+			record	 = front;
+		}
+	}
+
+	if (!earliest)
+		return false;
+
+	writeRecord(*mLogger, *record);
+	earliest->records.pop();
+	return true;
+}
+
+
+void StagingWriter::run()
+{
+	std::vector<std::shared_ptr<Ring>> rings;
+	uint64_t						   ringsVersion = 0;
+
+	// Picks up rings added by new threads and drops drained rings of exited threads
+	auto							   refreshRings = [&]()
+	{
+		std::lock_guard<std::mutex> lock(mRingsMutex);
+
+		std::erase_if(mRings, [](const std::shared_ptr<Ring> &ring) { return ring->closed.load(std::memory_order_acquire) && !ring->records.front(); });
+
+		rings		 = mRings;
+		ringsVersion = mRingsVersion.load(std::memory_order_acquire);
+	};
+
+	while (true)
+	{
+		if (ringsVersion != mRingsVersion.load(std::memory_order_acquire))
+			refreshRings();
+
+		if (writeEarliest(rings))
+			continue;
+
+		if (mStop.load())
+			break;
+
+		// All rings ran empty: push what was written so far to disk before going to sleep
+		flushSinks(*mLogger);
+		refreshRings();
+
+		mSleeping.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (ringsVersion != mRingsVersion.load(std::memory_order_acquire))
+			refreshRings();
+
+		if (writeEarliest(rings))
+		{
+			mSleeping.store(false, std::memory_order_relaxed);
+			continue;
+		}
+
+		if (mStop.load())
+			break;
+
+		mSleeping.wait(true);
+	}
+
+	refreshRings();
+	while (writeEarliest(rings))
+	{
+	}
+
+	flushSinks(*mLogger);
+}
+